@@ -0,0 +1,108 @@
+// Times MBC bank switching. Each case runs a generated MBC5 ROM whose main
+// loop writes a bank register around every read, about 3200 switches a frame.
+// The cost per switch is measured against the same loop writing to WRAM,
+// taking the fastest of five runs of each case.
+//
+//   g++ -O2 -DHAVE_STDINT_H -D__LIBRETRO__ -Isrc -Iinclude -I../common
+//       -Ilibretro bench/bankswitch_bench.cpp <core sources> -o bankswitch_bench
+//   ./bankswitch_bench [frames]
+#include "gambatte.h"
+#include "libretro.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+
+retro_log_printf_t log_cb = 0;
+
+namespace {
+
+// cycles per loop iteration, each doing two bank writes
+enum { loop_cycles = 44 };
+
+struct Case {
+	char const *name;
+	unsigned char reg; // high byte of the bank register address
+	unsigned char bank0, bank1;
+};
+
+std::vector<unsigned char> makeRom(Case const &c) {
+	std::vector<unsigned char> rom(0x20000);
+	unsigned char const entry[] = { 0x00, 0xC3, 0x50, 0x01 }; // nop; jp 0x150
+	unsigned char const code[] = {
+		0xF3,                                   // di
+		0x3E, 0x0A, 0xEA, 0x00, 0x00,           // enable ram
+		0x21, 0x00, c.reg,                      // ld hl,reg << 8
+		0x11, 0x00, 0x40,                       // ld de,0x4000
+		0x06, c.bank0, 0x0E, c.bank1,           // ld b,bank0; ld c,bank1
+		0x70, 0x1A, 0x71, 0x1A, 0x18, 0xFA      // loop: ld (hl),b; ld a,(de); ld (hl),c; ld a,(de); jr loop
+	};
+
+	std::copy(entry, entry + sizeof entry, rom.begin() + 0x100);
+	std::copy(code, code + sizeof code, rom.begin() + 0x150);
+	rom[0x147] = 0x1B; // MBC5+RAM+BATTERY
+	rom[0x148] = 0x02; // 8 ROM banks
+	rom[0x149] = 0x03; // 4 RAM banks
+
+	unsigned char sum = 0;
+	for (unsigned i = 0x134; i < 0x14D; ++i)
+		sum -= rom[i] + 1;
+
+	rom[0x14D] = sum;
+	return rom;
+}
+
+double run(Case const &c, int frames) {
+	static gambatte::GB gb;
+	static gambatte::uint_least32_t audio[35112 + 2064];
+	std::vector<unsigned char> const rom = makeRom(c);
+
+	if (gb.load(&rom[0], rom.size()))
+		return 0;
+
+	std::clock_t start = 0;
+
+	for (int i = -60; i < frames; ++i) {
+		if (i == 0)
+			start = std::clock();
+
+		for (;;) {
+			unsigned samples = 35112;
+			if (gb.runFor(0, 160, audio, samples) >= 0)
+				break;
+		}
+	}
+
+	return double(std::clock() - start) / CLOCKS_PER_SEC;
+}
+
+}
+
+int main(int argc, char **argv) {
+	int const frames = argc > 1 ? std::atoi(argv[1]) : 3000;
+	Case const cases[] = {
+		{ "wram",          0xC0, 2, 3 },
+		{ "rom alternate", 0x20, 2, 3 },
+		{ "rom same",      0x20, 2, 2 },
+		{ "ram alternate", 0x40, 0, 1 },
+		{ "ram same",      0x40, 1, 1 },
+	};
+
+	double const switches = 70224.0 * frames / loop_cycles * 2;
+	double base = 0;
+
+	for (std::size_t i = 0; i < sizeof cases / sizeof cases[0]; ++i) {
+		double secs = run(cases[i], frames);
+		for (int r = 1; r < 5; ++r)
+			secs = std::min(secs, run(cases[i], frames));
+
+		if (i == 0)
+			base = secs;
+
+		std::printf("%-14s %8.1f us/frame %6.2f ns/switch\n", cases[i].name,
+		            secs * 1e6 / frames, (secs - base) * 1e9 / switches);
+	}
+
+	return 0;
+}
@@ -0,0 +1,160 @@
+// Times GameShark codes, which are applied on every VBlank interrupt. Each
+// case runs a generated ROM that halts between VBlank interrupts with a set
+// of type 01 codes, and the cost per code and frame is measured against the
+// same ROM without codes, taking the fastest of five runs of each case.
+//
+// With the core and the benchmark built with GAMESHARK_PROFILE, the core also
+// times its VBlank passes over the codes, which adds the time measured there
+// per code and frame, the share of codes stored directly rather than through
+// Memory::write, and the number of times the codes were resolved per frame.
+//
+//   g++ -O2 -DHAVE_STDINT_H -D__LIBRETRO__ -Isrc -Iinclude -I../common
+//       -Ilibretro bench/gameshark_bench.cpp <core sources> -o gameshark_bench
+//   ./gameshark_bench [frames]
+#include "gambatte.h"
+#include "libretro.h"
+#ifdef GAMESHARK_PROFILE
+#include "interrupter.h"
+#endif
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <vector>
+
+retro_log_printf_t log_cb = 0;
+
+#ifdef GAMESHARK_PROFILE
+namespace {
+
+struct Profile {
+	double nsecs, codes, stored, resolves;
+} profile;
+
+}
+
+void gambatte::gameSharkProfile(double nsecs, std::size_t codes, unsigned stored, unsigned resolves) {
+	profile.nsecs += nsecs;
+	profile.codes += codes;
+	profile.stored += stored;
+	profile.resolves += resolves;
+}
+#endif
+
+namespace {
+
+struct Case {
+	char const *name;
+	unsigned base; // first address written
+	unsigned codes;
+};
+
+std::vector<unsigned char> makeRom() {
+	std::vector<unsigned char> rom(0x8000);
+	unsigned char const vblank[] = { 0xD9 };                 // reti
+	unsigned char const entry[] = { 0x00, 0xC3, 0x50, 0x01 }; // nop; jp 0x150
+	unsigned char const code[] = {
+		0x3E, 0x0A, 0xEA, 0x00, 0x00,           // enable ram
+		0x3E, 0x01, 0xE0, 0xFF,                 // ld a,1; ldh (IE),a
+		0xFB,                                   // ei
+		0x76, 0x18, 0xFD                        // loop: halt; jr loop
+	};
+
+	std::copy(vblank, vblank + sizeof vblank, rom.begin() + 0x40);
+	std::copy(entry, entry + sizeof entry, rom.begin() + 0x100);
+	std::copy(code, code + sizeof code, rom.begin() + 0x150);
+	rom[0x147] = 0x1B; // MBC5+RAM+BATTERY
+	rom[0x148] = 0x00; // 2 ROM banks
+	rom[0x149] = 0x02; // 1 RAM bank
+
+	unsigned char sum = 0;
+	for (unsigned i = 0x134; i < 0x14D; ++i)
+		sum -= rom[i] + 1;
+
+	rom[0x14D] = sum;
+	return rom;
+}
+
+std::string makeCodes(Case const &c) {
+	static char const hex[] = "0123456789ABCDEF";
+	std::string codes;
+
+	for (unsigned i = 0; i < c.codes; ++i) {
+		unsigned const addr = c.base + i % 0x7F;
+		char const code[] = {
+			'0', '1', hex[i >> 4 & 0xF], hex[i & 0xF],
+			hex[addr >> 4 & 0xF], hex[addr & 0xF], hex[addr >> 12], hex[addr >> 8 & 0xF], ';'
+		};
+
+		codes.append(code, sizeof code);
+	}
+
+	return codes;
+}
+
+double run(Case const &c, int frames) {
+	static gambatte::GB gb;
+	static gambatte::uint_least32_t audio[35112 + 2064];
+	std::vector<unsigned char> const rom = makeRom();
+
+	if (gb.load(&rom[0], rom.size()))
+		return 0;
+
+	gb.setGameShark(makeCodes(c));
+	std::clock_t start = 0;
+
+	for (int i = -60; i < frames; ++i) {
+		if (i == 0) {
+#ifdef GAMESHARK_PROFILE
+			profile = Profile();
+#endif
+			start = std::clock();
+		}
+
+		for (;;) {
+			unsigned samples = 35112;
+			if (gb.runFor(0, 160, audio, samples) >= 0)
+				break;
+		}
+	}
+
+	return double(std::clock() - start) / CLOCKS_PER_SEC;
+}
+
+}
+
+int main(int argc, char **argv) {
+	int const frames = argc > 1 ? std::atoi(argv[1]) : 3000;
+	Case const cases[] = {
+		{ "none",       0xC000,     0 },
+		{ "wram",       0xC000, 16384 },
+		{ "sram",       0xA000, 16384 },
+		{ "hram",       0xFF80, 16384 },
+	};
+
+	double base = 0;
+
+	for (std::size_t i = 0; i < sizeof cases / sizeof cases[0]; ++i) {
+		double secs = run(cases[i], frames);
+		for (int r = 1; r < 5; ++r)
+			secs = std::min(secs, run(cases[i], frames));
+
+		if (i == 0)
+			base = secs;
+
+		std::printf("%-14s %8.1f us/frame %6.2f ns/code", cases[i].name, secs * 1e6 / frames,
+		            cases[i].codes ? (secs - base) * 1e9 / (double(frames) * cases[i].codes) : 0.0);
+#ifdef GAMESHARK_PROFILE
+		// from the last run
+		if (profile.codes) {
+			std::printf(", in core %6.2f ns/code %5.1f%% direct %5.2f resolves/frame",
+			            profile.nsecs / profile.codes,
+			            profile.stored * 100 / profile.codes, profile.resolves / frames);
+		}
+#endif
+		std::printf("\n");
+	}
+
+	return 0;
+}
@@ -0,0 +1,245 @@
+// Compares the event queue backends on event streams recorded from real runs.
+//
+// Recording needs the core built with MINKEEPER_RECORD, replaying only needs
+// the headers, so streams recorded on a desktop can be replayed on a target:
+//
+//   g++ -O2 -DMINKEEPER_RECORD -DHAVE_STDINT_H -D__LIBRETRO__ -Isrc -Iinclude
+//       -I../common -Ilibretro bench/minkeeper_bench.cpp <core sources>
+//       -o minkeeper_record
+//   ./minkeeper_record record game.gbc 3600 game.events
+//
+//   g++ -O2 -DHAVE_STDINT_H -Isrc bench/minkeeper_bench.cpp -o minkeeper_bench
+//   ./minkeeper_bench game.events
+//
+// The replay runs every backend over the stream and prints the time per
+// recorded operation. The two-level rows replay the queues as the core uses
+// them: interrupt requester, LCD event queue and LCD memory event queue. The
+// flat rows replay the LCD_FLAT_EVENTS layout, where one LCD queue feeds the
+// interrupt requester directly. Record with the default layout; rows of the
+// same layout must print the same check value.
+#include "minkeeper.h"
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <vector>
+
+namespace {
+
+using gambatte::cycle_t;
+
+// queue ids, matching the number of events in each queue
+enum { intreq_queue = 9, lcd_queue = 2, lcd_mem_queue = 8 };
+enum { intevent_video = 7, lcd_mem_event = 0, lcd_ly_count = 1 };
+
+struct Op {
+	unsigned char queue;
+	signed char id;
+	cycle_t value;
+};
+
+typedef std::vector<Op> Stream;
+
+template<template<int> class Keeper>
+struct TwoLevel {
+	static unsigned long long replay(Stream const &ops) {
+		Keeper<intreq_queue> intreq;
+		Keeper<lcd_queue> lcd;
+		Keeper<lcd_mem_queue> mem;
+		unsigned long long check = 0;
+
+		for (std::size_t i = 0; i < ops.size(); ++i) {
+			Op const &op = ops[i];
+
+			switch (op.queue) {
+			case intreq_queue:
+				if (op.id < 0)
+					check = check * 31 + intreq.min();
+				else
+					intreq.setValue(op.id, op.value);
+
+				check += intreq.minValue();
+				break;
+			case lcd_queue:
+				if (op.id < 0)
+					check = check * 31 + lcd.min();
+				else
+					lcd.setValue(op.id, op.value);
+
+				break;
+			case lcd_mem_queue:
+				if (op.id < 0)
+					check = check * 31 + mem.min();
+				else
+					mem.setValue(op.id, op.value);
+
+				break;
+			}
+		}
+
+		return check;
+	}
+};
+
+template<template<int> class Keeper>
+struct Flat {
+	enum { ly_count_id = lcd_mem_queue };
+
+	static unsigned long long replay(Stream const &ops) {
+		Keeper<intreq_queue> intreq;
+		Keeper<lcd_mem_queue + 1> lcd;
+		unsigned long long check = 0;
+
+		for (std::size_t i = 0; i < ops.size(); ++i) {
+			Op const &op = ops[i];
+
+			switch (op.queue) {
+			case intreq_queue:
+				// video event times follow from the LCD queue below
+				if (op.id < 0)
+					check = check * 31 + intreq.min();
+				else if (op.id != intevent_video)
+					intreq.setValue(op.id, op.value);
+
+				check += intreq.minValue();
+				break;
+			case lcd_queue:
+				if (op.id < 0) {
+					check = check * 31 + (lcd.min() == ly_count_id ? lcd_ly_count : lcd_mem_event);
+				} else if (op.id == lcd_ly_count) {
+					lcd.setValue(ly_count_id, op.value);
+					intreq.setValue(intevent_video, lcd.minValue());
+				}
+
+				break;
+			case lcd_mem_queue:
+				if (op.id < 0) {
+					check = check * 31 + lcd.min();
+				} else {
+					lcd.setValue(op.id, op.value);
+					intreq.setValue(intevent_video, lcd.minValue());
+				}
+
+				break;
+			}
+		}
+
+		return check;
+	}
+};
+
+template<int ids> class Tree : public MinKeeper<ids> {};
+template<int ids> class Linear : public LinearMinKeeper<ids> {};
+
+template<class Replay>
+static void bench(char const *name, Stream const &ops, unsigned repeats) {
+	unsigned long long check = 0;
+	std::clock_t const start = std::clock();
+
+	for (unsigned r = 0; r < repeats; ++r)
+		check = Replay::replay(ops);
+
+	double const secs = double(std::clock() - start) / CLOCKS_PER_SEC;
+	std::printf("%-18s %8.2f ns/op  check %016llx\n", name,
+	            secs * 1e9 / (double(ops.size()) * repeats), check);
+}
+
+static bool readStream(char const *path, Stream &ops) {
+	std::FILE *const f = std::fopen(path, "rb");
+	if (!f)
+		return false;
+
+	unsigned char rec[10];
+	while (std::fread(rec, sizeof rec, 1, f) == 1) {
+		Op op;
+		op.queue = rec[0];
+		op.id = static_cast<signed char>(rec[1]);
+		op.value = 0;
+
+		for (int i = 9; i >= 2; --i)
+			op.value = op.value << 8 | rec[i];
+
+		ops.push_back(op);
+	}
+
+	std::fclose(f);
+	return true;
+}
+
+}
+
+#ifdef MINKEEPER_RECORD
+#include "gambatte.h"
+#include "libretro.h"
+
+retro_log_printf_t log_cb = 0;
+
+static std::FILE *recordFile;
+
+void minKeeperRecord(void const *, int ids, int id, cycle_t value) {
+	if (!recordFile)
+		return;
+
+	unsigned char rec[10] = { static_cast<unsigned char>(ids), static_cast<unsigned char>(id) };
+
+	for (int i = 2; i < 10; ++i, value >>= 8)
+		rec[i] = value & 0xFF;
+
+	std::fwrite(rec, sizeof rec, 1, recordFile);
+}
+
+static int record(char const *romPath, int frames, char const *outPath) {
+	std::FILE *const rf = std::fopen(romPath, "rb");
+	if (!rf)
+		return 1;
+
+	std::vector<char> rom;
+	char buf[0x4000];
+	for (std::size_t n; (n = std::fread(buf, 1, sizeof buf, rf)) > 0;)
+		rom.insert(rom.end(), buf, buf + n);
+
+	std::fclose(rf);
+
+	static gambatte::GB gb;
+	static gambatte::video_pixel_t video[256 * 144];
+	static gambatte::uint_least32_t audio[35112 + 2064];
+
+	if (gb.load(&rom[0], rom.size(), 0) || !(recordFile = std::fopen(outPath, "wb")))
+		return 1;
+
+	for (int i = 0; i < frames; ++i) {
+		for (;;) {
+			unsigned samples = 35112;
+			if (gb.runFor(video, 256, audio, samples) >= 0)
+				break;
+		}
+	}
+
+	std::fclose(recordFile);
+	recordFile = 0;
+	return 0;
+}
+#endif
+
+int main(int argc, char **argv) {
+#ifdef MINKEEPER_RECORD
+	if (argc == 5 && std::string(argv[1]) == "record")
+		return record(argv[2], std::atoi(argv[3]), argv[4]);
+#endif
+	Stream ops;
+
+	if (argc < 2 || !readStream(argv[1], ops) || ops.empty()) {
+		std::fprintf(stderr, "usage: %s <event stream> [repeats]\n", argv[0]);
+		return 1;
+	}
+
+	unsigned const repeats = argc > 2 ? std::atoi(argv[2]) : 20;
+	std::printf("%lu recorded operations, %u repeats\n", static_cast<unsigned long>(ops.size()), repeats);
+
+	bench<TwoLevel<Tree> >("two-level tree", ops, repeats);
+	bench<TwoLevel<Linear> >("two-level linear", ops, repeats);
+	bench<Flat<Tree> >("flat tree", ops, repeats);
+	bench<Flat<Linear> >("flat linear", ops, repeats);
+
+	return 0;
+}
@@ -0,0 +1,165 @@
+// Times drawing frames in each pixel format. Every case draws the same
+// frames of random tiles, in CGB mode: a plain background, drawn a line at
+// a time in a single pass, 40 sprites, which split each line into
+// background runs around them, and an SCX write early in mode 3 of every
+// line, which keeps lines on the tile loop. Prints the time per frame,
+// taking the fastest of five runs of each case, the time over drawing the
+// same frames in PIXEL_INDEXED8, and a hash of the last frame, which does
+// not depend on how the PPU gets the pixels there.
+//
+//   g++ -O2 -DHAVE_STDINT_H -Isrc -Iinclude -I../common bench/ppu_format_bench.cpp
+//       src/video/ppu.cpp src/video/sprite_mapper.cpp src/video/ly_counter.cpp
+//       src/video/next_m0_time.cpp src/video/tile_cache.cpp src/video/tile_row.cpp
+//       src/hash64.cpp -o ppu_format_bench
+//   ./ppu_format_bench [frames]
+#include "hash64.h"
+#include "video/next_m0_time.h"
+#include "video/ppu.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+namespace {
+
+using namespace gambatte;
+
+enum { line_cycles = 456, frame_cycles = 154 * line_cycles };
+
+enum Scene { scene_background, scene_sprites, scene_scx_writes };
+
+struct Case {
+	char const *name;
+	PixelFormat format;
+	Scene scene;
+};
+
+struct Screen {
+	NextM0Time nextM0Time;
+	unsigned char oam[0xA0];
+	unsigned char vram[0x4000];
+	uint32_t fb[160 * 144];
+	PPU ppu;
+	cycle_t spriteMapTime;
+
+	Screen() : ppu(nextM0Time, oam, vram), spriteMapTime(0) {}
+
+	void runTo(cycle_t const cc) {
+		for (;;) {
+			cycle_t const t = std::min(ppu.lyCounter().time(), spriteMapTime);
+			if (t > cc)
+				break;
+
+			ppu.update(t);
+
+			if (t == spriteMapTime)
+				spriteMapTime = ppu.doSpriteMapEvent(t);
+			else
+				ppu.doLyCountEvent();
+		}
+
+		ppu.update(cc);
+	}
+};
+
+double run(Case const &c, int frames, uint64_t &check) {
+	// a fresh PPU for each run, on the heap for its frame buffer
+	Screen *const screen = new Screen;
+	Screen &s = *screen;
+
+	std::srand(1);
+	for (unsigned i = 0; i < sizeof s.vram; ++i)
+		s.vram[i] = std::rand() & 0xFF;
+
+	std::memset(s.oam, 0, sizeof s.oam);
+	if (c.scene == scene_sprites) {
+		for (unsigned i = 0; i < 40; ++i) {
+			s.oam[i * 4    ] = 16 + i * 144 / 40;
+			s.oam[i * 4 + 1] =  8 + std::rand() % 160;
+			s.oam[i * 4 + 2] = std::rand() & 0xFF;
+			s.oam[i * 4 + 3] = std::rand() & 0xFF;
+		}
+	}
+
+	std::memset(s.fb, 0, sizeof s.fb);
+	s.ppu.reset(s.oam, s.vram, true);
+	s.ppu.refreshTileCache();
+	s.ppu.setPixelFormat(c.format);
+	s.ppu.setFrameBuf(s.fb, 160 * 4 / (c.format == PIXEL_RGB32 ? 4
+	                                 : c.format == PIXEL_RGB565 ? 2 : 1));
+	for (unsigned i = 0; i < num_palette_slots; ++i)
+		s.ppu.setPaletteColor(i, 0x10203u * (i + 1));
+
+	s.ppu.setScx(3);
+	s.ppu.setWx(0xFF);
+	s.ppu.setLcdc(0x93, 0);
+	s.spriteMapTime = SpriteMapper::schedule(s.ppu.lyCounter(), 0);
+
+	std::clock_t const start = std::clock();
+
+	for (int f = 0; f < frames; ++f) {
+		cycle_t const frameStart = cycle_t(f) * frame_cycles;
+
+		if (c.scene == scene_scx_writes) {
+			for (unsigned ly = 0; ly < 144; ++ly) {
+				s.runTo(frameStart + ly * line_cycles + 90);
+				s.ppu.setScx(ly + f);
+			}
+		}
+
+		s.runTo(frameStart + frame_cycles);
+	}
+
+	double const secs = double(std::clock() - start) / CLOCKS_PER_SEC;
+	check = hash64(s.fb, sizeof s.fb);
+	delete screen;
+	return secs;
+}
+
+}
+
+int main(int argc, char **argv) {
+	int const frames = argc > 1 ? std::atoi(argv[1]) : 20000;
+	Case const cases[] = {
+		{ "rgb32 background",    PIXEL_RGB32,    scene_background },
+		{ "rgb565 background",   PIXEL_RGB565,   scene_background },
+		{ "gray8 background",    PIXEL_GRAY8,    scene_background },
+		{ "indexed8 background", PIXEL_INDEXED8, scene_background },
+		{ "rgb32 sprites",       PIXEL_RGB32,    scene_sprites    },
+		{ "rgb565 sprites",      PIXEL_RGB565,   scene_sprites    },
+		{ "gray8 sprites",       PIXEL_GRAY8,    scene_sprites    },
+		{ "indexed8 sprites",    PIXEL_INDEXED8, scene_sprites    },
+		{ "rgb32 scx writes",    PIXEL_RGB32,    scene_scx_writes },
+		{ "rgb565 scx writes",   PIXEL_RGB565,   scene_scx_writes },
+		{ "gray8 scx writes",    PIXEL_GRAY8,    scene_scx_writes },
+		{ "indexed8 scx writes", PIXEL_INDEXED8, scene_scx_writes },
+	};
+
+	std::size_t const numCases = sizeof cases / sizeof cases[0];
+	double secs[numCases];
+	uint64_t check[numCases];
+
+	// the cases take turns, so that other load on the host slows them alike
+	for (int r = 0; r < 5; ++r) {
+		for (std::size_t i = 0; i < numCases; ++i) {
+			double const t = run(cases[i], frames, check[i]);
+			secs[i] = r ? std::min(secs[i], t) : t;
+		}
+	}
+
+	for (std::size_t i = 0; i < numCases; ++i) {
+		// the time over PIXEL_INDEXED8, which writes palette slots as drawn
+		double indexed = secs[i];
+		for (std::size_t j = 0; j < numCases; ++j) {
+			if (cases[j].scene == cases[i].scene && cases[j].format == PIXEL_INDEXED8)
+				indexed = secs[j];
+		}
+
+		std::printf("%-20s %8.1f us/frame %+6.1f check %016llx\n", cases[i].name,
+		            secs[i] * 1e6 / frames, (secs[i] - indexed) * 1e6 / frames,
+		            static_cast<unsigned long long>(check[i]));
+	}
+
+	return 0;
+}
@@ -0,0 +1,125 @@
+// Times RAM search steps over 32 KiB, the size of CGB WRAM, against a
+// byte-at-a-time loop over a plain candidate array. Each step starts from
+// every byte a candidate, with about a third of RAM changed since the
+// snapshot, so no bitmap word is skipped.
+//
+//   g++ -O2 -DHAVE_STDINT_H -Isrc -Iinclude -I../common
+//       bench/ramsearch_bench.cpp src/ramsearch.cpp -o ramsearch_bench
+//   ./ramsearch_bench [steps]
+#include "ramsearch.h"
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+
+namespace {
+
+using gambatte::RamSearch;
+
+enum { ram_size = 0x8000 };
+
+struct Case {
+	char const *name;
+	RamSearch::Filter filter;
+	unsigned width;
+	unsigned operand;
+};
+
+void mutate(std::vector<unsigned char> &ram) {
+	for (std::size_t i = 0; i < ram.size(); ++i) {
+		if (std::rand() % 3 == 0)
+			ram[i] += std::rand() % 3 - 1;
+	}
+}
+
+bool passes(Case const &c, unsigned char const *cur, unsigned char const *prev) {
+	unsigned const mask = c.width == 2 ? 0xFFFF : 0xFF;
+	unsigned const now = c.width == 2 ? cur[0] | cur[1] << 8 : cur[0];
+	unsigned const then = c.width == 2 ? prev[0] | prev[1] << 8 : prev[0];
+
+	switch (c.filter) {
+	case RamSearch::unchanged:    return now == then;
+	case RamSearch::changed:      return now != then;
+	case RamSearch::equal_to:     return now == (c.operand & mask);
+	case RamSearch::increased_by: return ((now - then) & mask) == (c.operand & mask);
+	case RamSearch::decreased_by: return ((then - now) & mask) == (c.operand & mask);
+	}
+
+	return false;
+}
+
+// returns the time per step, and the candidates left after the last one
+double timeSearch(Case const &c, std::vector<unsigned char> ram, int steps, std::size_t &left) {
+	RamSearch search;
+	double secs = 0;
+
+	for (int i = 0; i < steps; ++i) {
+		search.clear();
+		search.addRegion(0, &ram[0], ram.size());
+		mutate(ram);
+
+		std::clock_t const start = std::clock();
+		left = search.filter(c.filter, c.width, c.operand);
+		secs += double(std::clock() - start) / CLOCKS_PER_SEC;
+	}
+
+	return secs / steps;
+}
+
+double timeScalar(Case const &c, std::vector<unsigned char> ram, int steps, std::size_t &left) {
+	std::vector<unsigned char> prev(ram.size() + 1);
+	std::vector<unsigned char> cand(ram.size());
+	double secs = 0;
+
+	for (int i = 0; i < steps; ++i) {
+		std::copy(ram.begin(), ram.end(), prev.begin());
+		std::fill(cand.begin(), cand.end(), 1);
+		mutate(ram);
+
+		std::clock_t const start = std::clock();
+		std::size_t const end = ram.size() + 1 - c.width;
+		left = 0;
+
+		for (std::size_t a = 0; a < ram.size(); ++a) {
+			if (cand[a]) {
+				cand[a] = a < end && passes(c, &ram[a], &prev[a]);
+				left += cand[a];
+			}
+		}
+
+		secs += double(std::clock() - start) / CLOCKS_PER_SEC;
+	}
+
+	return secs / steps;
+}
+
+}
+
+int main(int argc, char **argv) {
+	int const steps = argc > 1 ? std::atoi(argv[1]) : 2000;
+	Case const cases[] = {
+		{ "changed 8",     RamSearch::changed,      1, 0 },
+		{ "equal to 8",    RamSearch::equal_to,     1, 1 },
+		{ "increased 8",   RamSearch::increased_by, 1, 1 },
+		{ "changed 16",    RamSearch::changed,      2, 0 },
+		{ "equal to 16",   RamSearch::equal_to,     2, 1 },
+		{ "decreased 16",  RamSearch::decreased_by, 2, 1 },
+	};
+
+	std::vector<unsigned char> ram(ram_size);
+	for (std::size_t i = 0; i < ram.size(); ++i)
+		ram[i] = std::rand() % 4;
+
+	for (std::size_t i = 0; i < sizeof cases / sizeof cases[0]; ++i) {
+		std::size_t left = 0, scalarLeft = 0;
+		std::srand(1);
+		double const t = timeSearch(cases[i], ram, steps, left);
+		std::srand(1);
+		double const s = timeScalar(cases[i], ram, steps, scalarLeft);
+
+		std::printf("%-14s %7.2f us/step  scalar %7.2f us/step  %5lu left%s\n", cases[i].name,
+		            t * 1e6, s * 1e6, static_cast<unsigned long>(left), left == scalarLeft ? "" : " MISMATCH");
+	}
+
+	return 0;
+}
@@ -0,0 +1,102 @@
+// Times sprite mapping, which runs after every OAM change. Each frame moves
+// some sprites, remaps and reads the sprites of every line, the way an OAM
+// DMA each VBlank followed by a drawn frame does. The full cases clear the map
+// first, so every line is rebuilt as before incremental remapping. The spread
+// cases line the sprites up down the screen, so moving them all changes every
+// line. Takes the fastest of five runs of each case.
+//
+//   g++ -O2 -DHAVE_STDINT_H -Isrc -Iinclude -I../common bench/sprite_mapper_bench.cpp
+//       src/video/ppu.cpp src/video/sprite_mapper.cpp src/video/ly_counter.cpp
+//       src/video/next_m0_time.cpp src/video/tile_cache.cpp src/video/tile_row.cpp
+//       src/hash64.cpp -o sprite_mapper_bench
+//   ./sprite_mapper_bench [frames]
+#include "counterdef.h"
+#include "video/next_m0_time.h"
+#include "video/sprite_mapper.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+namespace {
+
+using namespace gambatte;
+
+struct Case {
+	char const *name;
+	unsigned moved; // sprites moved per frame
+	bool full;      // rebuild every line
+	bool spread;    // sprites cover every line
+};
+
+double run(Case const &c, int frames, unsigned &check) {
+	static unsigned char oam[0xA0];
+	LyCounter lyCounter;
+	NextM0Time nextM0Time;
+	SpriteMapper mapper(nextM0Time, lyCounter, oam);
+
+	std::srand(1);
+	for (unsigned i = 0; i < 40; ++i) {
+		oam[i * 4    ] = c.spread ? 16 + i * 144 / 40 : 16 + std::rand() % 144;
+		oam[i * 4 + 1] =  8 + std::rand() % 160;
+	}
+
+	mapper.reset(oam, false);
+	check = 0;
+	cycle_t cc = 0;
+	std::clock_t const start = std::clock();
+
+	for (int f = 0; f < frames; ++f) {
+		for (unsigned k = 0; k < c.moved; ++k) {
+			unsigned const i = (f * 7 + k * 13) % 40;
+			++oam[i * 4];
+			++oam[i * 4 + 1];
+		}
+
+		if (c.full)
+			mapper.reset(oam, false);
+
+		mapper.oamChange(cc);
+		for (cycle_t t = cc + 456; t != disabled_time;)
+			t = mapper.doEvent(t);
+
+		for (unsigned ly = 0; ly < 144; ++ly) {
+			unsigned char const *const sprites = mapper.sprites(ly);
+			for (unsigned i = 0; i < mapper.numSprites(ly); ++i)
+				check = check * 31 + sprites[i];
+		}
+
+		cc += 70224;
+	}
+
+	return double(std::clock() - start) / CLOCKS_PER_SEC;
+}
+
+}
+
+int main(int argc, char **argv) {
+	int const frames = argc > 1 ? std::atoi(argv[1]) : 200000;
+	Case const cases[] = {
+		{ "full, 0 moved",          0, true,  false },
+		{ "full, 40 moved",        40, true,  false },
+		{ "full, 40 moved spread", 40, true,  true  },
+		{ "0 moved",                0, false, false },
+		{ "1 moved",                1, false, false },
+		{ "4 moved",                4, false, false },
+		{ "40 moved",              40, false, false },
+		{ "40 moved spread",       40, false, true  },
+	};
+
+	for (std::size_t i = 0; i < sizeof cases / sizeof cases[0]; ++i) {
+		unsigned check = 0;
+		double secs = run(cases[i], frames, check);
+		for (int r = 1; r < 5; ++r)
+			secs = std::min(secs, run(cases[i], frames, check));
+
+		// cases moving the same sprites must print the same check value
+		std::printf("%-22s %8.1f ns/frame check %08x\n", cases[i].name,
+		            secs * 1e9 / frames, check);
+	}
+
+	return 0;
+}
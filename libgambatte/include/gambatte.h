@@ -23,6 +23,7 @@
 #include "gbint.h"
 #include <string>
 #include <stddef.h>
+#include <stdint.h>
  #include <emscripten.h>
 
 namespace gambatte {
@@ -33,6 +34,43 @@ typedef uint_least32_t video_pixel_t;
 #endif
 enum { BG_PALETTE = 0, SP1_PALETTE = 1, SP2_PALETTE = 2 };
 
+/** Pixel formats runFor can draw video frames in. All are native endian. */
+enum PixelFormat {
+	PIXEL_RGB32,    /**< 32 bits per pixel, 0x00RRGGBB */
+	PIXEL_RGB565,   /**< 16 bits per pixel, RRRRRGGGGGGBBBBB */
+	PIXEL_XRGB1555, /**< 16 bits per pixel, 0RRRRRGGGGGBBBBB */
+	PIXEL_INDEXED8, /**< one byte per pixel: the palette slot drawn, see GB::framePalette */
+	PIXEL_GRAY8,    /**< one byte per pixel: luma 0-255 */
+#ifdef VIDEO_RGB565
+	PIXEL_NATIVE = PIXEL_RGB565 /**< the format of video_pixel_t */
+#else
+	PIXEL_NATIVE = PIXEL_RGB32
+#endif
+};
+
+/** A colour correction curve: the colour CGB colour bgr15 shows as in format.
+  * Called for all 32768 colours of a format when it is first used; format is
+  * never PIXEL_INDEXED8, which takes its colours from PIXEL_RGB32.
+  */
+typedef uint_least32_t (*ColorCurve)(unsigned bgr15, PixelFormat format);
+
+/** Fills PIXEL_INDEXED8 frames drawn while the display is off. */
+enum { INDEXED8_BLANK = 0xFF };
+
+/** A byte or halfword a RAM search has not ruled out, see GB::searchFilter. */
+struct SearchHit {
+	unsigned area;   /**< the GB::MemoryArea holding it: MEM_WRAM, MEM_CARTRAM or MEM_HRAM */
+	unsigned offset; /**< from the start of the area as getMemoryArea gives it */
+	unsigned value;  /**< at the last search step */
+};
+
+/** A palette slot taking a new colour part way through a frame. */
+struct PaletteChange {
+	unsigned pos;        /**< line * 160 + x of the first pixel drawn with the new colour */
+	unsigned char slot;
+	uint_least32_t color; /**< in the output format, RGB32 for PIXEL_INDEXED8 */
+};
+
 class GB {
 public:
 	GB();
@@ -61,13 +99,13 @@ public:
 	  * The return value indicates whether a new video frame has been drawn, and the
 	  * exact time (in number of samples) at which it was drawn.
 	  *
-	  * @param videoBuf 160x144 RGB32 (native endian) video frame buffer or 0
+	  * @param videoBuf 160x144 video frame buffer in the format set by setPixelFormat, or 0
 	  * @param pitch distance in number of pixels (not bytes) from the start of one line to the next in videoBuf.
 	  * @param soundBuf buffer with space >= samples + 2064
 	  * @param samples in: number of stereo samples to produce, out: actual number of samples produced
 	  * @return sample number at which the video frame was produced. -1 means no frame was produced.
 	  */
-	long runFor(gambatte::video_pixel_t *videoBuf, int pitch,
+	long runFor(void *videoBuf, int pitch,
 			gambatte::uint_least32_t *soundBuf, unsigned &samples);
 	
 	/** Reset to initial state.
@@ -86,11 +124,70 @@ public:
 	/** Sets the directory used for storing save data. The default is the same directory as the ROM Image file. */
 	void setSaveDir(const std::string &sdir);
 
+	/** Drives the MBC3 real-time clock from the emulated cycle counter instead of
+	  * the host clock, so runs replay identically and make no time syscalls.
+	  * The emulated clock reads epoch (unix time) at power-on. Its epoch and time
+	  * are kept in savestates, so loading a state saved with it restores them.
+	  * Loading a state keeps the clock source set here, switching a state saved
+	  * with the other one. Switching keeps the current clock registers. Off by
+	  * default.
+	  */
+	void setRtcEmulatedTime(bool enable, uint64_t epoch);
+
    void *savedata_ptr();
    unsigned savedata_size();
    void *rtcdata_ptr();
    unsigned rtcdata_size();
 	
+	/** Memory areas getMemoryArea gives direct access to. */
+	enum MemoryArea {
+		MEM_ROM,     /**< every ROM bank, bank 0 first */
+		MEM_VRAM,    /**< 0x8000-0x9FFF, both banks in CGB mode */
+		MEM_CARTRAM, /**< every cartridge RAM bank */
+		MEM_WRAM,    /**< 0xC000-0xDFFF, bank 0 followed by banks 1-7 in CGB mode */
+		MEM_OAM,     /**< 0xFE00-0xFE9F */
+		MEM_HRAM,    /**< 0xFF80-0xFFFE */
+		MEM_IE       /**< 0xFFFF, the interrupt enable register, for reading only */
+	};
+
+	/** Gets where an area of emulated memory is stored, for reading it in place.
+	  * Switchable areas hold every bank, whichever is mapped. The pointer stays
+	  * valid until the next load. Writing through it bypasses emulation, so only
+	  * cartridge RAM, WRAM and HRAM should be written, and only between runFor
+	  * calls. VRAM and OAM must only change through emulated bus writes, like
+	  * those of GameShark codes: the PPU always draws tiles from a decoded copy
+	  * of VRAM, and maps sprites from a copy of OAM, both updated on those writes.
+	  * @return false if the area is empty, like cartridge RAM on carts without it
+	  */
+	bool getMemoryArea(MemoryArea area, unsigned char **data, unsigned *length);
+
+	/** Ways searchFilter compares a value against the last search step. */
+	enum SearchFilter {
+		SEARCH_UNCHANGED,
+		SEARCH_CHANGED,
+		SEARCH_EQUAL_TO,     /**< equal to the operand */
+		SEARCH_INCREASED_BY, /**< by exactly the operand, wrapping */
+		SEARCH_DECREASED_BY  /**< by exactly the operand, wrapping */
+	};
+
+	/** Starts a RAM search over WRAM, cartridge RAM and HRAM with every byte
+	  * a candidate, and snapshots them. Loading a ROM ends the search.
+	  */
+	void searchReset();
+
+	/** Keeps the candidates whose value passes filter, then snapshots RAM for
+	  * the next step. Candidates ruled out stay out.
+	  * @param width 1 for bytes, 2 for little-endian halfwords
+	  * @return the number of candidates left
+	  */
+	unsigned searchFilter(SearchFilter filter, unsigned width, unsigned operand = 0);
+
+	/** Copies up to max candidates, in WRAM, cartridge RAM, HRAM and then
+	  * offset order.
+	  * @return the number of candidates, which may be more than max
+	  */
+	unsigned searchResults(SearchHit *hits, unsigned max) const;
+
 	/** Returns true if the currently loaded ROM image is treated as having CGB support. */
 	bool isCgb() const;
 	
@@ -98,17 +195,141 @@ public:
 	bool isLoaded() const;
 	
    void saveState(void *data);
+   /** Loads a state written by either saveState or saveStateFast. */
    void loadState(const void *data);
+   /** Size of a saveState buffer. Fixed for the loaded ROM, so this is cheap to query. */
    size_t stateSize() const;
 
+   /** Saves a fixed-layout binary state, written with a handful of memcpys.
+     * Meant for frequent save/load cycles (run-ahead, rollback). Unlike the
+     * labeled saveState format it is not portable between builds.
+     */
+   void saveStateFast(void *data);
+   size_t stateSizeFast() const;
+
+   /** Writes the parts of the current state that differ from 'baseline', a buffer
+     * written by saveStateFast for the same ROM, in units of small pages.
+     * @param out buffer of at least stateDeltaMaxSize() bytes
+     * @return number of bytes written to out
+     */
+   size_t saveStateDelta(const void *baseline, void *out);
+   size_t stateDeltaMaxSize() const;
+
+   /** Loads the state obtained by applying a saveStateDelta result to the baseline it was made against.
+     * @return false if the delta or baseline does not match the loaded ROM
+     */
+   bool applyStateDelta(const void *baseline, const void *delta);
+
+   /** Enables the built-in rewind buffer. A snapshot is taken every 'interval' frames
+     * and kept as a compressed delta against the next one, so consecutive
+     * snapshots cost about as much as the memory they actually changed.
+     * Cleared on ROM load and reset.
+     *
+     * @param budget bytes of snapshot history to keep; the oldest snapshots are dropped first. 0 disables rewind.
+     * @param interval number of video frames between snapshots
+     */
+   void setRewind(std::size_t budget, unsigned interval = 1);
+
+   /** Restores the previous rewind snapshot.
+     * @return false if there is no older snapshot to go back to
+     */
+   bool rewind();
+
+   /** Number of times rewind() can currently succeed. */
+   unsigned rewindSteps() const;
+
+   /** Sets the format runFor draws in. The default is PIXEL_NATIVE. Takes effect
+     * immediately; a frame being drawn mixes the two formats.
+     */
+   void setPixelFormat(PixelFormat format);
+
+   /** Colours of the 64 palette slots when the last frame started drawing.
+     * Slots 0-31 hold the 8 background palettes and 32-63 the 8 sprite palettes,
+     * 4 colours each; in DMG mode BGP is in 0-3, OBP0 in 32-35 and OBP1 in 36-39.
+     * Colours are in the output format, RGB32 for PIXEL_INDEXED8. Together with
+     * paletteChanges this maps a PIXEL_INDEXED8 frame back to colours.
+     */
+   const uint_least32_t * framePalette() const;
+
+   /** Palette changes made while the last frame was drawing, in drawing order.
+     * Only recorded while drawing in PIXEL_INDEXED8; other formats get none.
+     * @param count out: number of changes
+     */
+   const PaletteChange * paletteChanges(std::size_t &count) const;
+
+   /** Lines of the last frame that differ from the frame before it, as a 144-bit
+     * mask: bit (ly & 7) of byte (ly >> 3) is set if line ly changed. Lines are
+     * compared by hash in the output format as they are drawn, so the mask does not
+     * depend on videoBuf being reused. Lines drawn without a frame buffer are always
+     * marked. A frame blanked while the LCD is off is hashed once cleared, so it is
+     * marked where it differs from the frame before it, and a run of blanked frames
+     * is marked only at its start.
+     *
+     * Lines are only hashed from the first call of dirtyLines, lineHashes or
+     * frameHash on, so the frames before and the one being drawn then are marked
+     * in full.
+     */
+   const unsigned char * dirtyLines() const;
+
+   /** Hash of each line of the last frame, in the output format, as it was drawn.
+     * 0 for lines drawn without a frame buffer or before line hashing started, see
+     * dirtyLines. Comparing these between two runs finds the first line where they
+     * diverge.
+     * @return 144 64-bit hashes, indexed by ly
+     */
+   const uint64_t * lineHashes() const;
+
+   /** Hash of the last frame, combining its 144 lineHashes. */
+   uint64_t frameHash() const;
+
+   /** Hash of the audio samples runFor produced for the last frame, from the end
+     * of the frame before it up to the sample its return value points at. Samples
+     * of a partly run frame are dropped by reset and state loads.
+     */
+   uint64_t audioHash() const;
+
+   /** Draws the 768 tiles of both VRAM banks into a 256x192 RGB32 buffer with one of
+     * the current palettes: 16 tiles per row, bank 0 on the left, bank 1 on the right.
+     * Like the other debug views, only what changed since the last call is redrawn,
+     * so pass the same buffer every time.
+     * @param palette 0-7 for a background palette, 8-15 for a sprite palette
+     */
+   void drawTileSheet(uint_least32_t *buf, std::ptrdiff_t pitch, unsigned palette);
+
+   /** Draws BG map 0 (0x9800) or 1 (0x9C00) into a 256x256 RGB32 buffer as the
+     * background would show it, with the current tile data area, palettes and,
+     * in CGB mode, each entry's bank and flips.
+     */
+   void drawTileMap(uint_least32_t *buf, std::ptrdiff_t pitch, unsigned map);
+
+   /** Draws the 40 OAM sprites into a 64x80 RGB32 buffer as 8x16 cells, 8 per row,
+     * with their palettes and flips. Transparent pixels, and the lower half of 8x8
+     * sprites, are 0.
+     */
+   void drawSprites(uint_least32_t *buf, std::ptrdiff_t pitch);
+
    void setColorCorrection(bool enable);
-   video_pixel_t gbcToRgb32(const unsigned bgr15);
+
+   /** Sets the curve colour correction uses while enabled. 0 restores the built-in
+     * one. Its colours are cached by this GB until the curve or pixel format changes;
+     * setting the same curve again picks up colours it now gives differently.
+     */
+   void setColorCurve(ColorCurve curve);
+
+   /** Converts a CGB colour to RGB32 with the current colour correction setting. */
+   uint_least32_t gbcToRgb32(const unsigned bgr15);
 
    /** Set Game Genie codes to apply to currently loaded ROM image. Cleared on ROM load.
     * @param codes Game Genie codes in format HHH-HHH-HHH;HHH-HHH-HHH;... where H is [0-9]|[A-F]
     */
    void setGameGenie(const std::string &codes);
 
+   /** Enables or disables Game Genie codes without touching the others. Codes are
+    * parsed and located in the ROM once, so toggling a code only rewrites its bytes.
+    * @param codes Game Genie codes in the format setGameGenie takes
+    */
+   void enableGameGenie(const std::string &codes, bool enable);
+
    /** Set Game Shark codes to apply to currently loaded ROM image. Cleared on ROM load.
     * @param codes Game Shark codes in format 01HHHHHH;01HHHHHH;... where H is [0-9]|[A-F]
     */
@@ -5,10 +5,12 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <string.h>
 #include <stdlib.h>
+#include <time.h>
 
 #ifdef _3DS
 extern "C" void* linearMemAlign(size_t size, size_t alignment);
@@ -21,8 +23,9 @@ static retro_input_poll_t input_poll_cb;
 static retro_input_state_t input_state_cb;
 static retro_audio_sample_batch_t audio_batch_cb;
 static retro_environment_t environ_cb;
-static gambatte::video_pixel_t* video_buf;
+static void* video_buf;
 static gambatte::uint_least32_t video_pitch;
+static unsigned video_pixel_bytes = 4;
 static gambatte::GB gb;
 
 #include "cc_resampler.h"
@@ -118,11 +121,10 @@ void retro_init(void)
 #endif
 
 #ifdef _3DS
-   video_buf = (gambatte::video_pixel_t*)
-               linearMemAlign(256 * 144 * sizeof(gambatte::video_pixel_t), 128);
+   // large enough for any pixel format
+   video_buf = linearMemAlign(256 * 144 * 4, 128);
 #else
-   video_buf = (gambatte::video_pixel_t*)
-               malloc(256 * 144 * sizeof(gambatte::video_pixel_t));
+   video_buf = malloc(256 * 144 * 4);
 #endif
    video_pitch = 256;
 
@@ -151,6 +153,7 @@ void retro_set_environment(retro_environment_t cb)
       { "gambatte_gb_internal_palette", "Internal Palette; GBC - Blue|GBC - Brown|GBC - Dark Blue|GBC - Dark Brown|GBC - Dark Green|GBC - Grayscale|GBC - Green|GBC - Inverted|GBC - Orange|GBC - Pastel Mix|GBC - Red|GBC - Yellow|Special 1|Special 2|Special 3" },
       { "gambatte_gbc_color_correction", "Color correction; enabled|disabled" },
       { "gambatte_gb_hwmode", "Emulated hardware; Auto|GB|GBA" }, // unfortunately, libgambatte does not have a 'force GBC' flag
+      { "gambatte_rtc_clock", "RTC clock; host time|emulated time" },
       { NULL, NULL },
    };
 
@@ -184,28 +187,44 @@ void retro_reset()
    }
 }
 
-static size_t serialize_size = 0;
+// Bit 0: video wanted, bit 1: audio wanted, bit 2: fast savestates,
+// bit 3: audio will never be wanted. Frontends running ahead clear the
+// first two for the hidden frames.
+static int audio_video_enable()
+{
+   int enable = 3;
+
+   if (!environ_cb(RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE, &enable))
+      return 3;
+
+   return enable;
+}
+
 size_t retro_serialize_size(void)
 {
-   return gb.stateSize();
+   // Either format may be requested for the same buffer.
+   return std::max(gb.stateSize(), gb.stateSizeFast());
 }
 
 bool retro_serialize(void *data, size_t size)
 {
-   serialize_size = retro_serialize_size();
-
-   if (size != serialize_size)
+   if (size != retro_serialize_size())
       return false;
 
+   if (audio_video_enable() & 4)
+   {
+      gb.saveStateFast(data);
+      return true;
+   }
+
    gb.saveState(data);
+   memset((char*)data + gb.stateSize(), 0, size - gb.stateSize());
    return true;
 }
 
 bool retro_unserialize(const void *data, size_t size)
 {
-   serialize_size = retro_serialize_size();
-
-   if (size != serialize_size)
+   if (size != retro_serialize_size())
       return false;
 
    gb.loadState(data);
@@ -221,7 +240,7 @@ void retro_cheat_set(unsigned index, bool enabled, const char *code)
 {
    std::string s = code;
    if (s.find("-") != std::string::npos)
-      gb.setGameGenie(code);
+      gb.enableGameGenie(code, enabled);
    else
       gb.setGameShark(code);
 }
@@ -323,12 +342,6 @@ static void load_custom_palette(void)
                custom_palette_path.c_str(), line_count);
          continue;
       }
-#ifdef VIDEO_RGB565
-      rgb32=(rgb32&0x0000F8)>>3 |//red
-            (rgb32&0x00FC00)>>5 |//green
-            (rgb32&0xF80000)>>8;//blue
-#endif
-
       if (startswith(line, "Background0="))
          gb.setDmgPaletteColor(0, 0, rgb32);
       else if (startswith(line, "Background1="))
@@ -357,6 +370,18 @@ static void load_custom_palette(void)
    } // endfor
 }
 
+// host time at load, which the emulated RTC clock reads at power-on
+static uint64_t rtc_epoch;
+static bool rtc_emulated_time;
+
+static bool get_rtc_emulated_time(void)
+{
+   struct retro_variable var = {0};
+   var.key = "gambatte_rtc_clock";
+   return environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value
+      && !strcmp(var.value, "emulated time");
+}
+
 static void check_variables(void)
 {
    bool colorCorrection=true;
@@ -365,6 +390,14 @@ static void check_variables(void)
    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value && !strcmp(var.value, "disabled")) colorCorrection=false;
    gb.setColorCorrection(colorCorrection);
 
+   // switching keeps the RTC registers, and the epoch stays the one set at load
+   const bool rtcEmulatedTime = get_rtc_emulated_time();
+   if (rtcEmulatedTime != rtc_emulated_time)
+   {
+      rtc_emulated_time = rtcEmulatedTime;
+      gb.setRtcEmulatedTime(rtc_emulated_time, rtc_epoch);
+   }
+
    var.key = "gambatte_gb_colorization";
 
    if (!environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) || !var.value)
@@ -435,15 +468,104 @@ static void check_variables(void)
    }
 }
 
-static unsigned pow2ceil(unsigned n) {
-   --n;
-   n |= n >> 1;
-   n |= n >> 2;
-   n |= n >> 4;
-   n |= n >> 8;
-   ++n;
+static bool set_pixel_format(enum retro_pixel_format fmt, gambatte::PixelFormat format, unsigned bytes)
+{
+   if (!environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &fmt))
+      return false;
+
+   gb.setPixelFormat(format);
+   video_pixel_bytes = bytes;
+   return true;
+}
+
+// Describes memory at its Game Boy addresses, plus the CGB WRAM banks 2-7 at
+// 0x10000-0x15FFF where achievement runtimes expect them. Switchable areas
+// show the bank mapped at load, which is bank 1 for ROM and WRAM. Descriptors
+// are matched in order, so IE is claimed before the HRAM range that ends at it.
+static void set_memory_maps(void)
+{
+   unsigned char *rom, *vram, *sram, *wram, *oam, *hram, *ie;
+   unsigned romsize, vramsize, sramsize, wramsize, oamsize, hramsize, iesize;
+   struct retro_memory_descriptor descs[11];
+   unsigned n = 0;
+
+   if (!gb.getMemoryArea(gambatte::GB::MEM_ROM, &rom, &romsize)
+         || !gb.getMemoryArea(gambatte::GB::MEM_VRAM, &vram, &vramsize)
+         || !gb.getMemoryArea(gambatte::GB::MEM_WRAM, &wram, &wramsize)
+         || !gb.getMemoryArea(gambatte::GB::MEM_OAM, &oam, &oamsize)
+         || !gb.getMemoryArea(gambatte::GB::MEM_HRAM, &hram, &hramsize)
+         || !gb.getMemoryArea(gambatte::GB::MEM_IE, &ie, &iesize))
+      return;
+
+   const bool has_sram = gb.getMemoryArea(gambatte::GB::MEM_CARTRAM, &sram, &sramsize);
+   memset(descs, 0, sizeof(descs));
+
+   descs[n].flags = RETRO_MEMDESC_CONST;
+   descs[n].ptr = rom;
+   descs[n].start = 0x0000;
+   descs[n++].len = 0x4000;
+
+   descs[n].flags = RETRO_MEMDESC_CONST;
+   descs[n].ptr = rom;
+   descs[n].offset = 0x4000;
+   descs[n].start = 0x4000;
+   descs[n++].len = 0x4000;
+
+   // VRAM, OAM and IE feed caches and registers that writes from outside
+   // the core would not update, so frontends may only read them
+   descs[n].flags = RETRO_MEMDESC_CONST;
+   descs[n].ptr = vram;
+   descs[n].start = 0x8000;
+   descs[n++].len = 0x2000;
+
+   if (has_sram)
+   {
+      descs[n].ptr = sram;
+      descs[n].start = 0xA000;
+      descs[n++].len = std::min(sramsize, 0x2000u);
+   }
+
+   descs[n].ptr = wram;
+   descs[n].start = 0xC000;
+   descs[n++].len = 0x1000;
+
+   descs[n].ptr = wram;
+   descs[n].offset = 0x1000;
+   descs[n].start = 0xD000;
+   descs[n++].len = 0x1000;
+
+   descs[n].flags = RETRO_MEMDESC_CONST;
+   descs[n].ptr = oam;
+   descs[n].start = 0xFE00;
+   descs[n].select = 0xFF00;
+   descs[n++].len = oamsize;
+
+   descs[n].flags = RETRO_MEMDESC_CONST;
+   descs[n].ptr = ie;
+   descs[n].start = 0xFFFF;
+   descs[n].select = 0xFFFF;
+   descs[n++].len = iesize;
+
+   descs[n].ptr = hram;
+   descs[n].start = 0xFF80;
+   descs[n].select = 0xFF80;
+   descs[n++].len = hramsize;
+
+   if (wramsize > 0x2000)
+   {
+      descs[n].ptr = wram;
+      descs[n].offset = 0x2000;
+      descs[n].start = 0x10000;
+      descs[n++].len = 0x4000;
+
+      descs[n].ptr = wram;
+      descs[n].offset = 0x6000;
+      descs[n].start = 0x14000;
+      descs[n++].len = 0x2000;
+   }
 
-   return n;
+   struct retro_memory_map maps = { descs, n };
+   environ_cb(RETRO_ENVIRONMENT_SET_MEMORY_MAPS, &maps);
 }
 
 bool retro_load_game(const struct retro_game_info *info)
@@ -471,21 +593,16 @@ bool retro_load_game(const struct retro_game_info *info)
 
    environ_cb(RETRO_ENVIRONMENT_SET_INPUT_DESCRIPTORS, desc);
 
-#ifdef VIDEO_RGB565
-   enum retro_pixel_format fmt = RETRO_PIXEL_FORMAT_RGB565;
-   if (!environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &fmt))
-   {
-      log_cb(RETRO_LOG_ERROR, "[Gambatte]: RGB565 is not supported.\n");
-      return false;
-   }
-#else
-   enum retro_pixel_format fmt = RETRO_PIXEL_FORMAT_XRGB8888;
-   if (!environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &fmt))
+   // Prefer the format video_pixel_t is built for, then whatever the frontend takes.
+   if (!(gambatte::PIXEL_NATIVE == gambatte::PIXEL_RGB565
+            && set_pixel_format(RETRO_PIXEL_FORMAT_RGB565, gambatte::PIXEL_RGB565, 2))
+         && !set_pixel_format(RETRO_PIXEL_FORMAT_XRGB8888, gambatte::PIXEL_RGB32, 4)
+         && !set_pixel_format(RETRO_PIXEL_FORMAT_RGB565, gambatte::PIXEL_RGB565, 2)
+         && !set_pixel_format(RETRO_PIXEL_FORMAT_0RGB1555, gambatte::PIXEL_XRGB1555, 2))
    {
-      log_cb(RETRO_LOG_ERROR, "[Gambatte]: XRGB8888 is not supported.\n");
+      log_cb(RETRO_LOG_ERROR, "[Gambatte]: no supported pixel format.\n");
       return false;
    }
-#endif
 
    unsigned flags = 0;
    struct retro_variable var = {0};
@@ -496,6 +613,10 @@ bool retro_load_game(const struct retro_game_info *info)
       if (!strcmp(var.value, "GBA")) flags |= gambatte::GB::GBA_CGB;
    }
 
+   rtc_epoch = time(0);
+   rtc_emulated_time = get_rtc_emulated_time();
+   gb.setRtcEmulatedTime(rtc_emulated_time, rtc_epoch);
+
    if (gb.load(info->data, info->size, flags) != 0)
       return false;
 
@@ -507,30 +628,7 @@ bool retro_load_game(const struct retro_game_info *info)
 
    check_variables();
 
-   //Ugly hack alert: This entire thing depends upon cartridge.cpp and memptrs.cpp not changing in weird ways.
-   unsigned sramsize = gb.savedata_size();
-   if (sramsize)
-   {
-      unsigned romsize = pow2ceil(info->size) & ~0x4000;
-      unsigned ramsize = (gb.isCgb() ? 8 : 2) * 0x1000ul;
-      char * sramdata = (char*)gb.savedata_ptr();
-      char * romdata = sramdata - romsize;
-      char * ramdata = sramdata + sramsize;
-      struct retro_memory_descriptor descs[3];
-      memset(descs, 0, sizeof(descs));
-      descs[0].ptr=ramdata;
-      descs[0].len=ramsize;
-      descs[0].addrspace="";
-      descs[1].ptr=sramdata;
-      descs[1].len=sramsize;
-      descs[1].addrspace="S";
-      descs[2].ptr=romdata;
-      descs[2].len=romsize;
-      descs[2].addrspace="R";
-      descs[2].flags=RETRO_MEMDESC_CONST;
-      struct retro_memory_map maps={descs, 3};
-      environ_cb(RETRO_ENVIRONMENT_SET_MEMORY_MAPS, &maps);
-   }
+   set_memory_maps();
 
    return true;
 }
@@ -552,11 +650,11 @@ void *retro_get_memory_data(unsigned id)
       case RETRO_MEMORY_RTC:
          return gb.rtcdata_ptr();
       case RETRO_MEMORY_SYSTEM_RAM:
-         /* Really ugly hack here, relies upon 
-          * libgambatte/src/memory/memptrs.cpp MemPtrs::reset not
-          * realizing that that memchunk hack is ugly, or 
-          * otherwise getting rearranged. */
-         return (char*)gb.savedata_ptr() + gb.savedata_size();
+      {
+         unsigned char *data;
+         unsigned size;
+         return gb.getMemoryArea(gambatte::GB::MEM_WRAM, &data, &size) ? data : 0;
+      }
    }
 
    return 0;
@@ -571,14 +669,11 @@ size_t retro_get_memory_size(unsigned id)
       case RETRO_MEMORY_RTC:
          return gb.rtcdata_size();
       case RETRO_MEMORY_SYSTEM_RAM:
-         /* This is rather hacky too... it relies upon 
-          * libgambatte/src/memory/cartridge.cpp not changing
-          * the call to memptrs.reset, but this is 
-          * probably mostly safe.
-          *
-          * GBC will probably not get a
-          * hardware upgrade anytime soon. */
-         return (gb.isCgb() ? 8 : 2) * 0x1000ul;
+      {
+         unsigned char *data;
+         unsigned size;
+         return gb.getMemoryArea(gambatte::GB::MEM_WRAM, &data, &size) ? size : 0;
+      }
    }
 
    return 0;
@@ -600,14 +695,15 @@ void retro_run()
 
    input_poll_cb();
 
+   const int av_enable = audio_video_enable();
+   const bool audio_enabled = (av_enable & 2) && !(av_enable & 8);
+   // A null frame buffer makes the PPU draw into its scratch line only.
+   void *const fb = (av_enable & 1) ? video_buf : 0;
+
    uint64_t expected_frames = samples_count / 35112;
    if (frames_count < expected_frames) // Detect frame dupes.
    {
-#ifdef VIDEO_RGB565
-      video_cb(0, 160, 144, 512);
-#else
-      video_cb(0, 160, 144, 1024);
-#endif
+      video_cb(0, 160, 144, video_pitch * video_pixel_bytes);
       frames_count++;
       return;
    }
@@ -619,46 +715,50 @@ void retro_run()
    } static sound_buf;
    unsigned samples = 2064;
 
-   while (gb.runFor(video_buf, video_pitch, sound_buf.u32, samples) == -1)
+   while (gb.runFor(fb, video_pitch, sound_buf.u32, samples) == -1)
    {
+      if (audio_enabled)
+      {
 #ifdef CC_RESAMPLER
-      CC_renderaudio((audio_frame_t*)sound_buf.u32, samples);
+         CC_renderaudio((audio_frame_t*)sound_buf.u32, samples);
 #else
-      render_audio(sound_buf.i16, samples);
-
-      unsigned read_avail = blipper_read_avail(resampler_l);
-      if (read_avail >= 512)
-      {
-         blipper_read(resampler_l, sound_buf.i16 + 0, read_avail, 2);
-         blipper_read(resampler_r, sound_buf.i16 + 1, read_avail, 2);
-         audio_batch_cb(sound_buf.i16, read_avail);
+         render_audio(sound_buf.i16, samples);
+
+         unsigned read_avail = blipper_read_avail(resampler_l);
+         if (read_avail >= 512)
+         {
+            blipper_read(resampler_l, sound_buf.i16 + 0, read_avail, 2);
+            blipper_read(resampler_r, sound_buf.i16 + 1, read_avail, 2);
+            audio_batch_cb(sound_buf.i16, read_avail);
+         }
+#endif
       }
 
-#endif
       samples_count += samples;
       samples = 2064;
    }
 
    samples_count += samples;
 
+   if (audio_enabled)
+   {
 #ifdef CC_RESAMPLER
-   CC_renderaudio((audio_frame_t*)sound_buf.u32, samples);
-#else
-   render_audio(sound_buf.i16, samples);
-#endif
-
-#ifdef VIDEO_RGB565
-   video_cb(video_buf, 160, 144, 512);
+      CC_renderaudio((audio_frame_t*)sound_buf.u32, samples);
 #else
-   video_cb(video_buf, 160, 144, 1024);
+      render_audio(sound_buf.i16, samples);
 #endif
+   }
 
+   video_cb(fb, 160, 144, video_pitch * video_pixel_bytes);
 
 #ifndef CC_RESAMPLER
-   unsigned read_avail = blipper_read_avail(resampler_l);
-   blipper_read(resampler_l, sound_buf.i16 + 0, read_avail, 2);
-   blipper_read(resampler_r, sound_buf.i16 + 1, read_avail, 2);
-   audio_batch_cb(sound_buf.i16, read_avail);
+   if (audio_enabled)
+   {
+      unsigned read_avail = blipper_read_avail(resampler_l);
+      blipper_read(resampler_l, sound_buf.i16 + 0, read_avail, 2);
+      blipper_read(resampler_r, sound_buf.i16 + 1, read_avail, 2);
+      audio_batch_cb(sound_buf.i16, read_avail);
+   }
 #endif
 
    frames_count++;
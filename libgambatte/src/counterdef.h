@@ -1,9 +1,14 @@
 #ifndef COUNTERDEF_H
 #define COUNTERDEF_H
 
+#include <stdint.h>
+
 namespace gambatte {
 
-enum { disabled_time = 0xfffffffful };
+// Cycle counts are monotonic 64-bit values that never need rebasing.
+typedef uint64_t cycle_t;
+
+cycle_t const disabled_time = ~static_cast<cycle_t>(0);
 
 }
 
@@ -48,12 +48,7 @@ long CPU::runFor(unsigned long const cycles) {
          }, cycles);
 	process(cycles);
 
-	long const csb = mem_.cyclesSinceBlit(cycleCounter_);
-
-	if (cycleCounter_ & 0x80000000)
-		cycleCounter_ = mem_.resetCounters(cycleCounter_);
-
-	return csb;
+	return mem_.cyclesSinceBlit(cycleCounter_);
 }
 
 enum { hf2_hcf = 0x200, hf2_subf = 0x400, hf2_incf = 0x800 };
@@ -88,7 +83,14 @@ void CPU::setStatePtrs(SaveState &state) {
 }
 
 void CPU::saveState(SaveState &state) {
-	cycleCounter_ = mem_.saveState(state, cycleCounter_);
+	writeState(state);
+	EM_ASM_INT({
+           window.cpuSaveState($0, $1, $2, $3, $4, $5, $6);
+         }, static_cast<double>(cycleCounter_), pc_, sp, a_, b, c,d,e,hf2, cf, zf,h,l,skip_);
+}
+
+void CPU::writeState(SaveState &state) {
+	mem_.saveState(state, cycleCounter_);
 	hf2 = updateHf2FromHf1(hf1, hf2);
 
 	state.cpu.cycleCounter = cycleCounter_;
@@ -103,9 +105,6 @@ void CPU::saveState(SaveState &state) {
 	state.cpu.h = h;
 	state.cpu.l = l;
 	state.cpu.skip = skip_;
-	EM_ASM_INT({
-           window.cpuSaveState($0, $1, $2, $3, $4, $5, $6);
-         }, cycleCounter_, pc_, sp, a_, b, c,d,e,hf2, cf, zf,h,l,skip_);
 }
 
 void CPU::loadState(SaveState const &state) {
@@ -500,19 +499,19 @@ void CPU::process(unsigned long const cycles) {
 	mem_.updateInput();
 
 	unsigned char a = a_;
-	unsigned long cycleCounter = cycleCounter_;
+	cycle_t cycleCounter = cycleCounter_;
 
 	while (mem_.isActive()) {
 		unsigned short pc = pc_;
 
 		if (mem_.halted()) {
 			if (cycleCounter < mem_.nextEventTime()) {
-				unsigned long cycles = mem_.nextEventTime() - cycleCounter;
+				cycle_t cycles = mem_.nextEventTime() - cycleCounter;
 				cycleCounter += cycles + (-cycles & 3);
 			}
 			EM_ASM_INT({
            		window.memHalted($0);
-         		}, cycleCounter);
+         		}, static_cast<double>(cycleCounter));
 		} else while (cycleCounter < mem_.nextEventTime()) {
 			unsigned char opcode;
 
@@ -609,7 +608,7 @@ void CPU::process(unsigned long const cycles) {
 				cycleCounter = mem_.stop(cycleCounter);
 
 				if (cycleCounter < mem_.nextEventTime()) {
-					unsigned long cycles = mem_.nextEventTime() - cycleCounter;
+					cycle_t cycles = mem_.nextEventTime() - cycleCounter;
 					cycleCounter += cycles + (-cycles & 3);
 				}
 
@@ -1023,7 +1022,7 @@ void CPU::process(unsigned long const cycles) {
 					mem_.halt();
 
 					if (cycleCounter < mem_.nextEventTime()) {
-						unsigned long cycles = mem_.nextEventTime() - cycleCounter;
+						cycle_t cycles = mem_.nextEventTime() - cycleCounter;
 						cycleCounter += cycles + (-cycles & 3);
 					}
 				}
@@ -31,6 +31,8 @@ public:
 	long runFor(unsigned long cycles);
 	void setStatePtrs(SaveState &state);
 	void saveState(SaveState &state);
+	// saveState without the cpuSaveState hook
+	void writeState(SaveState &state);
 	void loadState(SaveState const &state);
 #if 0
 	void loadSavedata() { mem_.loadSavedata(); }
@@ -45,7 +47,7 @@ public:
    void clearCheats() { mem_.clearCheats(); }
 #endif
 
-	void setVideoBuffer(video_pixel_t *videoBuf, std::ptrdiff_t pitch) {
+	void setVideoBuffer(void *videoBuf, std::ptrdiff_t pitch) {
 		mem_.setVideoBuffer(videoBuf, pitch);
 	}
 
@@ -71,17 +73,20 @@ public:
 	void setSoundBuffer(uint_least32_t *buf) { mem_.setSoundBuffer(buf); }
 	std::size_t fillSoundBuffer() { return mem_.fillSoundBuffer(cycleCounter_); }
 	bool isCgb() const { return mem_.isCgb(); }
+	unsigned char * memoryArea(unsigned area, unsigned *length) { return mem_.memoryArea(area, length); }
 
 	void setDmgPaletteColor(int palNum, int colorNum, unsigned long rgb32) {
 		mem_.setDmgPaletteColor(palNum, colorNum, rgb32);
 	}
 
 	void setGameGenie(std::string const &codes) { mem_.setGameGenie(codes); }
+	void enableGameGenie(std::string const &codes, bool enable) { mem_.enableGameGenie(codes, enable); }
+	void setRtcEmulatedTime(bool enable, uint64_t epoch) { mem_.setRtcEmulatedTime(enable, epoch); }
 	void setGameShark(std::string const &codes) { mem_.setGameShark(codes); }
 
 	Memory mem_;
 private:
-	unsigned long cycleCounter_;
+	cycle_t cycleCounter_;
 	unsigned short pc_;
 	unsigned short sp;
 	unsigned hf1, hf2, zf, cf;
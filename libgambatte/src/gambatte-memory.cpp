@@ -21,6 +21,7 @@
 #include "savestate.h"
 #include "sound.h"
 #include "video.h"
+#include <algorithm>
 #include <cstring>
 
 namespace gambatte {
@@ -49,8 +50,7 @@ void Memory::setStatePtrs(SaveState &state) {
 	psg_.setStatePtrs(state);
 }
 
-unsigned long Memory::saveState(SaveState &state, unsigned long cc) {
-	cc = resetCounters(cc);
+void Memory::saveState(SaveState &state, cycle_t cc) {
 	nontrivial_ff_read(0x05, cc);
 	nontrivial_ff_read(0x0F, cc);
 	nontrivial_ff_read(0x26, cc);
@@ -68,11 +68,9 @@ unsigned long Memory::saveState(SaveState &state, unsigned long cc) {
 	tima_.saveState(state);
 	lcd_.saveState(state);
 	psg_.saveState(state);
-
-	return cc;
 }
 
-static int serialCntFrom(unsigned long cyclesUntilDone, bool cgbFast) {
+static int serialCntFrom(cycle_t cyclesUntilDone, bool cgbFast) {
 	return cgbFast ? (cyclesUntilDone + 0xF) >> 4 : (cyclesUntilDone + 0x1FF) >> 9;
 }
 
@@ -116,9 +114,11 @@ void Memory::loadState(SaveState const &state) {
 
 	if (!isCgb())
 		std::memset(cart_.vramdata() + 0x2000, 0, 0x2000);
+
+	lcd_.refreshTileCache();
 }
 
-void Memory::setEndtime(unsigned long cc, unsigned long inc) {
+void Memory::setEndtime(cycle_t cc, cycle_t inc) {
 	if (intreq_.eventTime(intevent_blit) <= cc) {
 		intreq_.setEventTime<intevent_blit>(intreq_.eventTime(intevent_blit)
 		                                   + (70224 << isDoubleSpeed()));
@@ -127,7 +127,7 @@ void Memory::setEndtime(unsigned long cc, unsigned long inc) {
 	intreq_.setEventTime<intevent_end>(cc + (inc << isDoubleSpeed()));
 }
 
-void Memory::updateSerial(unsigned long const cc) {
+void Memory::updateSerial(cycle_t const cc) {
 	if (intreq_.eventTime(intevent_serial) != disabled_time) {
 		if (intreq_.eventTime(intevent_serial) <= cc) {
 			ioamhram_[0x101] = (((ioamhram_[0x101] + 1) << serialCnt_) - 1) & 0xFF;
@@ -143,18 +143,18 @@ void Memory::updateSerial(unsigned long const cc) {
 	}
 }
 
-void Memory::updateTimaIrq(unsigned long cc) {
+void Memory::updateTimaIrq(cycle_t cc) {
 	while (intreq_.eventTime(intevent_tima) <= cc)
 		tima_.doIrqEvent(TimaInterruptRequester(intreq_));
 }
 
-void Memory::updateIrqs(unsigned long cc) {
+void Memory::updateIrqs(cycle_t cc) {
 	updateSerial(cc);
 	updateTimaIrq(cc);
 	lcd_.update(cc);
 }
 
-unsigned long Memory::event(unsigned long cc) {
+cycle_t Memory::event(cycle_t cc) {
 	if (lastOamDmaUpdate_ != disabled_time)
 		updateOamDma(cc);
 
@@ -177,7 +177,7 @@ unsigned long Memory::event(unsigned long cc) {
 	case intevent_blit:
 		{
 			bool const lcden = ioamhram_[0x140] & lcdc_en;
-			unsigned long blitTime = intreq_.eventTime(intevent_blit);
+			cycle_t blitTime = intreq_.eventTime(intevent_blit);
 
 			if (lcden | blanklcd_) {
 				lcd_.updateScreen(blanklcd_, cc);
@@ -198,7 +198,7 @@ unsigned long Memory::event(unsigned long cc) {
 		break;
 	case intevent_oam:
 		intreq_.setEventTime<intevent_oam>(lastOamDmaUpdate_ == disabled_time
-			? static_cast<unsigned long>(disabled_time)
+			? disabled_time
 			: intreq_.eventTime(intevent_oam) + 0xA0 * 4);
 		break;
 	case intevent_dma:
@@ -221,8 +221,17 @@ unsigned long Memory::event(unsigned long cc) {
 			if (!(ioamhram_[0x140] & lcdc_en))
 				dmaLength = 0;
 
-			{
-				unsigned long lOamDmaUpdate = lastOamDmaUpdate_;
+			if (length && lastOamDmaUpdate_ == disabled_time && isPlainDmaSource(dmaSrc, length)
+					&& lcd_.vramIdleThrough(cc + (2 << doubleSpeed), cc + length * (2 << doubleSpeed))) {
+				// Nothing observes the transfer between its first and last write,
+				// so it can be done as a block at the time of the last write.
+				cc += length * (2 << doubleSpeed);
+				lcd_.vramChange(cc);
+				copyDmaBlock(dmaSrc, dmaDest, length);
+				dmaSrc += length;
+				dmaDest += length;
+			} else {
+				cycle_t lOamDmaUpdate = lastOamDmaUpdate_;
 				lastOamDmaUpdate_ = disabled_time;
 
 				while (length--) {
@@ -273,7 +282,7 @@ unsigned long Memory::event(unsigned long cc) {
 		tima_.doIrqEvent(TimaInterruptRequester(intreq_));
 		break;
 	case intevent_video:
-		lcd_.update(cc);
+		lcd_.doEvent(cc);
 		break;
 	case intevent_interrupts:
 		if (halted()) {
@@ -304,11 +313,12 @@ unsigned long Memory::event(unsigned long cc) {
 	return cc;
 }
 
-unsigned long Memory::stop(unsigned long cc) {
+cycle_t Memory::stop(cycle_t cc) {
 	cc += 4 + 4 * isDoubleSpeed();
 
 	if (ioamhram_[0x14D] & isCgb()) {
 		psg_.generateSamples(cc, isDoubleSpeed());
+		cart_.updateRtc(cc, isDoubleSpeed());
 		lcd_.speedChange(cc);
 		ioamhram_[0x14D] ^= 0x81;
 		intreq_.setEventTime<intevent_blit>((ioamhram_[0x140] & lcdc_en)
@@ -328,48 +338,6 @@ unsigned long Memory::stop(unsigned long cc) {
 	return cc;
 }
 
-static void decCycles(unsigned long &counter, unsigned long dec) {
-	if (counter != disabled_time)
-		counter -= dec;
-}
-
-void Memory::decEventCycles(IntEventId eventId, unsigned long dec) {
-	if (intreq_.eventTime(eventId) != disabled_time)
-		intreq_.setEventTime(eventId, intreq_.eventTime(eventId) - dec);
-}
-
-unsigned long Memory::resetCounters(unsigned long cc) {
-	if (lastOamDmaUpdate_ != disabled_time)
-		updateOamDma(cc);
-
-	updateIrqs(cc);
-
-	{
-		unsigned long divinc = (cc - divLastUpdate_) >> 8;
-		ioamhram_[0x104] = (ioamhram_[0x104] + divinc) & 0xFF;
-		divLastUpdate_ += divinc << 8;
-	}
-
-	unsigned long const dec = cc < 0x10000
-	                        ? 0
-	                        : (cc & ~0x7FFFul) - 0x8000;
-	decCycles(divLastUpdate_, dec);
-	decCycles(lastOamDmaUpdate_, dec);
-	decEventCycles(intevent_serial, dec);
-	decEventCycles(intevent_oam, dec);
-	decEventCycles(intevent_blit, dec);
-	decEventCycles(intevent_end, dec);
-	decEventCycles(intevent_unhalt, dec);
-
-	unsigned long const oldCC = cc;
-	cc -= dec;
-	intreq_.resetCc(oldCC, cc);
-	tima_.resetCc(oldCC, cc, TimaInterruptRequester(intreq_));
-	lcd_.resetCc(oldCC, cc);
-	psg_.resetCounter(cc, oldCC, isDoubleSpeed());
-	return cc;
-}
-
 void Memory::updateInput() {
 	unsigned state = 0xF;
 
@@ -389,24 +357,87 @@ void Memory::updateInput() {
 	ioamhram_[0x100] = (ioamhram_[0x100] & -0x10u) | state;
 }
 
-void Memory::updateOamDma(unsigned long const cc) {
-	unsigned char const *const oamDmaSrc = oamDmaSrcPtr();
-	unsigned cycles = (cc - lastOamDmaUpdate_) >> 2;
+// Advances OAM DMA by one byte per 4 cycles up to cc, copying the bytes
+// passed over as one block. Callers bring it up to date before any access
+// that can observe OAM or the DMA position.
+void Memory::updateOamDma(cycle_t const cc) {
+	unsigned steps = (cc - lastOamDmaUpdate_) >> 2;
+	unsigned begin = oamDmaPos_ + 1;
+
+	if (oamDmaPos_ >= 0xA0) {
+		// startup delay. byte 0 is copied on the step that wraps the position to 0.
+		unsigned const delay = 0x100 - oamDmaPos_;
+		if (steps < delay) {
+			oamDmaPos_ += steps;
+			lastOamDmaUpdate_ += steps * 4;
+			return;
+		}
 
-	while (cycles--) {
-		oamDmaPos_ = (oamDmaPos_ + 1) & 0xFF;
-		lastOamDmaUpdate_ += 4;
+		steps -= delay;
+		oamDmaPos_ = 0;
+		lastOamDmaUpdate_ += delay * 4;
+		begin = 0;
+		startOamDma(lastOamDmaUpdate_ - 1);
+	}
 
-		if (oamDmaPos_ < 0xA0) {
-			if (oamDmaPos_ == 0)
-				startOamDma(lastOamDmaUpdate_ - 1);
+	unsigned const n = std::min(steps, 0xA0u - oamDmaPos_);
+	unsigned const end = std::min(oamDmaPos_ + n + 1, 0xA0u);
 
-			ioamhram_[oamDmaPos_] = oamDmaSrc ? oamDmaSrc[oamDmaPos_] : cart_.rtcRead();
-		} else if (oamDmaPos_ == 0xA0) {
-			endOamDma(lastOamDmaUpdate_ - 1);
-			lastOamDmaUpdate_ = disabled_time;
-			break;
+	if (begin < end) {
+		if (unsigned char const *const oamDmaSrc = oamDmaSrcPtr())
+			std::memcpy(ioamhram_ + begin, oamDmaSrc + begin, end - begin);
+		else
+			std::memset(ioamhram_ + begin, cart_.rtcRead(), end - begin);
+	}
+
+	oamDmaPos_ += n;
+	lastOamDmaUpdate_ += n * 4;
+
+	if (oamDmaPos_ == 0xA0) {
+		endOamDma(lastOamDmaUpdate_ - 1);
+		lastOamDmaUpdate_ = disabled_time;
+	}
+}
+
+// True if every source byte of a GDMA/HDMA block is read straight from a
+// mapped page, so copyDmaBlock gives the same result and read hook calls as
+// the per-byte loop.
+bool Memory::isPlainDmaSource(unsigned src, unsigned length) const {
+	while (length) {
+		src &= 0xFFFF;
+
+		unsigned const n = std::min(length, 0x1000 - (src & 0xFFF));
+		if ((src & 0xE000) == 0x8000 || src + n > 0xFE00 || !cart_.rmem(src >> 12))
+			return false;
+
+		src += n;
+		length -= n;
+	}
+
+	return true;
+}
+
+void Memory::copyDmaBlock(unsigned src, unsigned dest, unsigned length) {
+	while (length) {
+		src &= 0xFFFF;
+		dest = 0x8000 | (dest & 0x1FFF);
+
+		unsigned const n = std::min(length, std::min(0x1000 - (src & 0xFFF), 0xA000 - dest));
+		unsigned char const *const page = cart_.rmem(src >> 12);
+
+		// the same read hook calls as read, before the copy, so the hook sees
+		// each source byte and can still change it
+		for (unsigned i = src; i < src + n; ++i) {
+			EM_ASM_INT({
+				window.trivialReadMemory($0, $1, $2);
+			}, i, &page[i], page[i]);
 		}
+
+		std::memcpy(cart_.vrambankptr() + dest, page + src, n);
+		lcd_.tileDataChange(cart_.vrambankptr() + dest - cart_.vramdata(), n);
+		src += n;
+		dest += n;
+		length -= n;
 	}
 }
 
@@ -442,17 +473,17 @@ unsigned char const * Memory::oamDmaSrcPtr() const {
 	return ioamhram_[0x146] == 0xFF && !isCgb() ? oamDmaSrcZero() : cart_.rdisabledRam();
 }
 
-void Memory::startOamDma(unsigned long cc) {
+void Memory::startOamDma(cycle_t cc) {
 	lcd_.oamChange(cart_.rdisabledRam(), cc);
 }
 
-void Memory::endOamDma(unsigned long cc) {
+void Memory::endOamDma(cycle_t cc) {
 	oamDmaPos_ = 0xFE;
 	cart_.setOamDmaSrc(oam_dma_src_off);
 	lcd_.oamChange(ioamhram_, cc);
 }
 
-unsigned Memory::nontrivial_ff_read(unsigned const p, unsigned long const cc) {
+unsigned Memory::nontrivial_ff_read(unsigned const p, cycle_t const cc) {
 	if (lastOamDmaUpdate_ != disabled_time)
 		updateOamDma(cc);
 
@@ -466,7 +497,7 @@ unsigned Memory::nontrivial_ff_read(unsigned const p, unsigned long const cc) {
 		break;
 	case 0x04:
 		{
-			unsigned long divcycles = (cc - divLastUpdate_) >> 8;
+			cycle_t divcycles = (cc - divLastUpdate_) >> 8;
 			ioamhram_[0x104] = (ioamhram_[0x104] + divcycles) & 0xFF;
 			divLastUpdate_ += divcycles << 8;
 		}
@@ -546,7 +577,7 @@ static bool isInOamDmaConflictArea(OamDmaSrc const oamDmaSrc, unsigned const p,
 	    && p - a[oamDmaSrc].exceptAreaLower >= a[oamDmaSrc].exceptAreaWidth;
 }
 
-unsigned Memory::nontrivial_read(unsigned const p, unsigned long const cc) {
+unsigned Memory::nontrivial_read(unsigned const p, cycle_t const cc) {
 	if (p < 0xFF80) {
 		if (lastOamDmaUpdate_ != disabled_time) {
 			updateOamDma(cc);
@@ -586,7 +617,7 @@ unsigned Memory::nontrivial_read(unsigned const p, unsigned long const cc) {
 	return ioamhram_[p - 0xFE00];
 }
 
-void Memory::nontrivial_ff_write(unsigned const p, unsigned data, unsigned long const cc) {
+void Memory::nontrivial_ff_write(unsigned const p, unsigned data, cycle_t const cc) {
 	if (lastOamDmaUpdate_ != disabled_time)
 		updateOamDma(cc);
 
@@ -607,8 +638,8 @@ void Memory::nontrivial_ff_write(unsigned const p, unsigned data, unsigned long
 
 		if ((data & 0x81) == 0x81) {
 			intreq_.setEventTime<intevent_serial>((data & isCgb() * 2)
-				? (cc & ~0x07ul) + 0x010 * 8
-				: (cc & ~0xFFul) + 0x200 * 8);
+				? (cc & ~cycle_t(0x07)) + 0x010 * 8
+				: (cc & ~cycle_t(0xFF)) + 0x200 * 8);
 		} else
 			intreq_.setEventTime<intevent_serial>(disabled_time);
 
@@ -1012,7 +1043,7 @@ void Memory::nontrivial_ff_write(unsigned const p, unsigned data, unsigned long
 	ioamhram_[p + 0x100] = data;
 }
 
-void Memory::nontrivial_write(unsigned const p, unsigned const data, unsigned long const cc) {
+void Memory::nontrivial_write(unsigned const p, unsigned const data, cycle_t const cc) {
 	if (lastOamDmaUpdate_ != disabled_time) {
 		updateOamDma(cc);
 
@@ -1025,16 +1056,20 @@ void Memory::nontrivial_write(unsigned const p, unsigned const data, unsigned lo
 	if (p < 0xFE00) {
 		if (p < 0xA000) {
 			if (p < 0x8000) {
+				cart_.updateRtc(cc, isDoubleSpeed());
 				cart_.mbcWrite(p, data);
 			} else if (lcd_.vramAccessible(cc)) {
 				lcd_.vramChange(cc);
 				cart_.vrambankptr()[p] = data;
+				lcd_.tileDataChange(cart_.vrambankptr() + p - cart_.vramdata());
 			}
 		} else if (p < 0xC000) {
-			if (cart_.wsrambankptr())
+			if (cart_.wsrambankptr()) {
 				cart_.wsrambankptr()[p] = data;
-			else
+			} else {
+				cart_.updateRtc(cc, isDoubleSpeed());
 				cart_.rtcWrite(data);
+			}
 		} else
 			cart_.wramdata(p >> 12 & 1)[p & 0xFFF] = data;
 	} else if (p - 0xFF80u >= 0x7Fu) {
@@ -1050,11 +1085,56 @@ void Memory::nontrivial_write(unsigned const p, unsigned const data, unsigned lo
 		ioamhram_[p - 0xFE00] = data;
 }
 
-std::size_t Memory::fillSoundBuffer(unsigned long cc) {
+std::size_t Memory::fillSoundBuffer(cycle_t cc) {
 	psg_.generateSamples(cc, isDoubleSpeed());
 	return psg_.fillBuffer();
 }
 
+unsigned char * Memory::memoryArea(unsigned const area, unsigned *const length) {
+	MemPtrs const &m = cart_.memPtrs();
+	unsigned char *begin = 0;
+	unsigned char *end = 0;
+
+	if (!loaded()) {
+		*length = 0;
+		return 0;
+	}
+
+	switch (area) {
+	case GB::MEM_ROM:
+		begin = m.romdata();
+		end = m.romdataend();
+		break;
+	case GB::MEM_VRAM:
+		begin = m.vramdata();
+		end = begin + (gambatte::isCgb(m) ? 0x4000 : 0x2000);
+		break;
+	case GB::MEM_CARTRAM:
+		begin = m.rambankdata();
+		end = m.rambankdataend();
+		break;
+	case GB::MEM_WRAM:
+		begin = m.wramdata(0);
+		end = m.wramdataend();
+		break;
+	case GB::MEM_OAM:
+		begin = ioamhram_;
+		end = ioamhram_ + 0xA0;
+		break;
+	case GB::MEM_HRAM:
+		begin = ioamhram_ + 0x180;
+		end = ioamhram_ + 0x1FF;
+		break;
+	case GB::MEM_IE:
+		begin = ioamhram_ + 0x1FF;
+		end = ioamhram_ + 0x200;
+		break;
+	}
+
+	*length = end - begin;
+	return begin;
+}
+
 int Memory::loadROM(const void *romdata, unsigned romsize, const bool forceDmg, const bool multicartCompat)
 {
    if (const int fail = cart_.loadROM(romdata, romsize, forceDmg, multicartCompat))
@@ -34,7 +34,7 @@ public:
 	explicit Memory(Interrupter const &interrupter);
 	bool loaded() const { return cart_.loaded(); }
 	void setStatePtrs(SaveState &state);
-	unsigned long saveState(SaveState &state, unsigned long cc);
+	void saveState(SaveState &state, cycle_t cc);
 	void loadState(SaveState const &state);
 #ifdef __LIBRETRO__
    void *savedata_ptr() { return cart_.savedata_ptr(); }
@@ -42,22 +42,24 @@ public:
    void *rtcdata_ptr() { return cart_.rtcdata_ptr(); }
    unsigned rtcdata_size() { return cart_.rtcdata_size(); }
    void display_setColorCorrection(bool enable) { lcd_.setColorCorrection(enable); }
-   video_pixel_t display_gbcToRgb32(const unsigned bgr15) { return lcd_.gbcToRgb32(bgr15); }
+   void display_setColorCurve(ColorCurve curve) { lcd_.setColorCurve(curve); }
+   uint_least32_t display_gbcToRgb32(const unsigned bgr15) { return lcd_.gbcToRgb32(bgr15); }
    void clearCheats() { cart_.clearCheats(); }
 #else
    void loadSavedata() { cart_.loadSavedata(); }
    void saveSavedata() { cart_.saveSavedata(); }
 #endif
 	std::string const saveBasePath() const { return cart_.saveBasePath(); }
+	unsigned char * memoryArea(unsigned area, unsigned *length);
 
-	unsigned long stop(unsigned long cycleCounter);
+	cycle_t stop(cycle_t cycleCounter);
 	bool isCgb() const { return lcd_.isCgb(); }
 	bool ime() const { return intreq_.ime(); }
 	bool halted() const { return intreq_.halted(); }
-	unsigned long nextEventTime() const { return intreq_.minEventTime(); }
+	cycle_t nextEventTime() const { return intreq_.minEventTime(); }
 	bool isActive() const { return intreq_.eventTime(intevent_end) != disabled_time; }
 
-	long cyclesSinceBlit(unsigned long cc) const {
+	long cyclesSinceBlit(cycle_t cc) const {
 		if (cc < intreq_.eventTime(intevent_blit))
 			return -1;
 
@@ -65,10 +67,10 @@ public:
 	}
 
 	void halt() { intreq_.halt(); }
-	void ei(unsigned long cycleCounter) { if (!ime()) { intreq_.ei(cycleCounter); } }
+	void ei(cycle_t cycleCounter) { if (!ime()) { intreq_.ei(cycleCounter); } }
 	void di() { intreq_.di(); }
 
-	unsigned ff_read(unsigned p, unsigned long cc) {
+	unsigned ff_read(unsigned p, cycle_t cc) {
 		return p < 0x80 ? nontrivial_ff_read(p, cc) : ioamhram_[p + 0x100];
 	}
 
@@ -81,7 +83,7 @@ public:
 	//   * if the number is greater than 12 bits can hold then it will be a nontrivial_read
 	// * cc is the CycleCounter and is only needed for non trivial reads as they take more cpu cycles
 	// 
-	unsigned read(unsigned p, unsigned long cc) {
+	unsigned read(unsigned p, cycle_t cc) {
 		if (cart_.rmem(p >> 12))
 		EM_ASM_INT({
            window.trivialReadMemory($0, $1, $2);
@@ -92,7 +94,7 @@ public:
 	// 
 	// # write memory
 	// 
-	void write(unsigned p, unsigned data, unsigned long cc) {
+	void write(unsigned p, unsigned data, cycle_t cc) {
 		if (cart_.wmem(p >> 12)) {
 			EM_ASM_INT({
 		           window.trivialWriteMemory($0, $1, $2, $3);
@@ -102,30 +104,44 @@ public:
 			nontrivial_write(p, data, cc);
 	}
 
-	void ff_write(unsigned p, unsigned data, unsigned long cc) {
+	// page p >> 12 of the write map, or 0 if writes there need nontrivial_write
+	unsigned char * wmem(unsigned area) const { return cart_.wmem(area); }
+
+	void ff_write(unsigned p, unsigned data, cycle_t cc) {
 		if (p - 0x80u < 0x7Fu) {
 			ioamhram_[p + 0x100] = data;
 		} else
 			nontrivial_ff_write(p, data, cc);
 	}
 
-	unsigned long event(unsigned long cycleCounter);
-	unsigned long resetCounters(unsigned long cycleCounter);
+	cycle_t event(cycle_t cycleCounter);
 	void setSaveDir(std::string const &dir) { cart_.setSaveDir(dir); }
 	void setInputGetter(InputGetter *getInput) { getInput_ = getInput; }
-	void setEndtime(unsigned long cc, unsigned long inc);
+	void setEndtime(cycle_t cc, cycle_t inc);
 	void setSoundBuffer(uint_least32_t *buf) { psg_.setBuffer(buf); }
-	std::size_t fillSoundBuffer(unsigned long cc);
+	std::size_t fillSoundBuffer(cycle_t cc);
 
-	void setVideoBuffer(video_pixel_t *videoBuf, std::ptrdiff_t pitch) {
+	void setVideoBuffer(void *videoBuf, std::ptrdiff_t pitch) {
 		lcd_.setVideoBuffer(videoBuf, pitch);
 	}
 
+	void setPixelFormat(PixelFormat format) { lcd_.setPixelFormat(format); }
+	uint_least32_t const * framePalette() const { return lcd_.framePalette(); }
+	std::vector<PaletteChange> const & paletteChanges() const { return lcd_.paletteChanges(); }
+	unsigned char const * dirtyLines() const { return lcd_.dirtyLines(); }
+	uint64_t const * lineHashes() const { return lcd_.lineHashes(); }
+	uint64_t frameHash() const { return lcd_.frameHash(); }
+	void drawTileSheet(uint_least32_t *buf, std::ptrdiff_t pitch, unsigned palette) { lcd_.drawTileSheet(buf, pitch, palette); }
+	void drawTileMap(uint_least32_t *buf, std::ptrdiff_t pitch, unsigned map) { lcd_.drawTileMap(buf, pitch, map); }
+	void drawSprites(uint_least32_t *buf, std::ptrdiff_t pitch) { lcd_.drawSprites(buf, pitch, ioamhram_); }
+
 	void setDmgPaletteColor(int palNum, int colorNum, unsigned long rgb32) {
 		lcd_.setDmgPaletteColor(palNum, colorNum, rgb32);
 	}
 
 	void setGameGenie(std::string const &codes) { cart_.setGameGenie(codes); }
+	void enableGameGenie(std::string const &codes, bool enable) { cart_.enableGameGenie(codes, enable); }
+	void setRtcEmulatedTime(bool enable, uint64_t epoch) { cart_.setRtcEmulatedTime(enable, epoch); }
 	void setGameShark(std::string const &codes) { interrupter_.setGameShark(codes); }
 	void updateInput();
 
@@ -135,8 +151,8 @@ private:
 	Cartridge cart_;
 	unsigned char ioamhram_[0x200];
 	InputGetter *getInput_;
-	unsigned long divLastUpdate_;
-	unsigned long lastOamDmaUpdate_;
+	cycle_t divLastUpdate_;
+	cycle_t lastOamDmaUpdate_;
 	InterruptRequester intreq_;
 	Tima tima_;
 	LCD lcd_;
@@ -148,19 +164,20 @@ private:
 	unsigned char serialCnt_;
 	bool blanklcd_;
 
-	void decEventCycles(IntEventId eventId, unsigned long dec);
 	void oamDmaInitSetup();
-	void updateOamDma(unsigned long cycleCounter);
-	void startOamDma(unsigned long cycleCounter);
-	void endOamDma(unsigned long cycleCounter);
+	void updateOamDma(cycle_t cycleCounter);
+	void startOamDma(cycle_t cycleCounter);
+	void endOamDma(cycle_t cycleCounter);
 	unsigned char const * oamDmaSrcPtr() const;
-	unsigned nontrivial_ff_read(unsigned p, unsigned long cycleCounter);
-	unsigned nontrivial_read(unsigned p, unsigned long cycleCounter);
-	void nontrivial_ff_write(unsigned p, unsigned data, unsigned long cycleCounter);
-	void nontrivial_write(unsigned p, unsigned data, unsigned long cycleCounter);
-	void updateSerial(unsigned long cc);
-	void updateTimaIrq(unsigned long cc);
-	void updateIrqs(unsigned long cc);
+	bool isPlainDmaSource(unsigned src, unsigned length) const;
+	void copyDmaBlock(unsigned src, unsigned dest, unsigned length);
+	unsigned nontrivial_ff_read(unsigned p, cycle_t cycleCounter);
+	unsigned nontrivial_read(unsigned p, cycle_t cycleCounter);
+	void nontrivial_ff_write(unsigned p, unsigned data, cycle_t cycleCounter);
+	void nontrivial_write(unsigned p, unsigned data, cycle_t cycleCounter);
+	void updateSerial(cycle_t cc);
+	void updateTimaIrq(cycle_t cc);
+	void updateIrqs(cycle_t cc);
 	bool isDoubleSpeed() const { return lcd_.isDoubleSpeed(); }
 };
 
@@ -21,6 +21,11 @@
 #include "savestate.h"
 #include "statesaver.h"
 #include "initstate.h"
+#include "rewindbuffer.h"
+#include "hash64.h"
+#include "ramsearch.h"
+#include <algorithm>
+#include <cstring>
 #include <sstream>
 
 namespace gambatte {
@@ -28,11 +33,77 @@ struct GB::Priv {
 	CPU cpu;
 	int stateNo;
 	bool gbaCgbMode;
+	bool rtcEmulatedTime;
+	uint64_t rtcEpoch;
+	// State sizes only depend on the cartridge geometry, so they are
+	// computed once per ROM load rather than on every query.
+	size_t stateSize;
+	size_t stateSizeFast;
+	Array<unsigned char> fastState;
+	RewindBuffer rewind;
+	std::size_t rewindBudget;
+	unsigned rewindInterval;
+	unsigned rewindFrames;
+	// samples since the end of the last frame, and the hash of that frame's samples
+	Hash64 frameAudio;
+	uint64_t audioHash;
+	// over the areas getMemoryArea gave when it started, so reset on load
+	RamSearch search;
 	
-	Priv() : stateNo(1), gbaCgbMode(false) {}
+	Priv()
+	: stateNo(1), gbaCgbMode(false), rtcEmulatedTime(false), rtcEpoch(0),
+	  stateSize(0), stateSizeFast(0),
+	  rewindBudget(0), rewindInterval(1), rewindFrames(0), audioHash(0)
+	{
+	}
 
 	void on_load_succeeded(unsigned flags);
+	void setInitRtcTime(SaveState &state) const;
+	void loadState(SaveState const &state);
+	void saveStateFast(void *data, bool notify = true);
+	void resetRewind();
+	void captureRewindState();
+	void hashSamples(const uint_least32_t *soundBuf, unsigned samples, bool frameDone, long frameEnd);
 };
+
+// notify is false for states the frontend did not ask for, which skip the
+// cpuSaveState hook
+void GB::Priv::saveStateFast(void *data, bool const notify) {
+	SaveState state;
+	// zero the struct padding too, so that identical states give identical images
+	std::memset(static_cast<void *>(&state), 0, sizeof state);
+	cpu.setStatePtrs(state);
+
+	if (notify)
+		cpu.saveState(state);
+	else
+		cpu.writeState(state);
+
+	StateSaver::saveStateFast(state, data);
+}
+
+void GB::Priv::resetRewind() {
+	rewind.reset(rewindBudget, stateSizeFast);
+	rewindFrames = 0;
+}
+
+void GB::Priv::captureRewindState() {
+	saveStateFast(fastState, false);
+	rewind.push(fastState);
+}
+
+void GB::Priv::hashSamples(const uint_least32_t *soundBuf, unsigned samples, bool frameDone, long frameEnd) {
+	if (frameDone) {
+		const unsigned end = std::min(std::max(frameEnd, 0L), static_cast<long>(samples));
+		frameAudio.update(soundBuf, end * sizeof *soundBuf);
+		audioHash = frameAudio.digest();
+		frameAudio.reset();
+		soundBuf += end;
+		samples -= end;
+	}
+	
+	frameAudio.update(soundBuf, samples * sizeof *soundBuf);
+}
 	
 GB::GB() : p_(new Priv) {}
 
@@ -40,7 +111,7 @@ GB::~GB() {
 	delete p_;
 }
 
-long GB::runFor(gambatte::video_pixel_t *const videoBuf, const int pitch,
+long GB::runFor(void *const videoBuf, const int pitch,
 			gambatte::uint_least32_t *const soundBuf, unsigned &samples) {
 	
 	p_->cpu.setVideoBuffer(videoBuf, pitch);
@@ -48,14 +119,27 @@ long GB::runFor(gambatte::video_pixel_t *const videoBuf, const int pitch,
 	const long cyclesSinceBlit = p_->cpu.runFor(samples * 2);
 	samples = p_->cpu.fillSoundBuffer();
 	
-	return cyclesSinceBlit < 0 ? cyclesSinceBlit : static_cast<long>(samples) - (cyclesSinceBlit >> 1);
+	const long frameEnd = cyclesSinceBlit < 0 ? cyclesSinceBlit : static_cast<long>(samples) - (cyclesSinceBlit >> 1);
+	p_->hashSamples(soundBuf, samples, cyclesSinceBlit >= 0, frameEnd);
+	
+	if (cyclesSinceBlit >= 0 && p_->rewind.enabled()
+			&& ++p_->rewindFrames >= p_->rewindInterval) {
+		p_->rewindFrames = 0;
+		p_->captureRewindState();
+	}
+	
+	return frameEnd;
 }
 
 void GB::reset() {
    SaveState state;
    p_->cpu.setStatePtrs(state);
    setInitState(state, p_->cpu.isCgb(), p_->gbaCgbMode);
+   p_->setInitRtcTime(state);
    p_->cpu.loadState(state);
+   p_->frameAudio.reset();
+   p_->rewind.clear();
+   p_->rewindFrames = 0;
 }
 
 void GB::setInputGetter(InputGetter *getInput) {
@@ -67,9 +151,45 @@ void GB::Priv::on_load_succeeded(unsigned flags)
 	SaveState state;
 	cpu.setStatePtrs(state);
 	setInitState(state, cpu.isCgb(), gbaCgbMode = flags & GBA_CGB);
+	setInitRtcTime(state);
 	cpu.loadState(state);
+	frameAudio.reset();
+	audioHash = 0;
+	search.clear();
 
 	stateNo = 1;
+	stateSize = StateSaver::stateSize(state);
+	stateSizeFast = StateSaver::stateSizeFast(state);
+	fastState.reset(stateSizeFast);
+	resetRewind();
+}
+
+// The emulated clock reads epoch at power-on, where the host clock's reading
+// is what setInitState puts in.
+void GB::Priv::setInitRtcTime(SaveState &state) const {
+	state.rtc.emulatedTime = rtcEmulatedTime;
+	state.rtc.epoch = rtcEpoch;
+
+	if (rtcEmulatedTime)
+		state.rtc.baseTime = state.rtc.haltTime = rtcEpoch;
+}
+
+// The clock source stays the one setRtcEmulatedTime chose. A state saved with the
+// other one keeps its clock registers, as switching does, and an emulated clock
+// keeps the epoch and time the state has.
+void GB::Priv::loadState(SaveState const &state) {
+	cpu.loadState(state);
+
+	if (state.rtc.emulatedTime != rtcEmulatedTime)
+		cpu.setRtcEmulatedTime(rtcEmulatedTime, rtcEpoch);
+
+	frameAudio.reset();
+}
+
+void GB::setRtcEmulatedTime(bool enable, uint64_t epoch) {
+	p_->rtcEmulatedTime = enable;
+	p_->rtcEpoch = epoch;
+	p_->cpu.setRtcEmulatedTime(enable, epoch);
 }
 
 void *GB::savedata_ptr() { return p_->cpu.savedata_ptr(); }
@@ -86,6 +206,31 @@ int GB::load(const void *romdata, unsigned romsize, const unsigned flags) {
 	return failed;
 }
 
+bool GB::getMemoryArea(MemoryArea area, unsigned char **data, unsigned *length) {
+	*data = p_->cpu.memoryArea(area, length);
+	return *length != 0;
+}
+
+void GB::searchReset() {
+	MemoryArea const areas[] = { MEM_WRAM, MEM_CARTRAM, MEM_HRAM };
+	p_->search.clear();
+
+	for (std::size_t i = 0; i < sizeof areas / sizeof areas[0]; ++i) {
+		unsigned char *data;
+		unsigned length;
+		if (getMemoryArea(areas[i], &data, &length))
+			p_->search.addRegion(areas[i], data, length);
+	}
+}
+
+unsigned GB::searchFilter(SearchFilter filter, unsigned width, unsigned operand) {
+	return p_->search.filter(static_cast<RamSearch::Filter>(filter), width, operand);
+}
+
+unsigned GB::searchResults(SearchHit *hits, unsigned max) const {
+	return p_->search.hits(hits, max);
+}
+
 bool GB::isCgb() const {
 	return p_->cpu.isCgb();
 }
@@ -100,11 +245,13 @@ void GB::setDmgPaletteColor(unsigned palNum, unsigned colorNum, unsigned rgb32)
 
 void GB::loadState(const void *data) {
    SaveState state;
+   // fields an older state lacks load as zero rather than stack garbage
+   std::memset(static_cast<void *>(&state), 0, sizeof state);
+   state.rtc.ticksUpdated = disabled_time;
    p_->cpu.setStatePtrs(state);
 
-   if (StateSaver::loadState(state, data)) {
-      p_->cpu.loadState(state);
-   }
+   if (StateSaver::loadState(state, data))
+      p_->loadState(state);
 }
 
 void GB::saveState(void *data) {
@@ -115,17 +262,117 @@ void GB::saveState(void *data) {
 }
 
 size_t GB::stateSize() const {
+   return p_->stateSize;
+}
+
+void GB::saveStateFast(void *data) {
+   p_->saveStateFast(data);
+}
+
+size_t GB::stateSizeFast() const {
+   return p_->stateSizeFast;
+}
+
+size_t GB::saveStateDelta(const void *baseline, void *out) {
+   p_->saveStateFast(p_->fastState);
+   return StateSaver::saveStateDelta(baseline, p_->fastState, p_->stateSizeFast, out);
+}
+
+size_t GB::stateDeltaMaxSize() const {
+   return StateSaver::stateDeltaMaxSize(p_->stateSizeFast);
+}
+
+bool GB::applyStateDelta(const void *baseline, const void *delta) {
+   if (!StateSaver::isFastState(baseline))
+      return false;
+
+   std::memcpy(p_->fastState, baseline, p_->stateSizeFast);
+
+   if (!StateSaver::applyStateDelta(p_->fastState, p_->stateSizeFast, delta))
+      return false;
+
    SaveState state;
    p_->cpu.setStatePtrs(state);
-   p_->cpu.saveState(state);
-   return StateSaver::stateSize(state);
+
+   if (!StateSaver::loadStateFast(state, p_->fastState))
+      return false;
+
+   p_->loadState(state);
+   return true;
+}
+
+void GB::setRewind(std::size_t budget, unsigned interval) {
+   p_->rewindBudget = budget;
+   p_->rewindInterval = interval ? interval : 1;
+   p_->resetRewind();
+}
+
+bool GB::rewind() {
+   unsigned char const *const data = p_->rewind.pop();
+
+   if (!data)
+      return false;
+
+   loadState(data);
+   p_->rewindFrames = 0;
+   return true;
+}
+
+unsigned GB::rewindSteps() const {
+   return p_->rewind.steps();
+}
+
+void GB::setPixelFormat(PixelFormat format) {
+   p_->cpu.mem_.setPixelFormat(format);
+}
+
+const uint_least32_t * GB::framePalette() const {
+   return p_->cpu.mem_.framePalette();
+}
+
+const PaletteChange * GB::paletteChanges(std::size_t &count) const {
+   const std::vector<PaletteChange> &changes = p_->cpu.mem_.paletteChanges();
+   count = changes.size();
+   return count ? &changes[0] : 0;
+}
+
+const unsigned char * GB::dirtyLines() const {
+   return p_->cpu.mem_.dirtyLines();
+}
+
+const uint64_t * GB::lineHashes() const {
+   return p_->cpu.mem_.lineHashes();
+}
+
+uint64_t GB::frameHash() const {
+   return p_->cpu.mem_.frameHash();
+}
+
+uint64_t GB::audioHash() const {
+   return p_->audioHash;
+}
+
+void GB::drawTileSheet(uint_least32_t *buf, std::ptrdiff_t pitch, unsigned palette) {
+   p_->cpu.mem_.drawTileSheet(buf, pitch, palette);
+}
+
+void GB::drawTileMap(uint_least32_t *buf, std::ptrdiff_t pitch, unsigned map) {
+   p_->cpu.mem_.drawTileMap(buf, pitch, map);
+}
+
+void GB::drawSprites(uint_least32_t *buf, std::ptrdiff_t pitch) {
+   p_->cpu.mem_.drawSprites(buf, pitch);
 }
 
 void GB::setColorCorrection(bool enable) {
    p_->cpu.mem_.display_setColorCorrection(enable);
 }
 
-video_pixel_t GB::gbcToRgb32(const unsigned bgr15) {
+void GB::setColorCurve(ColorCurve curve) {
+   p_->cpu.mem_.display_setColorCurve(curve);
+}
+
+uint_least32_t GB::gbcToRgb32(const unsigned bgr15) {
    return p_->cpu.mem_.display_gbcToRgb32(bgr15);
 }
 
@@ -134,6 +381,10 @@ void GB::setGameGenie(const std::string &codes) {
  p_->cpu.setGameGenie(codes);
 }
 
+void GB::enableGameGenie(const std::string &codes, bool enable) {
+ p_->cpu.enableGameGenie(codes, enable);
+}
+
 void GB::setGameShark(const std::string &codes) {
  p_->cpu.setGameShark(codes);
 }
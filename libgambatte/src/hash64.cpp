@@ -0,0 +1,161 @@
+//
+//   Copyright (C) 2026 by the gambatte contributors
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License version 2 for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   version 2 along with this program; if not, write to the
+//   Free Software Foundation, Inc.,
+//   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+//
+
+#include "hash64.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+enum { stripe_size = 32 };
+
+static uint64_t const prime1 = 11400714785074694791ULL;
+static uint64_t const prime2 = 14029467366897019727ULL;
+static uint64_t const prime3 =  1609587929392839161ULL;
+static uint64_t const prime4 =  9650029242287828579ULL;
+static uint64_t const prime5 =  2870177450012600261ULL;
+
+static inline uint64_t rotl(uint64_t x, int r) { return x << r | x >> (64 - r); }
+
+static inline uint64_t read64(unsigned char const *p) {
+	uint64_t v;
+	std::memcpy(&v, p, sizeof v);
+	return v;
+}
+
+static inline uint32_t read32(unsigned char const *p) {
+	uint32_t v;
+	std::memcpy(&v, p, sizeof v);
+	return v;
+}
+
+static inline uint64_t round(uint64_t acc, uint64_t input) {
+	return rotl(acc + input * prime2, 31) * prime1;
+}
+
+static inline uint64_t mergeRound(uint64_t acc, uint64_t val) {
+	return (acc ^ round(0, val)) * prime1 + prime4;
+}
+
+static inline uint64_t finish(uint64_t h, unsigned char const *p, unsigned char const *const end) {
+	for (; end - p >= 8; p += 8)
+		h = rotl(h ^ round(0, read64(p)), 27) * prime1 + prime4;
+
+	if (end - p >= 4) {
+		h = rotl(h ^ read32(p) * prime1, 23) * prime2 + prime3;
+		p += 4;
+	}
+
+	for (; p != end; ++p)
+		h = rotl(h ^ *p * prime5, 11) * prime1;
+
+	h ^= h >> 33;
+	h *= prime2;
+	h ^= h >> 29;
+	h *= prime3;
+	h ^= h >> 32;
+
+	return h;
+}
+
+static inline uint64_t mergeLanes(uint64_t const v[4]) {
+	uint64_t h = rotl(v[0], 1) + rotl(v[1], 7) + rotl(v[2], 12) + rotl(v[3], 18);
+	h = mergeRound(h, v[0]);
+	h = mergeRound(h, v[1]);
+	h = mergeRound(h, v[2]);
+	h = mergeRound(h, v[3]);
+	return h;
+}
+
+static inline void initLanes(uint64_t v[4], uint64_t const seed) {
+	v[0] = seed + prime1 + prime2;
+	v[1] = seed + prime2;
+	v[2] = seed;
+	v[3] = seed - prime1;
+}
+
+static inline void consumeStripe(uint64_t v[4], unsigned char const *p) {
+	v[0] = round(v[0], read64(p));
+	v[1] = round(v[1], read64(p + 8));
+	v[2] = round(v[2], read64(p + 16));
+	v[3] = round(v[3], read64(p + 24));
+}
+
+}
+
+namespace gambatte {
+
+uint64_t hash64(void const *const data, std::size_t const size, uint64_t const seed) {
+	unsigned char const *p = static_cast<unsigned char const *>(data);
+	unsigned char const *const end = p + size;
+	uint64_t h;
+
+	if (size >= stripe_size) {
+		uint64_t v[4];
+		initLanes(v, seed);
+
+		do {
+			consumeStripe(v, p);
+			p += stripe_size;
+		} while (end - p >= stripe_size);
+
+		h = mergeLanes(v);
+	} else
+		h = seed + prime5;
+
+	return finish(h + size, p, end);
+}
+
+void Hash64::reset(uint64_t const seed) {
+	initLanes(v_, seed);
+	seed_ = seed;
+	size_ = 0;
+	pending_ = 0;
+}
+
+void Hash64::update(void const *const data, std::size_t const size) {
+	unsigned char const *p = static_cast<unsigned char const *>(data);
+	unsigned char const *const end = p + size;
+	size_ += size;
+
+	if (pending_) {
+		std::size_t const n = std::min<std::size_t>(stripe_size - pending_, size);
+		std::memcpy(stripe_ + pending_, p, n);
+		pending_ += n;
+		p += n;
+
+		if (pending_ < stripe_size)
+			return;
+
+		consumeStripe(v_, stripe_);
+		pending_ = 0;
+	}
+
+	for (; end - p >= stripe_size; p += stripe_size)
+		consumeStripe(v_, p);
+
+	std::memcpy(stripe_, p, end - p);
+	pending_ = end - p;
+}
+
+uint64_t Hash64::digest() const {
+	uint64_t const h = size_ >= stripe_size ? mergeLanes(v_) : seed_ + prime5;
+	return finish(h + size_, stripe_, stripe_ + pending_);
+}
+
+}
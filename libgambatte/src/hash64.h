@@ -0,0 +1,49 @@
+//
+//   Copyright (C) 2026 by the gambatte contributors
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License version 2 for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   version 2 along with this program; if not, write to the
+//   Free Software Foundation, Inc.,
+//   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+//
+
+#ifndef HASH64_H
+#define HASH64_H
+
+#include <cstddef>
+#include <stdint.h>
+
+namespace gambatte {
+
+// XXH64 of size bytes at data, reading words in host byte order.
+uint64_t hash64(void const *data, std::size_t size, uint64_t seed = 0);
+
+// Streaming XXH64. Feeding the same bytes in any number of update calls gives
+// the same digest as hash64 over all of them at once.
+class Hash64 {
+public:
+	explicit Hash64(uint64_t seed = 0) { reset(seed); }
+	void reset(uint64_t seed = 0);
+	void update(void const *data, std::size_t size);
+	uint64_t digest() const;
+
+private:
+	uint64_t v_[4];
+	uint64_t seed_;
+	uint64_t size_;
+	unsigned char stripe_[32];
+	std::size_t pending_;
+};
+
+}
+
+#endif
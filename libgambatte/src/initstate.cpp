@@ -19,7 +19,6 @@
 #include "initstate.h"
 #include "counterdef.h"
 #include "savestate.h"
-#include "sound/sound_unit.h"
 #include <algorithm>
 #include <cstring>
 #include <ctime>
@@ -1262,43 +1261,43 @@ void gambatte::setInitState(SaveState &state, bool const cgb, bool const gbaCgbM
 	// spu.cycleCounter >> 12 & 7 represents the frame sequencer position.
 	state.spu.cycleCounter = (cgb ? 0x1E00 : 0x2400) | (state.cpu.cycleCounter >> 1 & 0x1FF);
 
-	state.spu.ch1.sweep.counter = SoundUnit::counter_disabled;
+	state.spu.ch1.sweep.counter = disabled_time;
 	state.spu.ch1.sweep.shadow = 0;
 	state.spu.ch1.sweep.nr0 = 0;
 	state.spu.ch1.sweep.negging = false;
 	if (cgb) {
-		state.spu.ch1.duty.nextPosUpdate = (state.spu.cycleCounter & ~1ul) + 37 * 2;
+		state.spu.ch1.duty.nextPosUpdate = (state.spu.cycleCounter & ~cycle_t(1)) + 37 * 2;
 		state.spu.ch1.duty.pos = 6;
 		state.spu.ch1.duty.high = true;
 	} else {
-		state.spu.ch1.duty.nextPosUpdate = (state.spu.cycleCounter & ~1ul) + 69 * 2;
+		state.spu.ch1.duty.nextPosUpdate = (state.spu.cycleCounter & ~cycle_t(1)) + 69 * 2;
 		state.spu.ch1.duty.pos = 3;
 		state.spu.ch1.duty.high = false;
 	}
 	state.spu.ch1.duty.nr3 = 0xC1;
-	state.spu.ch1.env.counter = SoundUnit::counter_disabled;
+	state.spu.ch1.env.counter = disabled_time;
 	state.spu.ch1.env.volume = 0;
-	state.spu.ch1.lcounter.counter = SoundUnit::counter_disabled;
+	state.spu.ch1.lcounter.counter = disabled_time;
 	state.spu.ch1.lcounter.lengthCounter = 0x40;
 	state.spu.ch1.nr4 = 0x07;
 	state.spu.ch1.master = true;
 
-	state.spu.ch2.duty.nextPosUpdate = SoundUnit::counter_disabled;
+	state.spu.ch2.duty.nextPosUpdate = disabled_time;
 	state.spu.ch2.duty.nr3 = 0;
 	state.spu.ch2.duty.pos = 0;
 	state.spu.ch2.duty.high = false;
-	state.spu.ch2.env.counter = SoundUnit::counter_disabled;
+	state.spu.ch2.env.counter = disabled_time;
 	state.spu.ch2.env.volume = 0;
-	state.spu.ch2.lcounter.counter = SoundUnit::counter_disabled;
+	state.spu.ch2.lcounter.counter = disabled_time;
 	state.spu.ch2.lcounter.lengthCounter = 0x40;
 	state.spu.ch2.nr4 = 0;
 	state.spu.ch2.master = false;
 
 	std::memcpy(state.spu.ch3.waveRam.ptr, state.mem.ioamhram.get() + 0x130, 0x10);
-	state.spu.ch3.lcounter.counter = SoundUnit::counter_disabled;
+	state.spu.ch3.lcounter.counter = disabled_time;
 	state.spu.ch3.lcounter.lengthCounter = 0x100;
-	state.spu.ch3.waveCounter = SoundUnit::counter_disabled;
-	state.spu.ch3.lastReadTime = SoundUnit::counter_disabled;
+	state.spu.ch3.waveCounter = disabled_time;
+	state.spu.ch3.lastReadTime = disabled_time;
 	state.spu.ch3.nr3 = 0;
 	state.spu.ch3.nr4 = 0;
 	state.spu.ch3.wavePos = 0;
@@ -1307,9 +1306,9 @@ void gambatte::setInitState(SaveState &state, bool const cgb, bool const gbaCgbM
 
 	state.spu.ch4.lfsr.counter = state.spu.cycleCounter + 4;
 	state.spu.ch4.lfsr.reg = 0xFF;
-	state.spu.ch4.env.counter = SoundUnit::counter_disabled;
+	state.spu.ch4.env.counter = disabled_time;
 	state.spu.ch4.env.volume = 0;
-	state.spu.ch4.lcounter.counter = SoundUnit::counter_disabled;
+	state.spu.ch4.lcounter.counter = disabled_time;
 	state.spu.ch4.lcounter.lengthCounter = 0x40;
 	state.spu.ch4.nr4 = 0;
 	state.spu.ch4.master = false;
@@ -1322,4 +1321,8 @@ void gambatte::setInitState(SaveState &state, bool const cgb, bool const gbaCgbM
 	state.rtc.dataM = 0;
 	state.rtc.dataS = 0;
 	state.rtc.lastLatchData = false;
+	state.rtc.emulatedTime = false;
+	state.rtc.epoch = 0;
+	state.rtc.ticks = 0;
+	state.rtc.ticksUpdated = state.cpu.cycleCounter;
 }
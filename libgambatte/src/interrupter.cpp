@@ -18,16 +18,20 @@
 
 #include "interrupter.h"
 #include "gambatte-memory.h"
+#ifdef GAMESHARK_PROFILE
+#include <time.h>
+#endif
 
 namespace gambatte {
 
 Interrupter::Interrupter(unsigned short &sp, unsigned short &pc)
 : sp_(sp)
 , pc_(pc)
+, gsResolved_(false)
 {
 }
 
-unsigned long Interrupter::interrupt(unsigned const address, unsigned long cc, Memory &memory) {
+cycle_t Interrupter::interrupt(unsigned const address, cycle_t cc, Memory &memory) {
 	cc += 8;
 	sp_ = (sp_ - 1) & 0xFFFF;
 	memory.write(sp_, pc_ >> 8, cc);
@@ -50,18 +54,22 @@ static int asHex(char c) {
 void Interrupter::setGameShark(std::string const &codes) {
 	std::string code;
 	gsCodes_.clear();
+	gsResolved_ = false;
 
 	for (std::size_t pos = 0; pos < codes.length(); pos += code.length() + 1) {
 		code = codes.substr(pos, codes.find(';', pos) - pos);
 		if (code.length() >= 8) {
+			unsigned const type = asHex(code[0]) << 4 | asHex(code[1]);
 			GsCode gs;
-			gs.type  =  asHex(code[0]) << 4 | asHex(code[1]);
+			gs.dst = 0;
 			gs.value = (asHex(code[2]) << 4 | asHex(code[3])) & 0xFF;
 			gs.address = (  asHex(code[4]) << 4
 			              | asHex(code[5])
 			              | asHex(code[6]) << 12
 			              | asHex(code[7]) <<  8) & 0xFFFF;
-			gsCodes_.push_back(gs);
+			if (type == 0x01)
+				gsCodes_.push_back(gs);
+
 			EM_ASM_INT({
 		           window.setGameShark($0, $1);
 		         }, gs.address,gs.value);
@@ -69,11 +77,81 @@ void Interrupter::setGameShark(std::string const &codes) {
 	}
 }
 
-void Interrupter::applyVblankCheats(unsigned long const cc, Memory &memory) {
+#ifdef GAMESHARK_PROFILE
+// a pass over the codes takes microseconds, below what std::clock resolves
+static double profileNsecs() {
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+#endif
+
+bool Interrupter::cheatsStale(Memory const &memory) const {
+	if (!gsResolved_)
+		return true;
+
+	for (unsigned area = 0; area < 0x10; ++area) {
+		if (gsWmem_[area] != memory.wmem(area))
+			return true;
+	}
+
+	return false;
+}
+
+void Interrupter::resolveCheats(Memory const &memory) {
+	for (unsigned area = 0; area < 0x10; ++area)
+		gsWmem_[area] = memory.wmem(area);
+
 	for (std::size_t i = 0, size = gsCodes_.size(); i < size; ++i) {
-		if (gsCodes_[i].type == 0x01)
-			memory.write(gsCodes_[i].address, gsCodes_[i].value, cc);
+		unsigned char *const page = gsWmem_[gsCodes_[i].address >> 12];
+		gsCodes_[i].dst = page ? page + gsCodes_[i].address : 0;
 	}
+
+	gsResolved_ = true;
+}
+
+void Interrupter::applyVblankCheats(cycle_t const cc, Memory &memory) {
+#ifdef GAMESHARK_PROFILE
+	double const start = profileNsecs();
+	unsigned stored = 0, resolves = 0;
+#endif
+
+	// bank switches are what usually moves the targets, so resolving
+	// again is only needed when the write map has changed
+	if (cheatsStale(memory)) {
+		resolveCheats(memory);
+#ifdef GAMESHARK_PROFILE
+		++resolves;
+#endif
+	}
+
+	for (std::size_t i = 0, size = gsCodes_.size(); i < size; ++i) {
+		if (unsigned char *const dst = gsCodes_[i].dst) {
+			// the same hook call as a trivial Memory::write
+			EM_ASM_INT({
+				window.trivialWriteMemory($0, $1, $2, $3);
+			}, gsCodes_[i].address, dst, *dst, gsCodes_[i].value);
+			*dst = gsCodes_[i].value;
+#ifdef GAMESHARK_PROFILE
+			++stored;
+#endif
+		} else {
+			unsigned const address = gsCodes_[i].address;
+			memory.write(address, gsCodes_[i].value, cc);
+
+			// an MBC or I/O register write can remap the codes after it
+			if ((address < 0x8000 || address - 0xFF00u < 0x80) && cheatsStale(memory)) {
+				resolveCheats(memory);
+#ifdef GAMESHARK_PROFILE
+				++resolves;
+#endif
+			}
+		}
+	}
+
+#ifdef GAMESHARK_PROFILE
+	gameSharkProfile(profileNsecs() - start, gsCodes_.size(), stored, resolves);
+#endif
 }
 
 }
@@ -19,15 +19,26 @@
 #ifndef INTERRUPTER_H
 #define INTERRUPTER_H
 
+#include "counterdef.h"
+
 #include <string>
 #include <vector>
 
 namespace gambatte {
 
+#ifdef GAMESHARK_PROFILE
+// Receives, for every VBlank pass over the GameShark codes of a core built with
+// GAMESHARK_PROFILE, the nanoseconds it took on the monotonic clock, the number
+// of codes, how many of them were stored directly and how often the codes were
+// resolved. Defined by the profiling harness.
+void gameSharkProfile(double nsecs, std::size_t codes, unsigned stored, unsigned resolves);
+#endif
+
 struct GsCode {
+	// where the value is stored directly, 0 if it goes through Memory::write
+	unsigned char *dst;
 	unsigned short address;
 	unsigned char value;
-	unsigned char type;
 };
 
 class Memory;
@@ -35,15 +46,21 @@ class Memory;
 class Interrupter {
 public:
 	Interrupter(unsigned short &sp, unsigned short &pc);
-	unsigned long interrupt(unsigned address, unsigned long cycleCounter, Memory &memory);
+	cycle_t interrupt(unsigned address, cycle_t cycleCounter, Memory &memory);
 	void setGameShark(std::string const &codes);
 
 private:
 	unsigned short &sp_;
 	unsigned short &pc_;
+	// type 01 codes, the only ones applied, with dst resolved against the
+	// write map in gsWmem_
 	std::vector<GsCode> gsCodes_;
+	unsigned char *gsWmem_[0x10];
+	bool gsResolved_;
 
-	void applyVblankCheats(unsigned long cc, Memory &mem);
+	void applyVblankCheats(cycle_t cc, Memory &mem);
+	bool cheatsStale(Memory const &mem) const;
+	void resolveCheats(Memory const &mem);
 };
 
 }
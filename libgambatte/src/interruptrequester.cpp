@@ -43,17 +43,10 @@ void InterruptRequester::loadState(SaveState const &state) {
 
 	eventTimes_.setValue<intevent_interrupts>(intFlags_.imeOrHalted() && pendingIrqs()
 		? minIntTime_
-		: static_cast<unsigned long>(disabled_time));
+		: disabled_time);
 }
 
-void InterruptRequester::resetCc(unsigned long oldCc, unsigned long newCc) {
-	minIntTime_ = minIntTime_ < oldCc ? 0 : minIntTime_ - (oldCc - newCc);
-
-	if (eventTimes_.value(intevent_interrupts) != disabled_time)
-		eventTimes_.setValue<intevent_interrupts>(minIntTime_);
-}
-
-void InterruptRequester::ei(unsigned long cc) {
+void InterruptRequester::ei(cycle_t cc) {
 	intFlags_.setIme();
 	minIntTime_ = cc + 1;
 
@@ -100,7 +93,7 @@ void InterruptRequester::setIereg(unsigned iereg) {
 	if (intFlags_.imeOrHalted()) {
 		eventTimes_.setValue<intevent_interrupts>(pendingIrqs()
 			? minIntTime_
-			: static_cast<unsigned long>(disabled_time));
+			: disabled_time);
 	}
 }
 
@@ -110,7 +103,7 @@ void InterruptRequester::setIfreg(unsigned ifreg) {
 	if (intFlags_.imeOrHalted()) {
 		eventTimes_.setValue<intevent_interrupts>(pendingIrqs()
 			? minIntTime_
-			: static_cast<unsigned long>(disabled_time));
+			: disabled_time);
 	}
 }
 
@@ -41,12 +41,11 @@ public:
 	InterruptRequester();
 	void saveState(SaveState &) const;
 	void loadState(SaveState const &);
-	void resetCc(unsigned long oldCc, unsigned long newCc);
 	unsigned ifreg() const { return ifreg_; }
 	unsigned pendingIrqs() const { return ifreg_ & iereg_; }
 	bool ime() const { return intFlags_.ime(); }
 	bool halted() const { return intFlags_.halted(); }
-	void ei(unsigned long cc);
+	void ei(cycle_t cc);
 	void di();
 	void halt();
 	void unhalt();
@@ -56,10 +55,10 @@ public:
 	void setIfreg(unsigned ifreg);
 
 	IntEventId minEventId() const { return static_cast<IntEventId>(eventTimes_.min()); }
-	unsigned long minEventTime() const { return eventTimes_.minValue(); }
-	template<IntEventId id> void setEventTime(unsigned long value) { eventTimes_.setValue<id>(value); }
-	void setEventTime(IntEventId id, unsigned long value) { eventTimes_.setValue(id, value); }
-	unsigned long eventTime(IntEventId id) const { return eventTimes_.value(id); }
+	cycle_t minEventTime() const { return eventTimes_.minValue(); }
+	template<IntEventId id> void setEventTime(cycle_t value) { eventTimes_.setValue<id>(value); }
+	void setEventTime(IntEventId id, cycle_t value) { eventTimes_.setValue(id, value); }
+	cycle_t eventTime(IntEventId id) const { return eventTimes_.value(id); }
 
 private:
 	class IntFlags {
@@ -79,8 +78,8 @@ private:
 		enum { flag_ime = 1, flag_halted = 2 };
 	};
 
-	MinKeeper<intevent_last + 1> eventTimes_;
-	unsigned long minIntTime_;
+	EventMinKeeper<intevent_last + 1>::Type eventTimes_;
+	cycle_t minIntTime_;
 	unsigned ifreg_;
 	unsigned iereg_;
 	IntFlags intFlags_;
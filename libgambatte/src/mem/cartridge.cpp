@@ -18,6 +18,7 @@
  ***************************************************************************/
 #include "cartridge.h"
 #include "../savestate.h"
+#include <algorithm>
 #include <cstring>
 #include <fstream>
 #include <stdio.h>
@@ -544,10 +545,13 @@ namespace gambatte
       rombanks = pow2ceil(romsize / 0x4000);
       printf("rombanks: %u\n", static_cast<unsigned>(romsize / 0x4000));
 
-      ggUndoList_.clear();
+      ggCodes_.clear();
+      ggOriginal_.clear();
+      ggEnabled_.clear();
       mbc.reset();
       memptrs_.reset(rombanks, rambanks, cgb ? 8 : 2);
       rtc_.set(false, 0);
+      hasRtc_ = type == MBC3 && hasRtc(romdata[0x147]);
 
       EM_ASM_INT({
             // $0 = destination
@@ -571,7 +575,7 @@ namespace gambatte
                         mbc.reset(new Mbc1(memptrs_));
                      break;
          case MBC2: mbc.reset(new Mbc2(memptrs_)); break;
-         case MBC3: mbc.reset(new Mbc3(memptrs_, hasRtc(memptrs_.romdata()[0x147]) ? &rtc_ : 0)); break;
+         case MBC3: mbc.reset(new Mbc3(memptrs_, hasRtc_ ? &rtc_ : 0)); break;
          case MBC5: mbc.reset(new Mbc5(memptrs_)); break;
          case HUC1: mbc.reset(new HuC1(memptrs_)); break;
       }
@@ -584,50 +588,115 @@ namespace gambatte
       return c >= 'A' ? c - 'A' + 0xA : c - '0';
    }
 
-   void Cartridge::applyGameGenie(const std::string &code)
+   Cartridge::GgCode * Cartridge::ggCode(const std::string &code)
    {
-      if (6 < code.length())
+      std::map<std::string, GgCode>::iterator it = ggCodes_.find(code);
+      if (it != ggCodes_.end())
+         return &it->second;
+
+      if (code.length() <= 6 || !mbc.get())
+         return 0;
+
+      GgCode gg;
+      gg.val = (asHex(code[0]) << 4 | asHex(code[1])) & 0xFF;
+      gg.addr = (asHex(code[2]) << 8 | asHex(code[4]) << 4 | asHex(code[5]) | (asHex(code[6]) ^ 0xF) << 12) & 0x7FFF;
+      gg.enabled = false;
+      unsigned cmp = 0xFFFF;
+
+      if (10 < code.length())
       {
-         const unsigned val = (asHex(code[0]) << 4 | asHex(code[1])) & 0xFF;
-         const unsigned addr = (asHex(code[2]) << 8 | asHex(code[4]) << 4 | asHex(code[5]) | (asHex(code[6]) ^ 0xF) << 12) & 0x7FFF;
-         unsigned cmp = 0xFFFF;
+         cmp = (asHex(code[8]) << 4 | asHex(code[10])) ^ 0xFF;
+         cmp = ((cmp >> 2 | cmp << 6) ^ 0x45) & 0xFF;
+      }
 
-         if (10 < code.length())
-         {
-            cmp = (asHex(code[8]) << 4 | asHex(code[10])) ^ 0xFF;
-            cmp = ((cmp >> 2 | cmp << 6) ^ 0x45) & 0xFF;
-         }
+      // compare against the unpatched ROM, so the banks a code patches do
+      // not depend on which other codes are enabled
+      for (unsigned bank = 0; bank < rombanks(memptrs_); ++bank)
+      {
+         const unsigned long offset = bank * 0x4000ul + (gg.addr & 0x3FFF);
+         std::map<unsigned long, unsigned char>::const_iterator orig = ggOriginal_.find(offset);
+         const unsigned data = orig != ggOriginal_.end() ? orig->second : memptrs_.romdata()[offset];
 
-         for (unsigned bank = 0; bank < static_cast<std::size_t>(memptrs_.romdataend() - memptrs_.romdata()) / 0x4000; ++bank)
-         {
-            if (mbc->isAddressWithinAreaRombankCanBeMappedTo(addr, bank)
-                  && (cmp > 0xFF || memptrs_.romdata()[bank * 0x4000ul + (addr & 0x3FFF)] == cmp))
-            {
-               ggUndoList_.push_back(AddrData(bank * 0x4000ul + (addr & 0x3FFF), memptrs_.romdata()[bank * 0x4000ul + (addr & 0x3FFF)]));
-               memptrs_.romdata()[bank * 0x4000ul + (addr & 0x3FFF)] = val;
-            }
-         }
+         if (mbc->isAddressWithinAreaRombankCanBeMappedTo(gg.addr, bank) && (cmp > 0xFF || data == cmp))
+            gg.offsets.push_back(offset);
+      }
+
+      return &(ggCodes_[code] = gg);
+   }
+
+   void Cartridge::patchGameGenie(const GgCode &gg)
+   {
+      for (std::size_t i = 0; i < gg.offsets.size(); ++i)
+      {
+         ggOriginal_.insert(std::make_pair(gg.offsets[i], memptrs_.romdata()[gg.offsets[i]]));
+         memptrs_.romdata()[gg.offsets[i]] = gg.val;
+      }
+   }
+
+   void Cartridge::applyGameGenie(GgCode &gg)
+   {
+      patchGameGenie(gg);
+      gg.enabled = true;
+      ggEnabled_.push_back(&gg);
+   }
+
+   void Cartridge::undoGameGenie(GgCode &gg)
+   {
+      gg.enabled = false;
+      ggEnabled_.erase(std::find(ggEnabled_.begin(), ggEnabled_.end(), &gg));
+
+      for (std::size_t i = 0; i < gg.offsets.size(); ++i)
+         memptrs_.romdata()[gg.offsets[i]] = ggOriginal_[gg.offsets[i]];
+
+      // only codes for the same offset within a bank can share bytes with
+      // this one, and those still enabled keep their patches, the last
+      // applied one winning as before
+      for (std::size_t i = 0; i < ggEnabled_.size(); ++i)
+      {
+         if ((ggEnabled_[i]->addr & 0x3FFF) == (gg.addr & 0x3FFF))
+            patchGameGenie(*ggEnabled_[i]);
       }
    }
 
    void Cartridge::setGameGenie(const std::string &codes)
    {
-#if 0
-      if (loaded())
-#endif
+      std::vector<GgCode *> wanted;
+      std::string code;
+      for (std::size_t pos = 0; pos < codes.length()
+            && (code = codes.substr(pos, codes.find(';', pos) - pos), true); pos += code.length() + 1)
       {
-         for (std::vector<AddrData>::reverse_iterator it = ggUndoList_.rbegin(), end = ggUndoList_.rend(); it != end; ++it)
-         {
-            if (memptrs_.romdata() + it->addr < memptrs_.romdataend())
-               memptrs_.romdata()[it->addr] = it->data;
-         }
+         if (GgCode *const gg = ggCode(code))
+            wanted.push_back(gg);
+      }
 
-         ggUndoList_.clear();
+      for (std::map<std::string, GgCode>::iterator it = ggCodes_.begin(); it != ggCodes_.end(); ++it)
+      {
+         if (it->second.enabled && std::find(wanted.begin(), wanted.end(), &it->second) == wanted.end())
+            undoGameGenie(it->second);
+      }
 
-         std::string code;
-         for (std::size_t pos = 0; pos < codes.length()
-               && (code = codes.substr(pos, codes.find(';', pos) - pos), true); pos += code.length() + 1)
-            applyGameGenie(code);
+      for (std::size_t i = 0; i < wanted.size(); ++i)
+      {
+         if (!wanted[i]->enabled)
+            applyGameGenie(*wanted[i]);
+      }
+   }
+
+   void Cartridge::enableGameGenie(const std::string &codes, const bool enable)
+   {
+      std::string code;
+      for (std::size_t pos = 0; pos < codes.length()
+            && (code = codes.substr(pos, codes.find(';', pos) - pos), true); pos += code.length() + 1)
+      {
+         GgCode *const gg = ggCode(code);
+
+         if (gg && gg->enabled != enable)
+         {
+            if (enable)
+               applyGameGenie(*gg);
+            else
+               undoGameGenie(*gg);
+         }
       }
    }
 
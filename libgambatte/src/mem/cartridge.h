@@ -22,6 +22,7 @@
 #include "memptrs.h"
 #include "rtc.h"
 #include "savestate.h"
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -41,6 +42,8 @@ namespace gambatte
    class Cartridge
    {
       public:
+         Cartridge() : hasRtc_(false) {}
+
          void setStatePtrs(SaveState &);
          void saveState(SaveState &) const;
          void loadState(const SaveState &);
@@ -118,6 +121,23 @@ namespace gambatte
             return gambatte::isCgb(memptrs_);
          }
 
+         const MemPtrs & memPtrs() const
+         {
+            return memptrs_;
+         }
+
+         void setRtcEmulatedTime(bool enable, uint64_t epoch)
+         {
+            rtc_.setEmulatedTime(enable, epoch);
+         }
+
+         // Only carts with an RTC read its clock, so the others never update it.
+         void updateRtc(cycle_t cc, bool ds)
+         {
+            if (hasRtc_)
+               rtc_.update(cc, ds);
+         }
+
          void rtcWrite(unsigned data)
          {
             rtc_.write(data);
@@ -132,6 +152,7 @@ namespace gambatte
          void setSaveDir(const std::string &dir);
          int loadROM(const void *romdata, unsigned romsize, bool forceDmg, bool multicartCompat);
          void setGameGenie(const std::string &codes);
+         void enableGameGenie(const std::string &codes, bool enable);
          void clearCheats();
 
          void *savedata_ptr();
@@ -142,22 +163,31 @@ namespace gambatte
          unsigned rtcdata_size();
 
       private:
-         struct AddrData
+         struct GgCode
          {
-            unsigned long addr;
-            unsigned char data;
-            AddrData(unsigned long addr, unsigned data) : addr(addr), data(data)
-            {
-            }
+            unsigned addr;
+            unsigned char val;
+            bool enabled;
+            // ROM offsets the code patches, found once when it is first seen
+            std::vector<unsigned long> offsets;
          };
          MemPtrs memptrs_;
          Rtc rtc_;
+         bool hasRtc_;
 
          std::auto_ptr<Mbc> mbc;
 
-         std::vector<AddrData> ggUndoList_;
-
-         void applyGameGenie(const std::string &code);
+         // every code seen since the ROM was loaded, and the unpatched ROM
+         // bytes at the offsets any of them patch
+         std::map<std::string, GgCode> ggCodes_;
+         std::map<unsigned long, unsigned char> ggOriginal_;
+         // the enabled codes, in the order they were applied
+         std::vector<GgCode *> ggEnabled_;
+
+         GgCode * ggCode(const std::string &code);
+         void patchGameGenie(const GgCode &gg);
+         void applyGameGenie(GgCode &gg);
+         void undoGameGenie(GgCode &gg);
    };
 
 }
@@ -70,7 +70,7 @@ namespace gambatte
 
    void Cartridge::clearCheats()
    {
-      ggUndoList_.clear();
+      setGameGenie(std::string());
    }
 
 }
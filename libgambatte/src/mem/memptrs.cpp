@@ -73,6 +73,8 @@ namespace gambatte
       std::memset(rdisabledRamw(), 0xFF, 0x2000);
 
       oamDmaSrc_    = oam_dma_src_off;
+      // make setRombank(1) below reach JS even if the new chunk reuses the old address
+      romdata_[1]   = 0;
       rmem_[0x3]    = rmem_[0x2] = rmem_[0x1] = rmem_[0x0] = romdata_[0];
       rmem_[0xC]    = wmem_[0xC] = wramdata_[0] - 0xC000;
       rmem_[0xE]    = wmem_[0xE] = wramdata_[0] - 0xE000;
@@ -95,11 +97,15 @@ namespace gambatte
    //  * each element is a game boy memory bank
    //  * they are pointers to the currently set banks memory on the emscripten heap
    // 
+   // Games often rewrite the bank register with the bank already mapped, so
+   // the rombank setters only call into JS when the bank actually changes.
+   // 
    void MemPtrs::setRombank0(const unsigned bank)
    {
-      EM_ASM_INT({
-           window.setRombank0($0,$1,$2,$3);
-         }, romdata(), bank, 0x4000ul,  romdata() + bank * 0x4000ul);
+      if (romdata_[0] != romdata() + bank * 0x4000ul)
+         EM_ASM_INT({
+              window.setRombank0($0,$1,$2,$3);
+            }, romdata(), bank, 0x4000ul,  romdata() + bank * 0x4000ul);
       romdata_[0] = romdata() + bank * 0x4000ul;
       rmem_[0x3] = rmem_[0x2] = rmem_[0x1] = rmem_[0x0] = romdata_[0];
       disconnectOamDmaAreas();
@@ -117,9 +123,10 @@ namespace gambatte
    // 
    void MemPtrs::setRombank(const unsigned bank)
    {
-      EM_ASM_INT({
-           window.setRombank1($0,$1,$2,$3);
-         }, romdata(), bank, (bank*UNSIGNED_16KB) - _16KB,  romdata() + bank * UNSIGNED_16KB - _16KB);
+      if (romdata_[1] != romdata() + bank * UNSIGNED_16KB - _16KB)
+         EM_ASM_INT({
+              window.setRombank1($0,$1,$2,$3);
+            }, romdata(), bank, (bank*UNSIGNED_16KB) - _16KB,  romdata() + bank * UNSIGNED_16KB - _16KB);
       romdata_[1] = romdata() + bank * UNSIGNED_16KB - _16KB;
       rmem_[0x7] = rmem_[0x6] = rmem_[0x5] = rmem_[0x4] = romdata_[1];
       disconnectOamDmaAreas();
@@ -27,6 +27,9 @@ namespace gambatte
       activeSet_(NULL),
       baseTime_(0),
       haltTime_(0),
+      epoch_(0),
+      ticks_(0),
+      ticksUpdated_(0),
       index_(5),
       dataDh_(0),
       dataDl_(0),
@@ -34,18 +37,22 @@ namespace gambatte
       dataM_(0),
       dataS_(0),
       enabled_(false),
-      lastLatchData_(false)
+      lastLatchData_(false),
+      emulatedTime_(false)
    {
    }
 
    void Rtc::doLatch()
    {
-      uint64_t tmp = ((dataDh_ & 0x40) ? haltTime_ : std::time(0)) - baseTime_;
+      uint64_t tmp = ((dataDh_ & 0x40) ? haltTime_ : now()) - baseTime_;
 
-      while (tmp > 0x1FF * 86400)
+      if (tmp > 0x1FF * 86400)
       {
-         baseTime_ += 0x1FF * 86400;
-         tmp      -= 0x1FF * 86400;
+         // skip whole day counter periods at once, tmp may be huge if the
+         // base time lies ahead of the clock
+         const uint64_t periods = (tmp - 1) / (0x1FF * 86400);
+         baseTime_ += periods * (0x1FF * 86400);
+         tmp       -= periods * (0x1FF * 86400);
          dataDh_   |= 0x80;
       }
 
@@ -95,6 +102,17 @@ namespace gambatte
       }
    }
 
+   void Rtc::setEmulatedTime(const bool enable, const uint64_t epoch)
+   {
+      const uint64_t before = now();
+      emulatedTime_ = enable;
+      epoch_ = epoch;
+
+      const uint64_t delta = now() - before;
+      baseTime_ += delta;
+      haltTime_ += delta;
+   }
+
    void Rtc::saveState(SaveState &state) const
    {
       state.rtc.baseTime      = baseTime_;
@@ -105,6 +123,10 @@ namespace gambatte
       state.rtc.dataM         = dataM_;
       state.rtc.dataS         = dataS_;
       state.rtc.lastLatchData = lastLatchData_;
+      state.rtc.emulatedTime  = emulatedTime_;
+      state.rtc.epoch         = epoch_;
+      state.rtc.ticks         = ticks_;
+      state.rtc.ticksUpdated  = ticksUpdated_;
    }
 
    void Rtc::loadState(const SaveState &state)
@@ -117,13 +139,20 @@ namespace gambatte
       dataM_         = state.rtc.dataM;
       dataS_         = state.rtc.dataS;
       lastLatchData_ = state.rtc.lastLatchData;
+      emulatedTime_  = state.rtc.emulatedTime;
+      epoch_         = state.rtc.epoch;
+      ticks_         = state.rtc.ticks;
+      // states from before the emulated clock don't have its update time
+      ticksUpdated_  = state.rtc.ticksUpdated != disabled_time
+                     ? state.rtc.ticksUpdated
+                     : state.cpu.cycleCounter;
 
       doSwapActive();
    }
 
    void Rtc::setDh(const unsigned new_dh)
    {
-      const uint64_t unixtime     = (dataDh_ & 0x40) ? haltTime_ : std::time(0);
+      const uint64_t unixtime     = (dataDh_ & 0x40) ? haltTime_ : now();
       const uint64_t old_highdays = ((unixtime - baseTime_) / 86400) & 0x100;
       baseTime_                   += old_highdays * 86400;
       baseTime_                   -= ((new_dh & 0x1) << 8) * 86400;
@@ -131,15 +160,15 @@ namespace gambatte
       if ((dataDh_ ^ new_dh) & 0x40)
       {
          if (new_dh & 0x40)
-            haltTime_ = std::time(0);
+            haltTime_ = now();
          else
-            baseTime_ += std::time(0) - haltTime_;
+            baseTime_ += now() - haltTime_;
       }
    }
 
    void Rtc::setDl(const unsigned new_lowdays)
    {
-      const uint64_t unixtime = (dataDh_ & 0x40) ? haltTime_ : std::time(0);
+      const uint64_t unixtime = (dataDh_ & 0x40) ? haltTime_ : now();
       const uint64_t old_lowdays = ((unixtime - baseTime_) / 86400) & 0xFF;
       baseTime_ += old_lowdays * 86400;
       baseTime_ -= new_lowdays * 86400;
@@ -147,7 +176,7 @@ namespace gambatte
 
    void Rtc::setH(const unsigned new_hours)
    {
-      const uint64_t unixtime = (dataDh_ & 0x40) ? haltTime_ : std::time(0);
+      const uint64_t unixtime = (dataDh_ & 0x40) ? haltTime_ : now();
       const uint64_t old_hours = ((unixtime - baseTime_) / 3600) % 24;
       baseTime_ += old_hours * 3600;
       baseTime_ -= new_hours * 3600;
@@ -155,7 +184,7 @@ namespace gambatte
 
    void Rtc::setM(const unsigned new_minutes)
    {
-      const uint64_t unixtime = (dataDh_ & 0x40) ? haltTime_ : std::time(0);
+      const uint64_t unixtime = (dataDh_ & 0x40) ? haltTime_ : now();
       const uint64_t old_minutes = ((unixtime - baseTime_) / 60) % 60;
       baseTime_ += old_minutes * 60;
       baseTime_ -= new_minutes * 60;
@@ -163,7 +192,7 @@ namespace gambatte
 
    void Rtc::setS(const unsigned new_seconds)
    {
-      const uint64_t unixtime = (dataDh_ & 0x40) ? haltTime_ : std::time(0);
+      const uint64_t unixtime = (dataDh_ & 0x40) ? haltTime_ : now();
       baseTime_ += (unixtime - baseTime_) % 60;
       baseTime_ -= new_seconds;
    }
@@ -19,6 +19,7 @@
 #ifndef RTC_H
 #define RTC_H
 
+#include "counterdef.h"
 #include <ctime>
 #include <stdint.h>
 
@@ -55,6 +56,20 @@ namespace gambatte
             lastLatchData_ = data;
          }
 
+         /** Counts emulated time instead of host time if enable is set, the clock
+           * reading epoch (unix time) at power-on. The registers keep their value
+           * across a switch.
+           */
+         void setEmulatedTime(bool enable, uint64_t epoch);
+
+         // Brings the emulated clock up to cc. Call before any access that may
+         // read the time, and before a speed change with the old speed.
+         void update(const cycle_t cc, const bool ds)
+         {
+            ticks_ += (cc - ticksUpdated_) << !ds;
+            ticksUpdated_ = cc;
+         }
+
          void saveState(SaveState &state) const;
          void loadState(const SaveState &state);
 
@@ -80,6 +95,10 @@ namespace gambatte
          void (Rtc::*activeSet_)(unsigned);
          uint64_t baseTime_;
          uint64_t haltTime_;
+         uint64_t epoch_;
+         // emulated time since power-on in double speed cycles, 2^23 per second
+         uint64_t ticks_;
+         cycle_t ticksUpdated_;
          unsigned char index_;
          unsigned char dataDh_;
          unsigned char dataDl_;
@@ -88,6 +107,12 @@ namespace gambatte
          unsigned char dataS_;
          bool enabled_;
          bool lastLatchData_;
+         bool emulatedTime_;
+
+         uint64_t now() const
+         {
+            return emulatedTime_ ? epoch_ + (ticks_ >> 23) : std::time(0);
+         }
 
          void doLatch();
          void doSwapActive();
@@ -19,6 +19,7 @@
 #ifndef MINKEEPER_H
 #define MINKEEPER_H
 
+#include "counterdef.h"
 #include <algorithm>
 
 namespace MinKeeperUtil
@@ -82,37 +83,37 @@ class MinKeeper
    };
 
 
-   unsigned long values[ids];
-   unsigned long minValue_;
+   gambatte::cycle_t values[ids];
+   gambatte::cycle_t minValue_;
    void (*updateValueLut[Num<LEVELS-1>::RESULT])(MinKeeper<ids>*const);
    int a[Sum<LEVELS>::RESULT];
 
    template<int id> static void updateValue(MinKeeper<ids> *const s);
 
    public:
-   MinKeeper(unsigned long initValue = 0xFFFFFFFF);
+   MinKeeper(gambatte::cycle_t initValue = gambatte::disabled_time);
 
    int min() const { return a[0]; }
-   unsigned long minValue() const { return minValue_; }
+   gambatte::cycle_t minValue() const { return minValue_; }
 
    template<int id>
-      void setValue(const unsigned long cnt)
+      void setValue(const gambatte::cycle_t cnt)
       {
          values[id] = cnt;
          updateValue<id / 2>(this);
       }
 
-   void setValue(const int id, const unsigned long cnt)
+   void setValue(const int id, const gambatte::cycle_t cnt)
    {
       values[id] = cnt;
       updateValueLut[id >> 1](this);
    }
 
-   unsigned long value(const int id) const { return values[id]; }
+   gambatte::cycle_t value(const int id) const { return values[id]; }
 };
 
 template<int ids>
-MinKeeper<ids>::MinKeeper(const unsigned long initValue)
+MinKeeper<ids>::MinKeeper(const gambatte::cycle_t initValue)
 {
    std::fill(values, values + ids, initValue);
 
@@ -154,4 +155,130 @@ void MinKeeper<ids>::updateValue(MinKeeper<ids> *const s)
 	UpdateValue<id / 2, LEVELS-1>::updateValue(s);
 }
 
+
+// Same interface and tie-breaking as MinKeeper, without the tree. Values are
+// kept in an array padded to a multiple of four with disabled_time, and every
+// change recomputes the minimum with a branchless scan over four running
+// minimums. It is plain portable code with short dependency chains; SSE2 and
+// wasm SIMD have no 64-bit unsigned min, so it is not meant to vectorize.
+// min() is found on demand by searching down from the highest id.
+template<int ids>
+class LinearMinKeeper
+{
+   enum { PADDED = (ids + 3) & ~3 };
+
+   gambatte::cycle_t values[PADDED];
+   gambatte::cycle_t minValue_;
+
+   static gambatte::cycle_t min2(const gambatte::cycle_t a, const gambatte::cycle_t b)
+   {
+      return b < a ? b : a;
+   }
+
+   void updateMinValue()
+   {
+      gambatte::cycle_t m0 = values[0], m1 = values[1], m2 = values[2], m3 = values[3];
+
+      for (int i = 4; i < PADDED; i += 4)
+      {
+         m0 = min2(m0, values[i    ]);
+         m1 = min2(m1, values[i + 1]);
+         m2 = min2(m2, values[i + 2]);
+         m3 = min2(m3, values[i + 3]);
+      }
+
+      minValue_ = min2(min2(m0, m1), min2(m2, m3));
+   }
+
+   public:
+   LinearMinKeeper(const gambatte::cycle_t initValue = gambatte::disabled_time)
+   {
+      std::fill(values, values + ids, initValue);
+      std::fill(values + ids, values + PADDED, gambatte::disabled_time);
+      updateMinValue();
+   }
+
+   int min() const
+   {
+      int id = ids - 1;
+
+      while (values[id] != minValue_)
+         --id;
+
+      return id;
+   }
+
+   gambatte::cycle_t minValue() const { return minValue_; }
+
+   template<int id>
+      void setValue(const gambatte::cycle_t cnt)
+      {
+         values[id] = cnt;
+         updateMinValue();
+      }
+
+   void setValue(const int id, const gambatte::cycle_t cnt)
+   {
+      values[id] = cnt;
+      updateMinValue();
+   }
+
+   gambatte::cycle_t value(const int id) const { return values[id]; }
+};
+
+#ifdef MINKEEPER_RECORD
+// Receives every setValue() (id >= 0) and min() (id < 0) on the event queues
+// of a core built with MINKEEPER_RECORD. Defined by the recording harness.
+void minKeeperRecord(const void *keeper, int ids, int id, gambatte::cycle_t value);
+
+template<int ids>
+class RecordingMinKeeper
+{
+   MinKeeper<ids> keeper_;
+
+   public:
+   RecordingMinKeeper(const gambatte::cycle_t initValue = gambatte::disabled_time)
+   : keeper_(initValue)
+   {
+   }
+
+   int min() const
+   {
+      minKeeperRecord(this, ids, -1, 0);
+      return keeper_.min();
+   }
+
+   gambatte::cycle_t minValue() const { return keeper_.minValue(); }
+
+   template<int id>
+      void setValue(const gambatte::cycle_t cnt)
+      {
+         minKeeperRecord(this, ids, id, cnt);
+         keeper_.template setValue<id>(cnt);
+      }
+
+   void setValue(const int id, const gambatte::cycle_t cnt)
+   {
+      minKeeperRecord(this, ids, id, cnt);
+      keeper_.setValue(id, cnt);
+   }
+
+   gambatte::cycle_t value(const int id) const { return keeper_.value(id); }
+};
+#endif
+
+// Backend used by the interrupt and LCD event queues, chosen per target at
+// build time. bench/minkeeper_bench.cpp compares them on recorded event streams.
+template<int ids>
+struct EventMinKeeper
+{
+#if defined(MINKEEPER_RECORD)
+   typedef RecordingMinKeeper<ids> Type;
+#elif defined(MINKEEPER_LINEAR)
+   typedef LinearMinKeeper<ids> Type;
+#else
+   typedef MinKeeper<ids> Type;
+#endif
+};
+
 #endif
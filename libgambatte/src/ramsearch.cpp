@@ -0,0 +1,236 @@
+//
+//   Copyright (C) 2026 by the gambatte contributors
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License version 2 for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   version 2 along with this program; if not, write to the
+//   Free Software Foundation, Inc.,
+//   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+//
+
+#include "ramsearch.h"
+#include <cstring>
+
+namespace gambatte {
+
+namespace {
+
+// Each region is padded to whole bitmap words, plus the word a halfword
+// straddling the last one reads into.
+std::size_t paddedSize(std::size_t size) {
+	return (size + 63) / 64 * 64 + 8;
+}
+
+// A single load in host order, swapped on big-endian hosts. Assembling the
+// word from bytes is not reliably merged into one load, and is several times
+// slower.
+inline uint64_t load64le(unsigned char const *const p) {
+	uint64_t v;
+	std::memcpy(&v, p, sizeof v);
+
+	unsigned const one = 1;
+	if (!*reinterpret_cast<unsigned char const *>(&one)) {
+		v = (v & 0x00000000FFFFFFFFull) << 32 | v >> 32;
+		v = (v & 0x0000FFFF0000FFFFull) << 16 | (v >> 16 & 0x0000FFFF0000FFFFull);
+		v = (v & 0x00FF00FF00FF00FFull) <<  8 | (v >>  8 & 0x00FF00FF00FF00FFull);
+	}
+
+	return v;
+}
+
+// Lane-wise helpers on 8 bytes or 4 halfwords, hi having the top bit of each
+// lane set. A matching lane gets its top bit set in the returned masks.
+inline uint64_t zeroLanes(uint64_t const x, uint64_t const hi) {
+	return ~(((x & ~hi) + ~hi) | x) & hi;
+}
+
+inline uint64_t subLanes(uint64_t const a, uint64_t const b, uint64_t const hi) {
+	return ((a | hi) - (b & ~hi)) ^ ((a ^ ~b) & hi);
+}
+
+template<RamSearch::Filter filter>
+inline uint64_t matchLanes(uint64_t const cur, uint64_t const prev, uint64_t const operand, uint64_t const hi) {
+	switch (filter) {
+	case RamSearch::unchanged:    return zeroLanes(cur ^ prev, hi);
+	case RamSearch::changed:      return ~zeroLanes(cur ^ prev, hi) & hi;
+	case RamSearch::equal_to:     return zeroLanes(cur ^ operand, hi);
+	case RamSearch::increased_by: return zeroLanes(subLanes(cur, prev, hi) ^ operand, hi);
+	case RamSearch::decreased_by: return zeroLanes(subLanes(prev, cur, hi) ^ operand, hi);
+	}
+
+	return 0;
+}
+
+// Gathers the lane top bits into the low byte, lane n into bit n for bytes
+// and into bit 2n for halfwords. The multiplies place every lane bit at a
+// distinct position, so nothing carries into the byte taken.
+inline unsigned packBytes(uint64_t const m) {
+	return (m >> 7) * 0x0102040810204080ull >> 56;
+}
+
+inline unsigned packHalfwords(uint64_t const m) {
+	return (m >> 15) * 0x0100040010004000ull >> 56;
+}
+
+// Filters the candidates in bits, a bit per byte of cur and prev.
+template<RamSearch::Filter filter>
+void filterBytes(uint64_t *const bits, std::size_t const words,
+		unsigned char const *cur, unsigned char const *prev, unsigned const operand) {
+	uint64_t const hi = 0x8080808080808080ull;
+	uint64_t const n = (operand & 0xFF) * 0x0101010101010101ull;
+
+	for (std::size_t w = 0; w < words; ++w, cur += 64, prev += 64) {
+		if (!bits[w])
+			continue;
+
+		uint64_t mask = 0;
+		for (unsigned i = 0; i < 64; i += 8)
+			mask |= uint64_t(packBytes(matchLanes<filter>(load64le(cur + i), load64le(prev + i), n, hi))) << i;
+
+		bits[w] &= mask;
+	}
+}
+
+template<RamSearch::Filter filter>
+void filterHalfwords(uint64_t *const bits, std::size_t const words,
+		unsigned char const *cur, unsigned char const *prev, unsigned const operand) {
+	uint64_t const hi = 0x8000800080008000ull;
+	uint64_t const n = (operand & 0xFFFF) * 0x0001000100010001ull;
+
+	for (std::size_t w = 0; w < words; ++w, cur += 64, prev += 64) {
+		if (!bits[w])
+			continue;
+
+		uint64_t mask = 0;
+		for (unsigned i = 0; i < 64; i += 8) {
+			unsigned const even = packHalfwords(matchLanes<filter>(load64le(cur + i), load64le(prev + i), n, hi));
+			unsigned const odd = packHalfwords(matchLanes<filter>(load64le(cur + i + 1), load64le(prev + i + 1), n, hi));
+			mask |= uint64_t(even | odd << 1) << i;
+		}
+
+		bits[w] &= mask;
+	}
+}
+
+template<RamSearch::Filter filter>
+void filterWidth(unsigned const width, uint64_t *const bits, std::size_t const words,
+		unsigned char const *const cur, unsigned char const *const prev, unsigned const operand) {
+	if (width == 2)
+		filterHalfwords<filter>(bits, words, cur, prev, operand);
+	else
+		filterBytes<filter>(bits, words, cur, prev, operand);
+}
+
+unsigned popcount64(uint64_t x) {
+	x -= x >> 1 & 0x5555555555555555ull;
+	x = (x & 0x3333333333333333ull) + (x >> 2 & 0x3333333333333333ull);
+	x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+	return x * 0x0101010101010101ull >> 56;
+}
+
+}
+
+void RamSearch::addRegion(unsigned const tag, unsigned char const *const data, std::size_t const size) {
+	regions_.push_back(Region());
+	Region &r = regions_.back();
+	r.tag = tag;
+	r.data = data;
+	r.size = size;
+	r.snapshot.assign(paddedSize(size), 0);
+	std::memcpy(&r.snapshot[0], data, size);
+	r.bits.assign((size + 63) / 64, ~uint64_t(0));
+
+	if (size % 64)
+		r.bits.back() = ~uint64_t(0) >> (64 - size % 64);
+}
+
+std::size_t RamSearch::filter(Filter const filter, unsigned const width, unsigned const operand) {
+	width_ = width == 2 ? 2 : 1;
+
+	for (std::size_t ri = 0; ri < regions_.size(); ++ri) {
+		Region &r = regions_[ri];
+		if (!r.size)
+			continue;
+
+		scratch_.resize(r.snapshot.size());
+		std::memcpy(&scratch_[0], r.data, r.size);
+		std::memset(&scratch_[r.size], 0, scratch_.size() - r.size);
+
+		// the last byte has no halfword of its own, so a halfword step leaves
+		// it as it was for later byte steps
+		uint64_t &tailWord = r.bits[(r.size - 1) / 64];
+		uint64_t const tailBit = uint64_t(1) << (r.size - 1) % 64;
+		uint64_t const tail = tailWord & tailBit;
+
+		uint64_t *const bits = &r.bits[0];
+		std::size_t const words = r.bits.size();
+		unsigned char const *const cur = &scratch_[0];
+		unsigned char const *const prev = &r.snapshot[0];
+
+		switch (filter) {
+		case unchanged:    filterWidth<unchanged>(width_, bits, words, cur, prev, operand); break;
+		case changed:      filterWidth<changed>(width_, bits, words, cur, prev, operand); break;
+		case equal_to:     filterWidth<equal_to>(width_, bits, words, cur, prev, operand); break;
+		case increased_by: filterWidth<increased_by>(width_, bits, words, cur, prev, operand); break;
+		case decreased_by: filterWidth<decreased_by>(width_, bits, words, cur, prev, operand); break;
+		}
+
+		if (width_ == 2)
+			tailWord = (tailWord & ~tailBit) | tail;
+
+		r.snapshot.swap(scratch_);
+	}
+
+	return candidates();
+}
+
+uint64_t RamSearch::hitBits(Region const &r, std::size_t const w) const {
+	if (width_ == 2 && w == (r.size - 1) / 64)
+		return r.bits[w] & ~(uint64_t(1) << (r.size - 1) % 64);
+
+	return r.bits[w];
+}
+
+std::size_t RamSearch::candidates() const {
+	std::size_t n = 0;
+	for (std::size_t ri = 0; ri < regions_.size(); ++ri) {
+		for (std::size_t w = 0; w < regions_[ri].bits.size(); ++w)
+			n += popcount64(hitBits(regions_[ri], w));
+	}
+
+	return n;
+}
+
+std::size_t RamSearch::hits(SearchHit *const hits, std::size_t const max) const {
+	std::size_t n = 0;
+
+	for (std::size_t ri = 0; ri < regions_.size(); ++ri) {
+		Region const &r = regions_[ri];
+
+		for (std::size_t w = 0; w < r.bits.size(); ++w) {
+			for (uint64_t bits = hitBits(r, w); bits; bits &= bits - 1, ++n) {
+				if (n >= max)
+					continue;
+
+				std::size_t const offset = w * 64 + popcount64((bits & -bits) - 1);
+				hits[n].area = r.tag;
+				hits[n].offset = offset;
+				hits[n].value = width_ == 2
+				              ? r.snapshot[offset] | r.snapshot[offset + 1] << 8
+				              : r.snapshot[offset];
+			}
+		}
+	}
+
+	return n;
+}
+
+}
@@ -0,0 +1,79 @@
+//
+//   Copyright (C) 2026 by the gambatte contributors
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License version 2 for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   version 2 along with this program; if not, write to the
+//   Free Software Foundation, Inc.,
+//   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+//
+
+#ifndef RAMSEARCH_H
+#define RAMSEARCH_H
+
+#include "gambatte.h"
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+namespace gambatte {
+
+// Narrows down where in RAM a value lives by comparing RAM against a snapshot
+// taken at the previous step. Candidates are kept as a bitmap with a bit per
+// byte, and compared 8 bytes or 4 halfwords at a time in 64-bit words, so a
+// step over 32 KiB is a few thousand word operations. Bitmap words without
+// candidates are skipped.
+class RamSearch {
+public:
+	// in GB::SearchFilter order
+	enum Filter { unchanged, changed, equal_to, increased_by, decreased_by };
+
+	RamSearch() : width_(1) {}
+	void clear() { regions_.clear(); }
+
+	// Makes every byte of size bytes at data a candidate, and snapshots them.
+	// data must stay valid until clear.
+	void addRegion(unsigned tag, unsigned char const *data, std::size_t size);
+
+	// Keeps the candidates whose width (1 or 2) byte little-endian value passes
+	// filter against the snapshot, or against operand for equal_to, then takes
+	// a new snapshot. Returns the number of candidates left. The last byte of
+	// a region is left out while the width is 2, but kept for later steps of
+	// width 1.
+	std::size_t filter(Filter filter, unsigned width, unsigned operand);
+
+	std::size_t candidates() const;
+
+	// Copies up to max candidates in region order, with the tag of their
+	// region as area and their values in the snapshot. Returns the number of
+	// candidates.
+	std::size_t hits(SearchHit *hits, std::size_t max) const;
+
+private:
+	struct Region {
+		unsigned tag;
+		unsigned char const *data;
+		std::size_t size;
+		std::vector<unsigned char> snapshot; // padded for whole-word reads
+		std::vector<uint64_t> bits;
+	};
+
+	// bits[w] of r without the last byte while the width is 2
+	uint64_t hitBits(Region const &r, std::size_t w) const;
+
+	std::vector<Region> regions_;
+	std::vector<unsigned char> scratch_;
+	unsigned width_;
+};
+
+}
+
+#endif
@@ -0,0 +1,200 @@
+//
+//   Copyright (C) 2026 by the gambatte contributors
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License version 2 for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   version 2 along with this program; if not, write to the
+//   Free Software Foundation, Inc.,
+//   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+//
+
+#include "rewindbuffer.h"
+#include <cstring>
+#include <stdint.h>
+
+namespace {
+
+// runs of equal bytes shorter than this are cheaper to keep in a literal
+enum { min_zero_run = 4 };
+
+static void putVarint(std::vector<unsigned char> &out, std::size_t n) {
+	while (n >= 0x80) {
+		out.push_back((n & 0x7F) | 0x80);
+		n >>= 7;
+	}
+
+	out.push_back(n);
+}
+
+static std::size_t getVarint(unsigned char const *&in) {
+	std::size_t n = 0;
+	int shift = 0;
+
+	while (*in & 0x80) {
+		n |= static_cast<std::size_t>(*in++ & 0x7F) << shift;
+		shift += 7;
+	}
+
+	return n | static_cast<std::size_t>(*in++) << shift;
+}
+
+static std::size_t skipEqual(unsigned char const *a, unsigned char const *b,
+		std::size_t i, std::size_t n) {
+	while (i + 8 <= n) {
+		uint64_t wa, wb;
+		std::memcpy(&wa, a + i, 8);
+		std::memcpy(&wb, b + i, 8);
+
+		if (wa != wb)
+			break;
+
+		i += 8;
+	}
+
+	while (i < n && a[i] == b[i])
+		++i;
+
+	return i;
+}
+
+static std::size_t literalEnd(unsigned char const *a, unsigned char const *b,
+		std::size_t i, std::size_t n) {
+	while (i < n) {
+		if (a[i] != b[i]) {
+			++i;
+			continue;
+		}
+
+		std::size_t z = i;
+		while (z < n && z - i < min_zero_run && a[z] == b[z])
+			++z;
+
+		if (z == n || z - i == min_zero_run)
+			return i;
+
+		i = z;
+	}
+
+	return n;
+}
+
+// out = a ^ b as a sequence of (zero run length, literal length, literal bytes).
+// Trailing zeros are left implicit.
+static void encodeDelta(unsigned char const *a, unsigned char const *b,
+		std::size_t n, std::vector<unsigned char> &out) {
+	out.clear();
+
+	std::size_t i = 0;
+	while (i < n) {
+		std::size_t const zeroStart = i;
+		i = skipEqual(a, b, i, n);
+
+		if (i == n)
+			break;
+
+		std::size_t const litStart = i;
+		i = literalEnd(a, b, i, n);
+		putVarint(out, litStart - zeroStart);
+		putVarint(out, i - litStart);
+
+		for (std::size_t j = litStart; j < i; ++j)
+			out.push_back(a[j] ^ b[j]);
+	}
+}
+
+static void applyDelta(unsigned char const *in, std::size_t size, unsigned char *dst) {
+	unsigned char const *const end = in + size;
+
+	while (in < end) {
+		dst += getVarint(in);
+
+		for (std::size_t n = getVarint(in); n; --n)
+			*dst++ ^= *in++;
+	}
+}
+
+}
+
+namespace gambatte {
+
+RewindBuffer::RewindBuffer()
+: head_(0), hasCur_(false)
+{
+}
+
+void RewindBuffer::reset(std::size_t const budget, std::size_t const stateSize) {
+	ring_.reset(budget && stateSize ? budget : 0);
+	cur_.reset(ring_.size() ? stateSize : 0);
+	delta_.clear();
+	clear();
+}
+
+void RewindBuffer::clear() {
+	entries_.clear();
+	head_ = 0;
+	hasCur_ = false;
+}
+
+void RewindBuffer::push(unsigned char const *const state) {
+	if (!enabled())
+		return;
+
+	if (hasCur_) {
+		encodeDelta(cur_, state, cur_.size(), delta_);
+		std::size_t const size = delta_.size();
+
+		if (size > ring_.size()) {
+			// every older entry depends on this one
+			entries_.clear();
+			head_ = 0;
+		} else {
+			std::size_t offset = head_;
+
+			if (offset + size > ring_.size()) {
+				// entries at or past head_ are older than the ones below it
+				while (!entries_.empty() && entries_.front().offset >= head_)
+					entries_.pop_front();
+
+				offset = 0;
+			}
+
+			while (!entries_.empty()
+					&& entries_.front().offset >= offset
+					&& entries_.front().offset < offset + size) {
+				entries_.pop_front();
+			}
+
+			if (size)
+				std::memcpy(ring_ + offset, &delta_[0], size);
+
+			Entry const e = { offset, size };
+			entries_.push_back(e);
+			head_ = offset + size;
+		}
+	}
+
+	std::memcpy(cur_, state, cur_.size());
+	hasCur_ = true;
+}
+
+unsigned char const * RewindBuffer::pop() {
+	if (entries_.empty())
+		return 0;
+
+	Entry const e = entries_.back();
+	entries_.pop_back();
+	applyDelta(ring_ + e.offset, e.size, cur_);
+	head_ = e.offset;
+
+	return cur_;
+}
+
+}
@@ -0,0 +1,60 @@
+//
+//   Copyright (C) 2026 by the gambatte contributors
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License version 2 for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   version 2 along with this program; if not, write to the
+//   Free Software Foundation, Inc.,
+//   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+//
+
+#ifndef REWINDBUFFER_H
+#define REWINDBUFFER_H
+
+#include "gambatte-array.h"
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+namespace gambatte {
+
+// Ring of state snapshots for rewinding. Only the newest snapshot is kept in
+// full; each older one is stored as the run-length encoded XOR of itself and
+// its successor, which is mostly zero between nearby frames. The oldest
+// entries are dropped once the ring exceeds its byte budget.
+class RewindBuffer : Uncopyable {
+public:
+	RewindBuffer();
+	void reset(std::size_t budget, std::size_t stateSize);
+	void clear();
+	bool enabled() const { return ring_.size() != 0; }
+	std::size_t stateSize() const { return cur_.size(); }
+	std::size_t steps() const { return entries_.size(); }
+	void push(unsigned char const *state);
+	unsigned char const * pop();
+
+private:
+	struct Entry {
+		std::size_t offset;
+		std::size_t size;
+	};
+
+	Array<unsigned char> ring_;
+	Array<unsigned char> cur_;
+	std::vector<unsigned char> delta_;
+	std::deque<Entry> entries_;
+	std::size_t head_;
+	bool hasCur_;
+};
+
+}
+
+#endif
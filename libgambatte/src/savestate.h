@@ -19,6 +19,7 @@
 #ifndef SAVESTATE_H
 #define SAVESTATE_H
 
+#include "counterdef.h"
 #include <stddef.h>
 #include <cstddef>
 
@@ -44,7 +45,7 @@ struct SaveState {
 	};
 
 	struct CPU {
-		unsigned long cycleCounter;
+		cycle_t cycleCounter;
 		unsigned short pc;
 		unsigned short sp;
 		unsigned char a;
@@ -63,13 +64,13 @@ struct SaveState {
 		Ptr<unsigned char> sram;
 		Ptr<unsigned char> wram;
 		Ptr<unsigned char> ioamhram;
-		unsigned long divLastUpdate;
-		unsigned long timaLastUpdate;
-		unsigned long tmatime;
-		unsigned long nextSerialtime;
-		unsigned long lastOamDmaUpdate;
-		unsigned long minIntTime;
-		unsigned long unhaltTime;
+		cycle_t divLastUpdate;
+		cycle_t timaLastUpdate;
+		cycle_t tmatime;
+		cycle_t nextSerialtime;
+		cycle_t lastOamDmaUpdate;
+		cycle_t minIntTime;
+		cycle_t unhaltTime;
 		unsigned short rombank;
 		unsigned short dmaSource;
 		unsigned short dmaDestination;
@@ -90,7 +91,7 @@ struct SaveState {
 		Ptr<bool> oamReaderSzbuf;
 
 		unsigned long videoCycles;
-		unsigned long enableDisplayM0Time;
+		cycle_t enableDisplayM0Time;
 		unsigned short lastM0Time;
 		unsigned short nextM0Irq;
 		unsigned short tileword;
@@ -119,25 +120,25 @@ struct SaveState {
 
 	struct SPU {
 		struct Duty {
-			unsigned long nextPosUpdate;
+			cycle_t nextPosUpdate;
 			unsigned char nr3;
 			unsigned char pos;
 			bool high;
 		};
 
 		struct Env {
-			unsigned long counter;
+			cycle_t counter;
 			unsigned char volume;
 		};
 
 		struct LCounter {
-			unsigned long counter;
+			cycle_t counter;
 			unsigned short lengthCounter;
 		};
 
 		struct {
 			struct {
-				unsigned long counter;
+				cycle_t counter;
 				unsigned short shadow;
 				unsigned char nr0;
 				bool negging;
@@ -160,8 +161,8 @@ struct SaveState {
 		struct {
 			Ptr<unsigned char> waveRam;
 			LCounter lcounter;
-			unsigned long waveCounter;
-			unsigned long lastReadTime;
+			cycle_t waveCounter;
+			cycle_t lastReadTime;
 			unsigned char nr3;
 			unsigned char nr4;
 			unsigned char wavePos;
@@ -171,7 +172,7 @@ struct SaveState {
 
 		struct {
 			struct {
-				unsigned long counter;
+				cycle_t counter;
 				unsigned short reg;
 			} lfsr;
 			Env env;
@@ -180,7 +181,7 @@ struct SaveState {
 			bool master;
 		} ch4;
 
-		unsigned long cycleCounter;
+		cycle_t cycleCounter;
 	} spu;
 
 	struct RTC {
@@ -192,6 +193,10 @@ struct SaveState {
 		unsigned char dataM;
 		unsigned char dataS;
 		bool lastLatchData;
+		bool emulatedTime;
+		uint64_t epoch;
+		cycle_t ticks;
+		cycle_t ticksUpdated;
 	} rtc;
 };
 
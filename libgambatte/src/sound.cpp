@@ -104,7 +104,7 @@ namespace gambatte
       ch4_.update(buf, soVol_, cycles);
    }
 
-   void PSG::generateSamples(unsigned long const cycleCounter, bool const doubleSpeed)
+   void PSG::generateSamples(cycle_t const cycleCounter, bool const doubleSpeed)
    {
       unsigned long const cycles = (cycleCounter - lastUpdate_) >> (1 + doubleSpeed);
       lastUpdate_ += cycles << (1 + doubleSpeed);
@@ -115,12 +115,6 @@ namespace gambatte
       bufferPos_ += cycles;
    }
 
-   void PSG::resetCounter(unsigned long newCc, unsigned long oldCc, bool doubleSpeed)
-   {
-      generateSamples(oldCc, doubleSpeed);
-      lastUpdate_ = newCc - (oldCc - lastUpdate_);
-   }
-
    size_t PSG::fillBuffer()
    {
       uint_least32_t sum = rsum_;
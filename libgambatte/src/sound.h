@@ -38,8 +38,7 @@ public:
 	void saveState(SaveState &state);
 	void loadState(SaveState const &state);
 
-	void generateSamples(unsigned long cycleCounter, bool doubleSpeed);
-	void resetCounter(unsigned long newCc, unsigned long oldCc, bool doubleSpeed);
+	void generateSamples(cycle_t cycleCounter, bool doubleSpeed);
    std::size_t fillBuffer();
 	void setBuffer(uint_least32_t *buf) { buffer_ = buf; bufferPos_ = 0; }
 
@@ -81,7 +80,7 @@ private:
 	Channel4 ch4_;
 	uint_least32_t *buffer_;
 	std::size_t bufferPos_;
-	unsigned long lastUpdate_;
+	cycle_t lastUpdate_;
 	unsigned long soVol_;
 	uint_least32_t rsum_;
 	bool enabled_;
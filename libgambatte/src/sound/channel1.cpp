@@ -71,7 +71,7 @@ void Channel1::SweepUnit::nr0Change(unsigned newNr0) {
 	nr0_ = newNr0;
 }
 
-void Channel1::SweepUnit::nr4Init(unsigned long const cc) {
+void Channel1::SweepUnit::nr4Init(cycle_t const cc) {
 	negging_ = false;
 	shadow_ = dutyUnit_.freq();
 
@@ -81,14 +81,14 @@ void Channel1::SweepUnit::nr4Init(unsigned long const cc) {
 	if (period | shift)
 		counter_ = ((((cc + 2 + cgb_ * 2) >> 14) + (period ? period : 8)) << 14) + 2;
 	else
-		counter_ = counter_disabled;
+		counter_ = disabled_time;
 
 	if (shift)
 		calcFreq();
 }
 
 void Channel1::SweepUnit::reset() {
-	counter_ = counter_disabled;
+	counter_ = disabled_time;
 }
 
 void Channel1::SweepUnit::saveState(SaveState &state) const {
@@ -217,13 +217,13 @@ void Channel1::loadState(SaveState const &state) {
 void Channel1::update(uint_least32_t *buf, unsigned long const soBaseVol, unsigned long cycles) {
 	unsigned long const outBase = envelopeUnit_.dacIsOn() ? soBaseVol & soMask_ : 0;
 	unsigned long const outLow = outBase * (0 - 15ul);
-	unsigned long const endCycles = cycleCounter_ + cycles;
+	cycle_t const endCycles = cycleCounter_ + cycles;
 
 	for (;;) {
 		unsigned long const outHigh = master_
 		                            ? outBase * (envelopeUnit_.getVolume() * 2 - 15ul)
 		                            : outLow;
-		unsigned long const nextMajorEvent = std::min(nextEventUnit_->counter(), endCycles);
+		cycle_t const nextMajorEvent = std::min(nextEventUnit_->counter(), endCycles);
 		unsigned long out = dutyUnit_.isHighState() ? outHigh : outLow;
 
 		while (dutyUnit_.counter() <= nextMajorEvent) {
@@ -249,14 +249,6 @@ void Channel1::update(uint_least32_t *buf, unsigned long const soBaseVol, unsign
 		} else
 			break;
 	}
-
-	if (cycleCounter_ >= SoundUnit::counter_max) {
-		dutyUnit_.resetCounters(cycleCounter_);
-		lengthCounter_.resetCounters(cycleCounter_);
-		envelopeUnit_.resetCounters(cycleCounter_);
-		sweepUnit_.resetCounters(cycleCounter_);
-		cycleCounter_ -= SoundUnit::counter_max;
-	}
 }
 
 }
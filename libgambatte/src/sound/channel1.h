@@ -52,7 +52,7 @@ private:
 		SweepUnit(MasterDisabler &disabler, DutyUnit &dutyUnit);
 		virtual void event();
 		void nr0Change(unsigned newNr0);
-		void nr4Init(unsigned long cycleCounter);
+		void nr4Init(cycle_t cycleCounter);
 		void reset();
 		void init(bool cgb) { cgb_ = cgb; }
 		void saveState(SaveState &state) const;
@@ -78,7 +78,7 @@ private:
 	EnvelopeUnit envelopeUnit_;
 	SweepUnit sweepUnit_;
 	SoundUnit *nextEventUnit_;
-	unsigned long cycleCounter_;
+	cycle_t cycleCounter_;
 	unsigned long soMask_;
 	unsigned long prevOut_;
 	unsigned char nr4_;
@@ -116,13 +116,13 @@ void Channel2::loadState(SaveState const &state) {
 void Channel2::update(uint_least32_t *buf, unsigned long const soBaseVol, unsigned long cycles) {
 	unsigned long const outBase = envelopeUnit_.dacIsOn() ? soBaseVol & soMask_ : 0;
 	unsigned long const outLow = outBase * (0 - 15ul);
-	unsigned long const endCycles = cycleCounter_ + cycles;
+	cycle_t const endCycles = cycleCounter_ + cycles;
 
 	for (;;) {
 		unsigned long const outHigh = master_
 		                            ? outBase * (envelopeUnit_.getVolume() * 2 - 15ul)
 		                            : outLow;
-		unsigned long const nextMajorEvent = std::min(nextEventUnit->counter(), endCycles);
+		cycle_t const nextMajorEvent = std::min(nextEventUnit->counter(), endCycles);
 		unsigned long out = dutyUnit_.isHighState() ? outHigh : outLow;
 
 		while (dutyUnit_.counter() <= nextMajorEvent) {
@@ -148,13 +148,6 @@ void Channel2::update(uint_least32_t *buf, unsigned long const soBaseVol, unsign
 		} else
 			break;
 	}
-
-	if (cycleCounter_ >= SoundUnit::counter_max) {
-		dutyUnit_.resetCounters(cycleCounter_);
-		lengthCounter_.resetCounters(cycleCounter_);
-		envelopeUnit_.resetCounters(cycleCounter_);
-		cycleCounter_ -= SoundUnit::counter_max;
-	}
 }
 
 }
@@ -52,7 +52,7 @@ private:
 	DutyUnit dutyUnit_;
 	EnvelopeUnit envelopeUnit_;
 	SoundUnit *nextEventUnit;
-	unsigned long cycleCounter_;
+	cycle_t cycleCounter_;
 	unsigned long soMask_;
 	unsigned long prevOut_;
 	unsigned char nr4_;
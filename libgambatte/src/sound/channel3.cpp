@@ -33,7 +33,7 @@ Channel3::Channel3()
 , cycleCounter_(0)
 , soMask_(0)
 , prevOut_(0)
-, waveCounter_(SoundUnit::counter_disabled)
+, waveCounter_(disabled_time)
 , lastReadTime_(0)
 , nr0_(0)
 , nr3_(0)
@@ -127,7 +127,7 @@ void Channel3::loadState(SaveState const &state) {
 	setNr2(state.mem.ioamhram.get()[0x11C]);
 }
 
-void Channel3::updateWaveCounter(unsigned long const cc) {
+void Channel3::updateWaveCounter(cycle_t const cc) {
 	if (cc >= waveCounter_) {
 		unsigned const period = toPeriod(nr3_, nr4_);
 		unsigned long const periods = (cc - waveCounter_) / period;
@@ -146,10 +146,10 @@ void Channel3::update(uint_least32_t *buf, unsigned long const soBaseVol, unsign
 	unsigned long const outBase = nr0_/* & 0x80*/ ? soBaseVol & soMask_ : 0;
 
 	if (outBase && rshift_ != 4) {
-		unsigned long const endCycles = cycleCounter_ + cycles;
+		cycle_t const endCycles = cycleCounter_ + cycles;
 
 		for (;;) {
-			unsigned long const nextMajorEvent =
+			cycle_t const nextMajorEvent =
 				std::min(lengthCounter_.counter(), endCycles);
 			unsigned long out = master_
 				? ((sampleBuf_ >> (~wavePos_ << 2 & 4) & 0xF) >> rshift_) * 2 - 15ul
@@ -196,16 +196,6 @@ void Channel3::update(uint_least32_t *buf, unsigned long const soBaseVol, unsign
 
 		updateWaveCounter(cycleCounter_);
 	}
-
-	if (cycleCounter_ >= SoundUnit::counter_max) {
-		lengthCounter_.resetCounters(cycleCounter_);
-
-		if (waveCounter_ != SoundUnit::counter_disabled)
-			waveCounter_ -= SoundUnit::counter_max;
-
-		lastReadTime_ -= SoundUnit::counter_max;
-		cycleCounter_ -= SoundUnit::counter_max;
-	}
 }
 
 }
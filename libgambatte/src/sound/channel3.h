@@ -69,25 +69,25 @@ public:
 private:
 	class Ch3MasterDisabler : public MasterDisabler {
 	public:
-		Ch3MasterDisabler(bool &m, unsigned long &wC) : MasterDisabler(m), waveCounter_(wC) {}
+		Ch3MasterDisabler(bool &m, cycle_t &wC) : MasterDisabler(m), waveCounter_(wC) {}
 
 		virtual void operator()() {
 			MasterDisabler::operator()();
-			waveCounter_ = SoundUnit::counter_disabled;
+			waveCounter_ = disabled_time;
 		}
 
 	private:
-		unsigned long &waveCounter_;
+		cycle_t &waveCounter_;
 	};
 
 	unsigned char waveRam_[0x10];
 	Ch3MasterDisabler disableMaster_;
 	LengthCounter lengthCounter_;
-	unsigned long cycleCounter_;
+	cycle_t cycleCounter_;
 	unsigned long soMask_;
 	unsigned long prevOut_;
-	unsigned long waveCounter_;
-	unsigned long lastReadTime_;
+	cycle_t waveCounter_;
+	cycle_t lastReadTime_;
 	unsigned char nr0_;
 	unsigned char nr3_;
 	unsigned char nr4_;
@@ -97,7 +97,7 @@ private:
 	bool master_;
 	bool cgb_;
 
-	void updateWaveCounter(unsigned long cc);
+	void updateWaveCounter(cycle_t cc);
 };
 
 }
@@ -35,14 +35,14 @@ static unsigned long toPeriod(unsigned const nr3) {
 namespace gambatte {
 
 Channel4::Lfsr::Lfsr()
-: backupCounter_(counter_disabled)
+: backupCounter_(disabled_time)
 , reg_(0x7FFF)
 , nr3_(0)
 , master_(false)
 {
 }
 
-void Channel4::Lfsr::updateBackupCounter(unsigned long const cc) {
+void Channel4::Lfsr::updateBackupCounter(cycle_t const cc) {
 	if (backupCounter_ <= cc) {
 		unsigned long const period = toPeriod(nr3_);
 		unsigned long periods = (cc - backupCounter_) / period + 1;
@@ -70,7 +70,7 @@ void Channel4::Lfsr::updateBackupCounter(unsigned long const cc) {
 	}
 }
 
-void Channel4::Lfsr::reviveCounter(unsigned long cc) {
+void Channel4::Lfsr::reviveCounter(cycle_t cc) {
 	updateBackupCounter(cc);
 	counter_ = backupCounter_;
 }
@@ -89,12 +89,12 @@ inline void Channel4::Lfsr::event() {
 	backupCounter_ = counter_;
 }
 
-void Channel4::Lfsr::nr3Change(unsigned newNr3, unsigned long cc) {
+void Channel4::Lfsr::nr3Change(unsigned newNr3, cycle_t cc) {
 	updateBackupCounter(cc);
 	nr3_ = newNr3;
 }
 
-void Channel4::Lfsr::nr4Init(unsigned long cc) {
+void Channel4::Lfsr::nr4Init(cycle_t cc) {
 	disableMaster();
 	updateBackupCounter(cc);
 	master_ = true;
@@ -102,19 +102,13 @@ void Channel4::Lfsr::nr4Init(unsigned long cc) {
 	counter_ = backupCounter_;
 }
 
-void Channel4::Lfsr::reset(unsigned long cc) {
+void Channel4::Lfsr::reset(cycle_t cc) {
 	nr3_ = 0;
 	disableMaster();
 	backupCounter_ = cc + toPeriod(nr3_);
 }
 
-void Channel4::Lfsr::resetCounters(unsigned long oldCc) {
-	updateBackupCounter(oldCc);
-	backupCounter_ -= counter_max;
-	SoundUnit::resetCounters(oldCc);
-}
-
-void Channel4::Lfsr::saveState(SaveState &state, unsigned long cc) {
+void Channel4::Lfsr::saveState(SaveState &state, cycle_t cc) {
 	updateBackupCounter(cc);
 	state.spu.ch4.lfsr.counter = backupCounter_;
 	state.spu.ch4.lfsr.reg = reg_;
@@ -218,11 +212,11 @@ void Channel4::loadState(SaveState const &state) {
 void Channel4::update(uint_least32_t *buf, unsigned long const soBaseVol, unsigned long cycles) {
 	unsigned long const outBase = envelopeUnit_.dacIsOn() ? soBaseVol & soMask_ : 0;
 	unsigned long const outLow = outBase * (0 - 15ul);
-	unsigned long const endCycles = cycleCounter_ + cycles;
+	cycle_t const endCycles = cycleCounter_ + cycles;
 
 	for (;;) {
 		unsigned long const outHigh = outBase * (envelopeUnit_.getVolume() * 2 - 15ul);
-		unsigned long const nextMajorEvent = std::min(nextEventUnit_->counter(), endCycles);
+		cycle_t const nextMajorEvent = std::min(nextEventUnit_->counter(), endCycles);
 		unsigned long out = lfsr_.isHighState() ? outHigh : outLow;
 
 		while (lfsr_.counter() <= nextMajorEvent) {
@@ -248,13 +242,6 @@ void Channel4::update(uint_least32_t *buf, unsigned long const soBaseVol, unsign
 		} else
 			break;
 	}
-
-	if (cycleCounter_ >= SoundUnit::counter_max) {
-		lengthCounter_.resetCounters(cycleCounter_);
-		lfsr_.resetCounters(cycleCounter_);
-		envelopeUnit_.resetCounters(cycleCounter_);
-		cycleCounter_ -= SoundUnit::counter_max;
-	}
 }
 
 }
@@ -48,24 +48,23 @@ private:
 	public:
 		Lfsr();
 		virtual void event();
-		virtual void resetCounters(unsigned long oldCc);
 		bool isHighState() const { return ~reg_ & 1; }
-		void nr3Change(unsigned newNr3, unsigned long cc);
-		void nr4Init(unsigned long cc);
-		void reset(unsigned long cc);
-		void saveState(SaveState &state, unsigned long cc);
+		void nr3Change(unsigned newNr3, cycle_t cc);
+		void nr4Init(cycle_t cc);
+		void reset(cycle_t cc);
+		void saveState(SaveState &state, cycle_t cc);
 		void loadState(SaveState const &state);
 		void disableMaster() { killCounter(); master_ = false; reg_ = 0x7FFF; }
-		void killCounter() { counter_ = counter_disabled; }
-		void reviveCounter(unsigned long cc);
+		void killCounter() { counter_ = disabled_time; }
+		void reviveCounter(cycle_t cc);
 
 	private:
-		unsigned long backupCounter_;
+		cycle_t backupCounter_;
 		unsigned short reg_;
 		unsigned char nr3_;
 		bool master_;
 
-		void updateBackupCounter(unsigned long cc);
+		void updateBackupCounter(cycle_t cc);
 	};
 
 	class Ch4MasterDisabler : public MasterDisabler {
@@ -85,7 +84,7 @@ private:
 	EnvelopeUnit envelopeUnit_;
 	Lfsr lfsr_;
 	SoundUnit *nextEventUnit_;
-	unsigned long cycleCounter_;
+	cycle_t cycleCounter_;
 	unsigned long soMask_;
 	unsigned long prevOut_;
 	unsigned char nr4_;
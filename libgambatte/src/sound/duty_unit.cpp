@@ -30,7 +30,7 @@ static inline unsigned toPeriod(unsigned freq) {
 namespace gambatte {
 
 DutyUnit::DutyUnit()
-: nextPosUpdate_(counter_disabled)
+: nextPosUpdate_(disabled_time)
 , period_(4096)
 , pos_(0)
 , duty_(0)
@@ -40,7 +40,7 @@ DutyUnit::DutyUnit()
 {
 }
 
-void DutyUnit::updatePos(unsigned long const cc) {
+void DutyUnit::updatePos(cycle_t const cc) {
 	if (cc >= nextPosUpdate_) {
 		unsigned long const inc = (cc - nextPosUpdate_) / period_ + 1;
 		nextPosUpdate_ += period_ * inc;
@@ -58,7 +58,7 @@ void DutyUnit::setCounter() {
 		1, 6, 5, 4, 3, 2, 1, 2
 	};
 
-	if (enableEvents_ && nextPosUpdate_ != counter_disabled) {
+	if (enableEvents_ && nextPosUpdate_ != disabled_time) {
 		unsigned const npos = (pos_ + 1) & 7;
 		counter_ = nextPosUpdate_;
 		inc_ = nextStateDistance[duty_ * 8 + npos];
@@ -67,10 +67,10 @@ void DutyUnit::setCounter() {
 			inc_ = nextStateDistance[duty_ * 8 + ((npos + inc_) & 7)];
 		}
 	} else
-		counter_ = counter_disabled;
+		counter_ = disabled_time;
 }
 
-void DutyUnit::setFreq(unsigned newFreq, unsigned long cc) {
+void DutyUnit::setFreq(unsigned newFreq, cycle_t cc) {
 	updatePos(cc);
 	period_ = toPeriod(newFreq);
 	setCounter();
@@ -89,21 +89,21 @@ void DutyUnit::event() {
 	inc_ = inc[duty_ * 2 + high_];
 }
 
-void DutyUnit::nr1Change(unsigned newNr1, unsigned long cc) {
+void DutyUnit::nr1Change(unsigned newNr1, cycle_t cc) {
 	updatePos(cc);
 	duty_ = newNr1 >> 6;
 	setCounter();
 }
 
-void DutyUnit::nr3Change(unsigned newNr3, unsigned long cc) {
+void DutyUnit::nr3Change(unsigned newNr3, cycle_t cc) {
 	setFreq((freq() & 0x700) | newNr3, cc);
 }
 
-void DutyUnit::nr4Change(unsigned const newNr4, unsigned long const cc) {
+void DutyUnit::nr4Change(unsigned const newNr4, cycle_t const cc) {
 	setFreq((newNr4 << 8 & 0x700) | (freq() & 0xFF), cc);
 
 	if (newNr4 & 0x80) {
-		nextPosUpdate_ = (cc & ~1ul) + period_ + 4;
+		nextPosUpdate_ = (cc & ~cycle_t(1)) + period_ + 4;
 		setCounter();
 	}
 }
@@ -111,11 +111,11 @@ void DutyUnit::nr4Change(unsigned const newNr4, unsigned long const cc) {
 void DutyUnit::reset() {
 	pos_ = 0;
 	high_ = false;
-	nextPosUpdate_ = counter_disabled;
+	nextPosUpdate_ = disabled_time;
 	setCounter();
 }
 
-void DutyUnit::saveState(SaveState::SPU::Duty &dstate, unsigned long const cc) {
+void DutyUnit::saveState(SaveState::SPU::Duty &dstate, cycle_t const cc) {
 	updatePos(cc);
 	setCounter();
 	dstate.nextPosUpdate = nextPosUpdate_;
@@ -125,7 +125,7 @@ void DutyUnit::saveState(SaveState::SPU::Duty &dstate, unsigned long const cc) {
 }
 
 void DutyUnit::loadState(SaveState::SPU::Duty const &dstate,
-		unsigned const nr1, unsigned const nr4, unsigned long const cc) {
+		unsigned const nr1, unsigned const nr4, cycle_t const cc) {
 	nextPosUpdate_ = std::max(dstate.nextPosUpdate, cc);
 	pos_ = dstate.pos & 7;
 	high_ = dstate.high;
@@ -135,21 +135,12 @@ void DutyUnit::loadState(SaveState::SPU::Duty const &dstate,
 	setCounter();
 }
 
-void DutyUnit::resetCounters(unsigned long const oldCc) {
-	if (nextPosUpdate_ == counter_disabled)
-		return;
-
-	updatePos(oldCc);
-	nextPosUpdate_ -= counter_max;
-	setCounter();
-}
-
 void DutyUnit::killCounter() {
 	enableEvents_ = false;
 	setCounter();
 }
 
-void DutyUnit::reviveCounter(unsigned long const cc) {
+void DutyUnit::reviveCounter(cycle_t const cc) {
 	updatePos(cc);
 	enableEvents_ = true;
 	setCounter();
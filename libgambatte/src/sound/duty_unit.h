@@ -29,23 +29,22 @@ class DutyUnit : public SoundUnit {
 public:
 	DutyUnit();
 	virtual void event();
-	virtual void resetCounters(unsigned long oldCc);
 	bool isHighState() const { return high_; }
-	void nr1Change(unsigned newNr1, unsigned long cc);
-	void nr3Change(unsigned newNr3, unsigned long cc);
-	void nr4Change(unsigned newNr4, unsigned long cc);
+	void nr1Change(unsigned newNr1, cycle_t cc);
+	void nr3Change(unsigned newNr3, cycle_t cc);
+	void nr4Change(unsigned newNr4, cycle_t cc);
 	void reset();
-	void saveState(SaveState::SPU::Duty &dstate, unsigned long cc);
-	void loadState(SaveState::SPU::Duty const &dstate, unsigned nr1, unsigned nr4, unsigned long cc);
+	void saveState(SaveState::SPU::Duty &dstate, cycle_t cc);
+	void loadState(SaveState::SPU::Duty const &dstate, unsigned nr1, unsigned nr4, cycle_t cc);
 	void killCounter();
-	void reviveCounter(unsigned long cc);
+	void reviveCounter(cycle_t cc);
 
 	//intended for use by SweepUnit only.
 	unsigned freq() const { return 2048 - (period_ >> 1); }
-	void setFreq(unsigned newFreq, unsigned long cc);
+	void setFreq(unsigned newFreq, cycle_t cc);
 
 private:
-	unsigned long nextPosUpdate_;
+	cycle_t nextPosUpdate_;
 	unsigned short period_;
 	unsigned char pos_;
 	unsigned char duty_;
@@ -55,7 +54,7 @@ private:
 
 	void setCounter();
 	void setDuty(unsigned nr1);
-	void updatePos(unsigned long cc);
+	void updatePos(cycle_t cc);
 };
 
 class DutyMasterDisabler : public MasterDisabler {
@@ -31,7 +31,7 @@ EnvelopeUnit::EnvelopeUnit(VolOnOffEvent &volOnOffEvent)
 }
 
 void EnvelopeUnit::reset() {
-	counter_ = counter_disabled;
+	counter_ = disabled_time;
 }
 
 void EnvelopeUnit::saveState(SaveState::SPU::Env &estate) const {
@@ -39,7 +39,7 @@ void EnvelopeUnit::saveState(SaveState::SPU::Env &estate) const {
 	estate.volume = volume_;
 }
 
-void EnvelopeUnit::loadState(SaveState::SPU::Env const &estate, unsigned nr2, unsigned long cc) {
+void EnvelopeUnit::loadState(SaveState::SPU::Env const &estate, unsigned nr2, cycle_t cc) {
 	counter_ = std::max(estate.counter, cc);
 	volume_ = estate.volume;
 	nr2_ = nr2;
@@ -62,13 +62,13 @@ void EnvelopeUnit::event() {
 
 			counter_ += period << 15;
 		} else
-			counter_ = counter_disabled;
+			counter_ = disabled_time;
 	} else
 		counter_ += 8ul << 15;
 }
 
 bool EnvelopeUnit::nr2Change(unsigned const newNr2) {
-	if (!(nr2_ & 7) && counter_ != counter_disabled)
+	if (!(nr2_ & 7) && counter_ != disabled_time)
 		++volume_;
 	else if (!(nr2_ & 8))
 		volume_ += 2;
@@ -81,7 +81,7 @@ bool EnvelopeUnit::nr2Change(unsigned const newNr2) {
 	return !(newNr2 & 0xF8);
 }
 
-bool EnvelopeUnit::nr4Init(unsigned long const cc) {
+bool EnvelopeUnit::nr4Init(cycle_t const cc) {
 	unsigned long period = (nr2_ & 7) ? nr2_ & 7 : 8;
 
 	if (((cc + 2) & 0x7000) == 0x0000)
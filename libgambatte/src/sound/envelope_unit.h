@@ -28,7 +28,7 @@ class EnvelopeUnit : public SoundUnit {
 public:
 	struct VolOnOffEvent {
 		virtual ~VolOnOffEvent() {}
-		virtual void operator()(unsigned long /*cc*/) {}
+		virtual void operator()(cycle_t /*cc*/) {}
 	};
 
 	explicit EnvelopeUnit(VolOnOffEvent &volOnOffEvent = nullEvent_);
@@ -36,10 +36,10 @@ public:
 	bool dacIsOn() const { return nr2_ & 0xF8; }
 	unsigned getVolume() const { return volume_; }
 	bool nr2Change(unsigned newNr2);
-	bool nr4Init(unsigned long cycleCounter);
+	bool nr4Init(cycle_t cycleCounter);
 	void reset();
 	void saveState(SaveState::SPU::Env &estate) const;
-	void loadState(SaveState::SPU::Env const &estate, unsigned nr2, unsigned long cc);
+	void loadState(SaveState::SPU::Env const &estate, unsigned nr2, cycle_t cc);
 
 private:
 	static VolOnOffEvent nullEvent_;
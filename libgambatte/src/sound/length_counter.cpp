@@ -31,20 +31,20 @@ LengthCounter::LengthCounter(MasterDisabler &disabler, unsigned const mask)
 }
 
 void LengthCounter::event() {
-	counter_ = counter_disabled;
+	counter_ = disabled_time;
 	lengthCounter_ = 0;
 	disableMaster_();
 }
 
-void LengthCounter::nr1Change(unsigned const newNr1, unsigned const nr4, unsigned long const cc) {
+void LengthCounter::nr1Change(unsigned const newNr1, unsigned const nr4, cycle_t const cc) {
 	lengthCounter_ = (~newNr1 & lengthMask_) + 1;
 	counter_ = (nr4 & 0x40)
 	         ? ((cc >> 13) + lengthCounter_) << 13
-	         : static_cast<unsigned long>(counter_disabled);
+	         : disabled_time;
 }
 
-void LengthCounter::nr4Change(unsigned const oldNr4, unsigned const newNr4, unsigned long const cc) {
-	if (counter_ != counter_disabled)
+void LengthCounter::nr4Change(unsigned const oldNr4, unsigned const newNr4, cycle_t const cc) {
+	if (counter_ != disabled_time)
 		lengthCounter_ = (counter_ >> 13) - (cc >> 13);
 
 	{
@@ -66,7 +66,7 @@ void LengthCounter::nr4Change(unsigned const oldNr4, unsigned const newNr4, unsi
 	if ((newNr4 & 0x40) && lengthCounter_)
 		counter_ = ((cc >> 13) + lengthCounter_) << 13;
 	else
-		counter_ = counter_disabled;
+		counter_ = disabled_time;
 }
 
 void LengthCounter::saveState(SaveState::SPU::LCounter &lstate) const {
@@ -74,7 +74,7 @@ void LengthCounter::saveState(SaveState::SPU::LCounter &lstate) const {
 	lstate.lengthCounter = lengthCounter_;
 }
 
-void LengthCounter::loadState(SaveState::SPU::LCounter const &lstate, unsigned long const cc) {
+void LengthCounter::loadState(SaveState::SPU::LCounter const &lstate, cycle_t const cc) {
 	counter_ = std::max(lstate.counter, cc);
 	lengthCounter_ = lstate.lengthCounter;
 }
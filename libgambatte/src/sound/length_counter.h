@@ -30,10 +30,10 @@ class LengthCounter : public SoundUnit {
 public:
 	LengthCounter(MasterDisabler &disabler, unsigned lengthMask);
 	virtual void event();
-	void nr1Change(unsigned newNr1, unsigned nr4, unsigned long cc);
-	void nr4Change(unsigned oldNr4, unsigned newNr4, unsigned long cc);
+	void nr1Change(unsigned newNr1, unsigned nr4, cycle_t cc);
+	void nr4Change(unsigned oldNr4, unsigned newNr4, cycle_t cc);
 	void saveState(SaveState::SPU::LCounter &lstate) const;
-	void loadState(SaveState::SPU::LCounter const &lstate, unsigned long cc);
+	void loadState(SaveState::SPU::LCounter const &lstate, cycle_t cc);
 
 private:
 	MasterDisabler &disableMaster_;
@@ -19,25 +19,20 @@
 #ifndef SOUND_UNIT_H
 #define SOUND_UNIT_H
 
+#include "counterdef.h"
+
 namespace gambatte {
 
 class SoundUnit {
 public:
-	enum { counter_max = 0x80000000u, counter_disabled = 0xFFFFFFFFu };
-
 	virtual ~SoundUnit() {}
 	virtual void event() = 0;
 
-	virtual void resetCounters(unsigned long /*oldCc*/) {
-		if (counter_ != counter_disabled)
-			counter_ -= counter_max;
-	}
-
-	unsigned long counter() const { return counter_; }
+	cycle_t counter() const { return counter_; }
 
 protected:
-	SoundUnit() : counter_(counter_disabled) {}
-	unsigned long counter_;
+	SoundUnit() : counter_(disabled_time) {}
+	cycle_t counter_;
 };
 
 }
@@ -27,7 +27,7 @@ template<class Channel, class Unit>
 class StaticOutputTester : public EnvelopeUnit::VolOnOffEvent {
 public:
 	StaticOutputTester(Channel const &ch, Unit &unit) : ch_(ch), unit_(unit) {}
-	void operator()(unsigned long cc);
+	void operator()(cycle_t cc);
 
 private:
 	Channel const &ch_;
@@ -35,7 +35,7 @@ private:
 };
 
 template<class Channel, class Unit>
-void StaticOutputTester<Channel, Unit>::operator()(unsigned long cc) {
+void StaticOutputTester<Channel, Unit>::operator()(cycle_t cc) {
 	if (ch_.soMask_ && ch_.master_ && ch_.envelopeUnit_.getVolume())
 		unit_.reviveCounter(cc);
 	else
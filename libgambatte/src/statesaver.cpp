@@ -164,6 +164,14 @@ static void write(omemstream &file, const unsigned long data) {
 	put32(file, data);
 }
 
+static void writeTime(omemstream &file, const cycle_t data) {
+	static const char inf[] = { 0x00, 0x00, 0x08 };
+	
+	file.write(inf, sizeof(inf));
+	put32(file, data >> 32 & 0xFFFFFFFF);
+	put32(file, data & 0xFFFFFFFF);
+}
+
 static inline void write(omemstream &file, const bool data) {
 	write(file, static_cast<unsigned char>(data));
 }
@@ -224,6 +232,24 @@ static inline void read(imemstream &file, bool &data) {
 	data = read(file);
 }
 
+static void readTime(imemstream &file, cycle_t &data) {
+	unsigned long size = get24(file);
+	
+	if (size > 8) {
+		file.ignore(size - 8);
+		size = 8;
+	}
+	
+	data = 0;
+	
+	for (unsigned long i = 0; i < size; ++i)
+		data = data << 8 | (file.get() & 0xFF);
+	
+	// states from before the 64-bit timebase store times in 4 bytes
+	if (size == 4 && data == 0xFFFFFFFF)
+		data = disabled_time;
+}
+
 static void read(imemstream &file, unsigned char *data, unsigned long sz) {
 	const unsigned long size = get24(file);
 	
@@ -255,10 +281,16 @@ static void read(imemstream &file, bool *data, unsigned long sz) {
 
 namespace gambatte {
 
+struct StateBlock {
+	unsigned char *data;
+	std::size_t size;
+};
+
 class SaverList {
 public:
 	typedef std::vector<Saver> list_t;
 	typedef list_t::const_iterator const_iterator;
+	enum { num_blocks = 9 };
 	
 private:
 	list_t list;
@@ -269,8 +301,39 @@ public:
 	const_iterator begin() const { return list.begin(); }
 	const_iterator end() const { return list.end(); }
 	unsigned maxLabelsize() const { return maxLabelsize_; }
+	static void getBlocks(SaveState const &state, StateBlock blocks[num_blocks]);
+	static void copyPtrs(SaveState &dst, SaveState const &src);
 };
 
+void SaverList::getBlocks(SaveState const &state, StateBlock blocks[num_blocks]) {
+	StateBlock const b[num_blocks] = {
+		{ state.mem.vram.ptr, state.mem.vram.size() },
+		{ state.mem.sram.ptr, state.mem.sram.size() },
+		{ state.mem.wram.ptr, state.mem.wram.size() },
+		{ state.mem.ioamhram.ptr, state.mem.ioamhram.size() },
+		{ state.ppu.bgpData.ptr, state.ppu.bgpData.size() },
+		{ state.ppu.objpData.ptr, state.ppu.objpData.size() },
+		{ state.ppu.oamReaderBuf.ptr, state.ppu.oamReaderBuf.size() },
+		{ reinterpret_cast<unsigned char *>(state.ppu.oamReaderSzbuf.ptr),
+		  state.ppu.oamReaderSzbuf.size() * sizeof(bool) },
+		{ state.spu.ch3.waveRam.ptr, state.spu.ch3.waveRam.size() }
+	};
+	
+	std::copy(b, b + num_blocks, blocks);
+}
+
+void SaverList::copyPtrs(SaveState &dst, SaveState const &src) {
+	dst.mem.vram = src.mem.vram;
+	dst.mem.sram = src.mem.sram;
+	dst.mem.wram = src.mem.wram;
+	dst.mem.ioamhram = src.mem.ioamhram;
+	dst.ppu.bgpData = src.ppu.bgpData;
+	dst.ppu.objpData = src.ppu.objpData;
+	dst.ppu.oamReaderBuf = src.ppu.oamReaderBuf;
+	dst.ppu.oamReaderSzbuf = src.ppu.oamReaderSzbuf;
+	dst.spu.ch3.waveRam = src.spu.ch3.waveRam;
+}
+
 static void pushSaver(SaverList::list_t &list, const char *label,
 		void (*save)(omemstream &file, const SaveState &state),
 		void (*load)(imemstream &file, SaveState &state), unsigned labelsize) {
@@ -288,6 +351,15 @@ SaverList::SaverList() {
 	pushSaver(list, label, Func::save, Func::load, sizeof label); \
 } while (0)
 
+#define ADDTIME(arg) do { \
+	struct Func { \
+		static void save(omemstream &file, const SaveState &state) { writeTime(file, state.arg); } \
+		static void load(imemstream &file, SaveState &state) { readTime(file, state.arg); } \
+	}; \
+	\
+	pushSaver(list, label, Func::save, Func::load, sizeof label); \
+} while (0)
+
 #define ADDPTR(arg) do { \
 	struct Func { \
 		static void save(omemstream &file, const SaveState &state) { write(file, state.arg.get(), state.arg.size()); } \
@@ -306,7 +378,7 @@ SaverList::SaverList() {
 	pushSaver(list, label, Func::save, Func::load, sizeof label); \
 } while (0)
 	
-	{ static const char label[] = { c,c,           NUL }; ADD(cpu.cycleCounter); }
+	{ static const char label[] = { c,c,           NUL }; ADDTIME(cpu.cycleCounter); }
 	{ static const char label[] = { p,c,           NUL }; ADD(cpu.pc); }
 	{ static const char label[] = { s,p,           NUL }; ADD(cpu.sp); }
 	{ static const char label[] = { a,             NUL }; ADD(cpu.a); }
@@ -323,13 +395,13 @@ SaverList::SaverList() {
 	{ static const char label[] = { s,r,a,m,       NUL }; ADDPTR(mem.sram); }
 	{ static const char label[] = { w,r,a,m,       NUL }; ADDPTR(mem.wram); }
 	{ static const char label[] = { h,r,a,m,       NUL }; ADDPTR(mem.ioamhram); }
-	{ static const char label[] = { l,d,i,v,u,p,   NUL }; ADD(mem.divLastUpdate); }
-	{ static const char label[] = { l,t,i,m,a,u,p, NUL }; ADD(mem.timaLastUpdate); }
-	{ static const char label[] = { t,m,a,t,i,m,e, NUL }; ADD(mem.tmatime); }
-	{ static const char label[] = { s,e,r,i,a,l,t, NUL }; ADD(mem.nextSerialtime); }
-	{ static const char label[] = { l,o,d,m,a,u,p, NUL }; ADD(mem.lastOamDmaUpdate); }
-	{ static const char label[] = { m,i,n,i,n,t,t, NUL }; ADD(mem.minIntTime); }
-	{ static const char label[] = { u,n,h,a,l,t,t, NUL }; ADD(mem.unhaltTime); }
+	{ static const char label[] = { l,d,i,v,u,p,   NUL }; ADDTIME(mem.divLastUpdate); }
+	{ static const char label[] = { l,t,i,m,a,u,p, NUL }; ADDTIME(mem.timaLastUpdate); }
+	{ static const char label[] = { t,m,a,t,i,m,e, NUL }; ADDTIME(mem.tmatime); }
+	{ static const char label[] = { s,e,r,i,a,l,t, NUL }; ADDTIME(mem.nextSerialtime); }
+	{ static const char label[] = { l,o,d,m,a,u,p, NUL }; ADDTIME(mem.lastOamDmaUpdate); }
+	{ static const char label[] = { m,i,n,i,n,t,t, NUL }; ADDTIME(mem.minIntTime); }
+	{ static const char label[] = { u,n,h,a,l,t,t, NUL }; ADDTIME(mem.unhaltTime); }
 	{ static const char label[] = { r,o,m,b,a,n,k, NUL }; ADD(mem.rombank); }
 	{ static const char label[] = { d,m,a,s,r,c,   NUL }; ADD(mem.dmaSource); }
 	{ static const char label[] = { d,m,a,d,s,t,   NUL }; ADD(mem.dmaDestination); }
@@ -347,7 +419,7 @@ SaverList::SaverList() {
 	{ static const char label[] = { s,p,b,y,t,e,NO0, NUL }; ADDARRAY(ppu.spByte0List); }
 	{ static const char label[] = { s,p,b,y,t,e,NO1, NUL }; ADDARRAY(ppu.spByte1List); }
 	{ static const char label[] = { v,c,y,c,l,e,s, NUL }; ADD(ppu.videoCycles); }
-	{ static const char label[] = { e,d,M,NO0,t,i,m, NUL }; ADD(ppu.enableDisplayM0Time); }
+	{ static const char label[] = { e,d,M,NO0,t,i,m, NUL }; ADDTIME(ppu.enableDisplayM0Time); }
 	{ static const char label[] = { m,NO0,t,i,m,e, NUL }; ADD(ppu.lastM0Time); }
 	{ static const char label[] = { n,m,NO0,i,r,q, NUL }; ADD(ppu.nextM0Irq); }
 	{ static const char label[] = { b,g,t,w,       NUL }; ADD(ppu.tileword); }
@@ -369,44 +441,46 @@ SaverList::SaverList() {
 	{ static const char label[] = { w,s,c,x,       NUL }; ADD(ppu.wscx); }
 	{ static const char label[] = { w,e,m,a,s,t,r, NUL }; ADD(ppu.weMaster); }
 	{ static const char label[] = { l,c,d,s,i,r,q, NUL }; ADD(ppu.pendingLcdstatIrq); }
-	{ static const char label[] = { s,p,u,c,n,t,r, NUL }; ADD(spu.cycleCounter); }
-	{ static const char label[] = { s,w,p,c,n,t,r, NUL }; ADD(spu.ch1.sweep.counter); }
+	{ static const char label[] = { s,p,u,c,n,t,r, NUL }; ADDTIME(spu.cycleCounter); }
+	{ static const char label[] = { s,w,p,c,n,t,r, NUL }; ADDTIME(spu.ch1.sweep.counter); }
 	{ static const char label[] = { s,w,p,s,h,d,w, NUL }; ADD(spu.ch1.sweep.shadow); }
 	{ static const char label[] = { s,w,p,n,e,g,   NUL }; ADD(spu.ch1.sweep.negging); }
-	{ static const char label[] = { d,u,t,NO1,c,t,r, NUL }; ADD(spu.ch1.duty.nextPosUpdate); }
+	{ static const char label[] = { d,u,t,NO1,c,t,r, NUL }; ADDTIME(spu.ch1.duty.nextPosUpdate); }
 	{ static const char label[] = { d,u,t,NO1,p,o,s, NUL }; ADD(spu.ch1.duty.pos); }
-	{ static const char label[] = { e,n,v,NO1,c,t,r, NUL }; ADD(spu.ch1.env.counter); }
+	{ static const char label[] = { d,u,t,NO1,h,i,  NUL }; ADD(spu.ch1.duty.high); }
+	{ static const char label[] = { e,n,v,NO1,c,t,r, NUL }; ADDTIME(spu.ch1.env.counter); }
 	{ static const char label[] = { e,n,v,NO1,v,o,l, NUL }; ADD(spu.ch1.env.volume); }
-	{ static const char label[] = { l,e,n,NO1,c,t,r, NUL }; ADD(spu.ch1.lcounter.counter); }
+	{ static const char label[] = { l,e,n,NO1,c,t,r, NUL }; ADDTIME(spu.ch1.lcounter.counter); }
 	{ static const char label[] = { l,e,n,NO1,v,a,l, NUL }; ADD(spu.ch1.lcounter.lengthCounter); }
 	{ static const char label[] = { n,r,NO1,NO0,       NUL }; ADD(spu.ch1.sweep.nr0); }
 	{ static const char label[] = { n,r,NO1,NO3,       NUL }; ADD(spu.ch1.duty.nr3); }
 	{ static const char label[] = { n,r,NO1,NO4,       NUL }; ADD(spu.ch1.nr4); }
 	{ static const char label[] = { c,NO1,m,a,s,t,r, NUL }; ADD(spu.ch1.master); }
-	{ static const char label[] = { d,u,t,NO2,c,t,r, NUL }; ADD(spu.ch2.duty.nextPosUpdate); }
+	{ static const char label[] = { d,u,t,NO2,c,t,r, NUL }; ADDTIME(spu.ch2.duty.nextPosUpdate); }
 	{ static const char label[] = { d,u,t,NO2,p,o,s, NUL }; ADD(spu.ch2.duty.pos); }
-	{ static const char label[] = { e,n,v,NO2,c,t,r, NUL }; ADD(spu.ch2.env.counter); }
+	{ static const char label[] = { d,u,t,NO2,h,i,  NUL }; ADD(spu.ch2.duty.high); }
+	{ static const char label[] = { e,n,v,NO2,c,t,r, NUL }; ADDTIME(spu.ch2.env.counter); }
 	{ static const char label[] = { e,n,v,NO2,v,o,l, NUL }; ADD(spu.ch2.env.volume); }
-	{ static const char label[] = { l,e,n,NO2,c,t,r, NUL }; ADD(spu.ch2.lcounter.counter); }
+	{ static const char label[] = { l,e,n,NO2,c,t,r, NUL }; ADDTIME(spu.ch2.lcounter.counter); }
 	{ static const char label[] = { l,e,n,NO2,v,a,l, NUL }; ADD(spu.ch2.lcounter.lengthCounter); }
 	{ static const char label[] = { n,r,NO2,NO3,       NUL }; ADD(spu.ch2.duty.nr3); }
 	{ static const char label[] = { n,r,NO2,NO4,       NUL }; ADD(spu.ch2.nr4); }
 	{ static const char label[] = { c,NO2,m,a,s,t,r, NUL }; ADD(spu.ch2.master); }
 	{ static const char label[] = { w,a,v,e,r,a,m, NUL }; ADDPTR(spu.ch3.waveRam); }
-	{ static const char label[] = { l,e,n,NO3,c,t,r, NUL }; ADD(spu.ch3.lcounter.counter); }
+	{ static const char label[] = { l,e,n,NO3,c,t,r, NUL }; ADDTIME(spu.ch3.lcounter.counter); }
 	{ static const char label[] = { l,e,n,NO3,v,a,l, NUL }; ADD(spu.ch3.lcounter.lengthCounter); }
-	{ static const char label[] = { w,a,v,e,c,t,r, NUL }; ADD(spu.ch3.waveCounter); }
-	{ static const char label[] = { l,w,a,v,r,d,t, NUL }; ADD(spu.ch3.lastReadTime); }
+	{ static const char label[] = { w,a,v,e,c,t,r, NUL }; ADDTIME(spu.ch3.waveCounter); }
+	{ static const char label[] = { l,w,a,v,r,d,t, NUL }; ADDTIME(spu.ch3.lastReadTime); }
 	{ static const char label[] = { w,a,v,e,p,o,s, NUL }; ADD(spu.ch3.wavePos); }
 	{ static const char label[] = { w,a,v,s,m,p,l, NUL }; ADD(spu.ch3.sampleBuf); }
 	{ static const char label[] = { n,r,NO3,NO3,       NUL }; ADD(spu.ch3.nr3); }
 	{ static const char label[] = { n,r,NO3,NO4,       NUL }; ADD(spu.ch3.nr4); }
 	{ static const char label[] = { c,NO3,m,a,s,t,r, NUL }; ADD(spu.ch3.master); }
-	{ static const char label[] = { l,f,s,r,c,t,r, NUL }; ADD(spu.ch4.lfsr.counter); }
+	{ static const char label[] = { l,f,s,r,c,t,r, NUL }; ADDTIME(spu.ch4.lfsr.counter); }
 	{ static const char label[] = { l,f,s,r,r,e,g, NUL }; ADD(spu.ch4.lfsr.reg); }
-	{ static const char label[] = { e,n,v,NO4,c,t,r, NUL }; ADD(spu.ch4.env.counter); }
+	{ static const char label[] = { e,n,v,NO4,c,t,r, NUL }; ADDTIME(spu.ch4.env.counter); }
 	{ static const char label[] = { e,n,v,NO4,v,o,l, NUL }; ADD(spu.ch4.env.volume); }
-	{ static const char label[] = { l,e,n,NO4,c,t,r, NUL }; ADD(spu.ch4.lcounter.counter); }
+	{ static const char label[] = { l,e,n,NO4,c,t,r, NUL }; ADDTIME(spu.ch4.lcounter.counter); }
 	{ static const char label[] = { l,e,n,NO4,v,a,l, NUL }; ADD(spu.ch4.lcounter.lengthCounter); }
 	{ static const char label[] = { n,r,NO4,NO4,       NUL }; ADD(spu.ch4.nr4); }
 	{ static const char label[] = { c,NO4,m,a,s,t,r, NUL }; ADD(spu.ch4.master); }
@@ -418,8 +492,13 @@ SaverList::SaverList() {
 	{ static const char label[] = { r,t,c,m,       NUL }; ADD(rtc.dataM); }
 	{ static const char label[] = { r,t,c,s,       NUL }; ADD(rtc.dataS); }
 	{ static const char label[] = { r,t,c,l,l,d,   NUL }; ADD(rtc.lastLatchData); }
+	{ static const char label[] = { r,t,c,t,i,c,k, NUL }; ADDTIME(rtc.ticks); }
+	{ static const char label[] = { r,t,c,t,u,p,   NUL }; ADDTIME(rtc.ticksUpdated); }
+	{ static const char label[] = { r,t,c,e,m,u,   NUL }; ADD(rtc.emulatedTime); }
+	{ static const char label[] = { r,t,c,e,p,c,   NUL }; ADDTIME(rtc.epoch); }
 	
 #undef ADD
+#undef ADDTIME
 #undef ADDPTR
 #undef ADDARRAY
 
@@ -444,6 +523,70 @@ static void writeSnapShot(omemstream &file) {
 
 static SaverList list;
 
+// Fixed-layout format: header, raw SaveState image, then the Ptr blocks in
+// getBlocks order. Only valid between builds sharing the SaveState layout,
+// which the header records so that mismatches are rejected rather than misread.
+struct FastStateHeader {
+	unsigned char magic[4];
+	uint32_t version;
+	uint32_t imageSize;
+	uint32_t blockSize[SaverList::num_blocks];
+};
+
+static const unsigned char fastStateMagic[4] = { G, B, F, S };
+enum { fast_state_version = 5 };
+
+static void makeFastStateHeader(FastStateHeader &header, StateBlock const *blocks) {
+	std::memcpy(header.magic, fastStateMagic, sizeof header.magic);
+	header.version = fast_state_version;
+	header.imageSize = sizeof(SaveState);
+	
+	for (int i = 0; i < SaverList::num_blocks; ++i)
+		header.blockSize[i] = blocks[i].size;
+}
+
+// Deltas list runs of changed pages as (pages to skip, pages to copy, page data).
+struct StateDeltaHeader {
+	unsigned char magic[4];
+	uint32_t version;
+	uint32_t stateSize;
+	uint32_t payloadSize;
+};
+
+static const unsigned char stateDeltaMagic[4] = { G, B, S, D };
+enum { state_delta_version = 1 };
+enum { delta_page_size = 64 };
+enum { max_varint_size = 5 };
+
+static unsigned char * putVarint(unsigned char *out, uint32_t n) {
+	while (n >= 0x80) {
+		*out++ = (n & 0x7F) | 0x80;
+		n >>= 7;
+	}
+	
+	*out++ = n;
+	return out;
+}
+
+static bool getVarint(unsigned char const *&in, unsigned char const *end, std::size_t &n) {
+	n = 0;
+	
+	for (int shift = 0; in != end && shift < 7 * max_varint_size; shift += 7) {
+		unsigned const b = *in++;
+		n |= static_cast<std::size_t>(b & 0x7F) << shift;
+		
+		if (!(b & 0x80))
+			return true;
+	}
+	
+	return false;
+}
+
+static bool pageDiffers(unsigned char const *a, unsigned char const *b, std::size_t page, std::size_t size) {
+	std::size_t const pos = page * delta_page_size;
+	return std::memcmp(a + pos, b + pos, std::min<std::size_t>(delta_page_size, size - pos)) != 0;
+}
+
 } // anon namespace
 
 namespace gambatte {
@@ -465,6 +608,9 @@ void StateSaver::saveState(const SaveState &state, void *data) {
 }
 
 bool StateSaver::loadState(SaveState &state, const void *data) {
+   if (isFastState(data))
+      return loadStateFast(state, data);
+
    imemstream file(data);
 
    if (file.fail() || file.get() != 0)
@@ -490,15 +636,15 @@ bool StateSaver::loadState(SaveState &state, const void *data) {
             file.ignore(get24(file));
             continue;
          }
+
+         // labels are saved in order, so an older state lacks the ones skipped
+         done = it + 1;
       } else
          ++done;
 
       (*it->load)(file, state);
    }
 
-   state.cpu.cycleCounter &= 0x7FFFFFFF;
-   state.spu.cycleCounter &= 0x7FFFFFFF;
-
    return true;
 }
 
@@ -520,5 +666,152 @@ size_t StateSaver::stateSize(const SaveState &state) {
    return file.size();
 }
 
+void StateSaver::saveStateFast(const SaveState &state, void *data) {
+	StateBlock blocks[SaverList::num_blocks];
+	SaverList::getBlocks(state, blocks);
+	
+	FastStateHeader header;
+	makeFastStateHeader(header, blocks);
+	
+	unsigned char *out = static_cast<unsigned char *>(data);
+	std::memcpy(out, &header, sizeof header);
+	out += sizeof header;
+	std::memcpy(out, static_cast<void const *>(&state), sizeof state);
+	out += sizeof state;
+	
+	for (int i = 0; i < SaverList::num_blocks; ++i) {
+		std::memcpy(out, blocks[i].data, blocks[i].size);
+		out += blocks[i].size;
+	}
+}
+
+bool StateSaver::loadStateFast(SaveState &state, const void *data) {
+	StateBlock blocks[SaverList::num_blocks];
+	SaverList::getBlocks(state, blocks);
+	
+	FastStateHeader expected;
+	makeFastStateHeader(expected, blocks);
+	
+	unsigned char const *in = static_cast<unsigned char const *>(data);
+	
+	if (std::memcmp(in, &expected, sizeof expected))
+		return false;
+	
+	in += sizeof expected;
+	
+	SaveState const ptrs = state;
+	std::memcpy(static_cast<void *>(&state), in, sizeof state);
+	SaverList::copyPtrs(state, ptrs);
+	in += sizeof state;
+	
+	for (int i = 0; i < SaverList::num_blocks; ++i) {
+		std::memcpy(blocks[i].data, in, blocks[i].size);
+		in += blocks[i].size;
+	}
+	
+	return true;
+}
+
+size_t StateSaver::stateSizeFast(const SaveState &state) {
+	StateBlock blocks[SaverList::num_blocks];
+	SaverList::getBlocks(state, blocks);
+	
+	size_t size = sizeof(FastStateHeader) + sizeof(SaveState);
+	
+	for (int i = 0; i < SaverList::num_blocks; ++i)
+		size += blocks[i].size;
+	
+	return size;
+}
+
+bool StateSaver::isFastState(const void *data) {
+	return !std::memcmp(data, fastStateMagic, sizeof fastStateMagic);
+}
+
+size_t StateSaver::saveStateDelta(const void *baseline, const void *state, size_t size, void *out) {
+	unsigned char const *const base = static_cast<unsigned char const *>(baseline);
+	unsigned char const *const cur = static_cast<unsigned char const *>(state);
+	unsigned char *const payload = static_cast<unsigned char *>(out) + sizeof(StateDeltaHeader);
+	unsigned char *dst = payload;
+	std::size_t const numPages = (size + delta_page_size - 1) / delta_page_size;
+	std::size_t page = 0;
+	std::size_t runEnd = 0;
+	
+	while (page < numPages) {
+		if (!pageDiffers(base, cur, page, size)) {
+			++page;
+			continue;
+		}
+		
+		std::size_t const first = page;
+		
+		while (page < numPages && pageDiffers(base, cur, page, size))
+			++page;
+		
+		std::size_t const begin = first * delta_page_size;
+		std::size_t const end = std::min<std::size_t>(page * delta_page_size, size);
+		dst = putVarint(dst, first - runEnd);
+		dst = putVarint(dst, page - first);
+		std::memcpy(dst, cur + begin, end - begin);
+		dst += end - begin;
+		runEnd = page;
+	}
+	
+	StateDeltaHeader header;
+	std::memcpy(header.magic, stateDeltaMagic, sizeof header.magic);
+	header.version = state_delta_version;
+	header.stateSize = size;
+	header.payloadSize = dst - payload;
+	std::memcpy(out, &header, sizeof header);
+	
+	return sizeof header + header.payloadSize;
+}
+
+bool StateSaver::applyStateDelta(void *state, size_t size, const void *delta) {
+	StateDeltaHeader header;
+	std::memcpy(&header, delta, sizeof header);
+	
+	if (std::memcmp(header.magic, stateDeltaMagic, sizeof header.magic)
+			|| header.version != state_delta_version
+			|| header.stateSize != size) {
+		return false;
+	}
+	
+	unsigned char *const dst = static_cast<unsigned char *>(state);
+	unsigned char const *in = static_cast<unsigned char const *>(delta) + sizeof header;
+	unsigned char const *const end = in + header.payloadSize;
+	std::size_t const numPages = (size + delta_page_size - 1) / delta_page_size;
+	std::size_t page = 0;
+	
+	while (in != end) {
+		std::size_t skip, count;
+		
+		if (!getVarint(in, end, skip) || !getVarint(in, end, count)
+				|| skip > numPages - page || count > numPages - page - skip) {
+			return false;
+		}
+		
+		page += skip;
+		
+		std::size_t const begin = page * delta_page_size;
+		std::size_t const len = std::min<std::size_t>((page + count) * delta_page_size, size) - begin;
+		
+		if (static_cast<std::size_t>(end - in) < len)
+			return false;
+		
+		std::memcpy(dst + begin, in, len);
+		in += len;
+		page += count;
+	}
+	
+	return true;
 }
 
+size_t StateSaver::stateDeltaMaxSize(size_t size) {
+	std::size_t const numPages = (size + delta_page_size - 1) / delta_page_size;
+	
+	// worst case is every other page changed
+	return sizeof(StateDeltaHeader) + size + (numPages / 2 + 1) * 2 * max_varint_size;
+}
+
+}
@@ -39,6 +39,22 @@ public:
    static void saveState(const SaveState &state, void *data);
    static bool loadState(SaveState &state, const void *data);
    static size_t stateSize(const SaveState &state);
+	
+	/** Fixed-layout native binary format. Much faster than the labeled format,
+	  * but only loadable by builds with the same SaveState layout.
+	  * loadState accepts either format.
+	  */
+	static void saveStateFast(const SaveState &state, void *data);
+	static bool loadStateFast(SaveState &state, const void *data);
+	static size_t stateSizeFast(const SaveState &state);
+	static bool isFastState(const void *data);
+	
+	/** Page-granular difference between two fast states of 'size' bytes.
+	  * saveStateDelta returns the number of bytes written to out.
+	  */
+	static size_t saveStateDelta(const void *baseline, const void *state, size_t size, void *out);
+	static bool applyStateDelta(void *state, size_t size, const void *delta);
+	static size_t stateDeltaMaxSize(size_t size);
 };
 
 }
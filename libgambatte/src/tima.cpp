@@ -44,7 +44,7 @@ void Tima::loadState(SaveState const &state, TimaInterruptRequester timaIrq) {
 	tma_  = state.mem.ioamhram.get()[0x106];
 	tac_  = state.mem.ioamhram.get()[0x107];
 
-	unsigned long nextIrqEventTime = disabled_time;
+	cycle_t nextIrqEventTime = disabled_time;
 	if (tac_ & 4) {
 		nextIrqEventTime = tmatime_ != disabled_time && tmatime_ > state.cpu.cycleCounter
 		                 ? tmatime_
@@ -54,22 +54,8 @@ void Tima::loadState(SaveState const &state, TimaInterruptRequester timaIrq) {
 	timaIrq.setNextIrqEventTime(nextIrqEventTime);
 }
 
-void Tima::resetCc(unsigned long const oldCc, unsigned long const newCc, TimaInterruptRequester timaIrq) {
-	if (tac_ & 0x04) {
-		updateIrq(oldCc, timaIrq);
-		updateTima(oldCc);
-
-		unsigned long const dec = oldCc - newCc;
-		lastUpdate_ -= dec;
-		timaIrq.setNextIrqEventTime(timaIrq.nextIrqEventTime() - dec);
-
-		if (tmatime_ != disabled_time)
-			tmatime_ -= dec;
-	}
-}
-
-void Tima::updateTima(unsigned long const cc) {
-	unsigned long const ticks = (cc - lastUpdate_) >> timaClock[tac_ & 3];
+void Tima::updateTima(cycle_t const cc) {
+	cycle_t const ticks = (cc - lastUpdate_) >> timaClock[tac_ & 3];
 	lastUpdate_ += ticks << timaClock[tac_ & 3];
 
 	if (cc >= tmatime_) {
@@ -79,7 +65,7 @@ void Tima::updateTima(unsigned long const cc) {
 		tima_ = tma_;
 	}
 
-	unsigned long tmp = tima_ + ticks;
+	cycle_t tmp = tima_ + ticks;
 	while (tmp > 0x100)
 		tmp -= 0x100 - tma_;
 
@@ -98,7 +84,7 @@ void Tima::updateTima(unsigned long const cc) {
 	tima_ = tmp;
 }
 
-void Tima::setTima(unsigned const data, unsigned long const cc, TimaInterruptRequester timaIrq) {
+void Tima::setTima(unsigned const data, cycle_t const cc, TimaInterruptRequester timaIrq) {
 	if (tac_ & 0x04) {
 		updateIrq(cc, timaIrq);
 		updateTima(cc);
@@ -112,7 +98,7 @@ void Tima::setTima(unsigned const data, unsigned long const cc, TimaInterruptReq
 	tima_ = data;
 }
 
-void Tima::setTma(unsigned const data, unsigned long const cc, TimaInterruptRequester timaIrq) {
+void Tima::setTma(unsigned const data, cycle_t const cc, TimaInterruptRequester timaIrq) {
 	if (tac_ & 0x04) {
 		updateIrq(cc, timaIrq);
 		updateTima(cc);
@@ -121,9 +107,9 @@ void Tima::setTma(unsigned const data, unsigned long const cc, TimaInterruptRequ
 	tma_ = data;
 }
 
-void Tima::setTac(unsigned const data, unsigned long const cc, TimaInterruptRequester timaIrq) {
+void Tima::setTac(unsigned const data, cycle_t const cc, TimaInterruptRequester timaIrq) {
 	if (tac_ ^ data) {
-		unsigned long nextIrqEventTime = timaIrq.nextIrqEventTime();
+		cycle_t nextIrqEventTime = timaIrq.nextIrqEventTime();
 
 		if (tac_ & 0x04) {
 			updateIrq(cc, timaIrq);
@@ -153,7 +139,7 @@ void Tima::setTac(unsigned const data, unsigned long const cc, TimaInterruptRequ
 	tac_ = data;
 }
 
-unsigned Tima::tima(unsigned long cc) {
+unsigned Tima::tima(cycle_t cc) {
 	if (tac_ & 0x04)
 		updateTima(cc);
 
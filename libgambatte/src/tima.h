@@ -27,8 +27,8 @@ class TimaInterruptRequester {
 public:
 	explicit TimaInterruptRequester(InterruptRequester &intreq) : intreq_(intreq) {}
 	void flagIrq() const { intreq_.flagIrq(4); }
-	unsigned long nextIrqEventTime() const { return intreq_.eventTime(intevent_tima); }
-	void setNextIrqEventTime(unsigned long time) const { intreq_.setEventTime<intevent_tima>(time); }
+	cycle_t nextIrqEventTime() const { return intreq_.eventTime(intevent_tima); }
+	void setNextIrqEventTime(cycle_t time) const { intreq_.setEventTime<intevent_tima>(time); }
 
 private:
 	InterruptRequester &intreq_;
@@ -39,26 +39,25 @@ public:
 	Tima();
 	void saveState(SaveState &) const;
 	void loadState(const SaveState &, TimaInterruptRequester timaIrq);
-	void resetCc(unsigned long oldCc, unsigned long newCc, TimaInterruptRequester timaIrq);
-	void setTima(unsigned tima, unsigned long cc, TimaInterruptRequester timaIrq);
-	void setTma(unsigned tma, unsigned long cc, TimaInterruptRequester timaIrq);
-	void setTac(unsigned tac, unsigned long cc, TimaInterruptRequester timaIrq);
-	unsigned tima(unsigned long cc);
+	void setTima(unsigned tima, cycle_t cc, TimaInterruptRequester timaIrq);
+	void setTma(unsigned tma, cycle_t cc, TimaInterruptRequester timaIrq);
+	void setTac(unsigned tac, cycle_t cc, TimaInterruptRequester timaIrq);
+	unsigned tima(cycle_t cc);
 	void doIrqEvent(TimaInterruptRequester timaIrq);
 
 private:
-	unsigned long lastUpdate_;
-	unsigned long tmatime_;
+	cycle_t lastUpdate_;
+	cycle_t tmatime_;
 	unsigned char tima_;
 	unsigned char tma_;
 	unsigned char tac_;
 
-	void updateIrq(unsigned long const cc, TimaInterruptRequester timaIrq) {
+	void updateIrq(cycle_t const cc, TimaInterruptRequester timaIrq) {
 		while (cc >= timaIrq.nextIrqEventTime())
 			doIrqEvent(timaIrq);
 	}
 
-	void updateTima(unsigned long cc);
+	void updateTima(cycle_t cc);
 };
 
 }
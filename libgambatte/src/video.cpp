@@ -31,7 +31,7 @@ void LCD::reset(const unsigned char *const oamram, unsigned char const *vram, co
    refreshPalettes();
 }
 
-static unsigned long mode2IrqSchedule(const unsigned statReg, const LyCounter &lyCounter, const unsigned long cycleCounter)
+static cycle_t mode2IrqSchedule(const unsigned statReg, const LyCounter &lyCounter, const cycle_t cycleCounter)
 {
    if (!(statReg & 0x20))
       return disabled_time;
@@ -51,20 +51,20 @@ static unsigned long mode2IrqSchedule(const unsigned statReg, const LyCounter &l
    return cycleCounter + next;
 }
 
-static inline unsigned long m0IrqTimeFromXpos166Time(
-      const unsigned long xpos166Time, const bool cgb, const bool ds)
+static inline cycle_t m0IrqTimeFromXpos166Time(
+      const cycle_t xpos166Time, const bool cgb, const bool ds)
 {
    return xpos166Time + cgb - ds;
 }
 
-static inline unsigned long hdmaTimeFromM0Time(
-      const unsigned long m0Time, const bool ds)
+static inline cycle_t hdmaTimeFromM0Time(
+      const cycle_t m0Time, const bool ds)
 {
    return m0Time + 1 - ds;
 }
 
-static unsigned long nextHdmaTime(const unsigned long lastM0Time,
-      const unsigned long nextM0Time, const unsigned long cycleCounter, const bool ds)
+static cycle_t nextHdmaTime(const cycle_t lastM0Time,
+      const cycle_t nextM0Time, const cycle_t cycleCounter, const bool ds)
 {
    return cycleCounter < hdmaTimeFromM0Time(lastM0Time, ds)
       ? hdmaTimeFromM0Time(lastM0Time, ds)
@@ -105,23 +105,28 @@ void LCD::loadState(const SaveState &state, const unsigned char *const oamram)
       lycIrq_.reschedule(ppu_.lyCounter(), ppu_.now());
 
       eventTimes_.setm<ONESHOT_LCDSTATIRQ>(state.ppu.pendingLcdstatIrq
-            ? ppu_.now() + 1 : static_cast<unsigned long>(disabled_time));
+            ? ppu_.now() + 1 : disabled_time);
       eventTimes_.setm<ONESHOT_UPDATEWY2>(state.ppu.oldWy != state.mem.ioamhram.get()[0x14A]
-            ? ppu_.now() + 1 : static_cast<unsigned long>(disabled_time));
+            ? ppu_.now() + 1 : disabled_time);
       eventTimes_.set<LY_COUNT>(ppu_.lyCounter().time());
       eventTimes_.setm<SPRITE_MAP>(SpriteMapper::schedule(ppu_.lyCounter(), ppu_.now()));
       eventTimes_.setm<LYC_IRQ>(lycIrq_.time());
       eventTimes_.setm<MODE1_IRQ>(ppu_.lyCounter().nextFrameCycle(144 * 456, ppu_.now()));
       eventTimes_.setm<MODE2_IRQ>(mode2IrqSchedule(statReg_, ppu_.lyCounter(), ppu_.now()));
-      eventTimes_.setm<MODE0_IRQ>((statReg_ & 0x08) ? ppu_.now() + state.ppu.nextM0Irq : static_cast<unsigned long>(disabled_time));
+      eventTimes_.setm<MODE0_IRQ>((statReg_ & 0x08) ? ppu_.now() + state.ppu.nextM0Irq : disabled_time);
       eventTimes_.setm<HDMA_REQ>(state.mem.hdmaTransfer
             ? nextHdmaTime(ppu_.lastM0Time(), nextM0Time_.predictedNextM0Time(), ppu_.now(), isDoubleSpeed())
-            : static_cast<unsigned long>(disabled_time));
+            : disabled_time);
    }
    else
    {
       for (int i = 0; i < NUM_MEM_EVENTS; ++i)
          eventTimes_.set(static_cast<MemEvent>(i), disabled_time);
+
+      // LY does not count while the LCD is off. With LCD_FLAT_EVENTS, LY_COUNT
+      // shares the queue the interrupt requester waits on, so leaving it set
+      // would wake the CPU loop at every line of a blank screen.
+      eventTimes_.set<LY_COUNT>(disabled_time);
    }
 
    refreshPalettes();
@@ -136,48 +141,23 @@ void LCD::refreshPalettes()
    {
       for (unsigned i = 0; i < 8 * 8; i += 2)
       {
-         ppu_.bgPalette()[i >> 1] = gbcToRgb32( bgpData_[i] |  bgpData_[i + 1] << 8);
-         ppu_.spPalette()[i >> 1] = gbcToRgb32(objpData_[i] | objpData_[i + 1] << 8);
+         ppu_.setPaletteColor(                  i >> 1, gbcToColor( bgpData_[i] |  bgpData_[i + 1] << 8));
+         ppu_.setPaletteColor(sp_palette_slot + (i >> 1), gbcToColor(objpData_[i] | objpData_[i + 1] << 8));
       }
    }
    else
    {
-      setDmgPalette(ppu_.bgPalette()    , dmgColorsRgb32_    ,  bgpData_[0]);
-      setDmgPalette(ppu_.spPalette()    , dmgColorsRgb32_ + 4, objpData_[0]);
-      setDmgPalette(ppu_.spPalette() + 4, dmgColorsRgb32_ + 8, objpData_[1]);
-   }
-}
-
-void LCD::resetCc(const unsigned long oldCc, const unsigned long newCc)
-{
-   EM_ASM_INT({
-           window.resetCC($0, $1);
-         }, oldCc, newCc);
-   update(oldCc);
-   ppu_.resetCc(oldCc, newCc);
-
-   if (ppu_.lcdc() & 0x80)
-   {
-      const unsigned long dec = oldCc - newCc;
-
-      nextM0Time_.invalidatePredictedNextM0Time();
-      lycIrq_.reschedule(ppu_.lyCounter(), newCc);
-
-      for (int i = 0; i < NUM_MEM_EVENTS; ++i)
-      {
-         if (eventTimes_(static_cast<MemEvent>(i)) != disabled_time)
-            eventTimes_.set(static_cast<MemEvent>(i), eventTimes_(static_cast<MemEvent>(i)) - dec);
-      }
-
-      eventTimes_.set<LY_COUNT>(ppu_.lyCounter().time());
+      setDmgPalette(0                  , dmgColorsRgb32_    ,  bgpData_[0]);
+      setDmgPalette(sp_palette_slot    , dmgColorsRgb32_ + 4, objpData_[0]);
+      setDmgPalette(sp_palette_slot + 4, dmgColorsRgb32_ + 8, objpData_[1]);
    }
 }
 
-void LCD::speedChange(const unsigned long cycleCounter)
+void LCD::speedChange(const cycle_t cycleCounter)
 {
    EM_ASM_INT({
            window.speedChange($0);
-         }, cycleCounter);
+         }, static_cast<double>(cycleCounter));
    update(cycleCounter);
    ppu_.speedChange(cycleCounter);
 
@@ -203,13 +183,13 @@ void LCD::speedChange(const unsigned long cycleCounter)
    }
 }
 
-static inline unsigned long m0TimeOfCurrentLine(const unsigned long nextLyTime,
-      const unsigned long lastM0Time, const unsigned long nextM0Time)
+static inline cycle_t m0TimeOfCurrentLine(const cycle_t nextLyTime,
+      const cycle_t lastM0Time, const cycle_t nextM0Time)
 {
    return nextM0Time < nextLyTime ? nextM0Time : lastM0Time;
 }
 
-unsigned long LCD::m0TimeOfCurrentLine(const unsigned long cc)
+cycle_t LCD::m0TimeOfCurrentLine(const cycle_t cc)
 {
    if (cc >= nextM0Time_.predictedNextM0Time())
    {
@@ -221,7 +201,7 @@ unsigned long LCD::m0TimeOfCurrentLine(const unsigned long cc)
 }
 
 static bool isHdmaPeriod(const LyCounter &lyCounter,
-      const unsigned long m0TimeOfCurrentLy, const unsigned long cycleCounter)
+      const cycle_t m0TimeOfCurrentLy, const cycle_t cycleCounter)
 {
    const unsigned timeToNextLy = lyCounter.time() - cycleCounter;
 
@@ -229,7 +209,7 @@ static bool isHdmaPeriod(const LyCounter &lyCounter,
       && cycleCounter >= hdmaTimeFromM0Time(m0TimeOfCurrentLy, lyCounter.isDoubleSpeed());
 }
 
-void LCD::enableHdma(const unsigned long cycleCounter)
+void LCD::enableHdma(const cycle_t cycleCounter)
 {
    if (cycleCounter >= nextM0Time_.predictedNextM0Time())
    {
@@ -247,7 +227,7 @@ void LCD::enableHdma(const unsigned long cycleCounter)
    eventTimes_.setm<HDMA_REQ>(nextHdmaTime(ppu_.lastM0Time(), nextM0Time_.predictedNextM0Time(), cycleCounter, isDoubleSpeed()));
 }
 
-void LCD::disableHdma(const unsigned long cycleCounter)
+void LCD::disableHdma(const cycle_t cycleCounter)
 {
    if (cycleCounter >= eventTimes_.nextEventTime())
       update(cycleCounter);
@@ -255,7 +235,7 @@ void LCD::disableHdma(const unsigned long cycleCounter)
    eventTimes_.setm<HDMA_REQ>(disabled_time);
 }
 
-bool LCD::vramAccessible(const unsigned long cc)
+bool LCD::vramAccessible(const cycle_t cc)
 {
    if (cc >= eventTimes_.nextEventTime())
       update(cc);
@@ -265,7 +245,25 @@ bool LCD::vramAccessible(const unsigned long cc)
       || cc + isDoubleSpeed() - ppu_.cgb() + 2 >= m0TimeOfCurrentLine(cc);
 }
 
-bool LCD::cgbpAccessible(const unsigned long cc)
+bool LCD::vramIdleThrough(const cycle_t cc, const cycle_t end)
+{
+   if (cc >= eventTimes_.nextEventTime())
+      update(cc);
+
+   if (!(ppu_.lcdc() & 0x80))
+      return true;
+
+   const LyCounter &lyCounter = ppu_.lyCounter();
+
+   // line 153 is left out, the ppu may start setting up line 0 during it
+   if (lyCounter.ly() >= 144)
+      return lyCounter.ly() < 153
+         && end < lyCounter.time() + static_cast<cycle_t>(152 - lyCounter.ly()) * lyCounter.lineTime();
+
+   return cc >= m0TimeOfCurrentLine(cc) && end < lyCounter.time();
+}
+
+bool LCD::cgbpAccessible(const cycle_t cc)
 {
    if (cc >= eventTimes_.nextEventTime())
       update(cc);
@@ -275,25 +273,25 @@ bool LCD::cgbpAccessible(const unsigned long cc)
       || cc >= m0TimeOfCurrentLine(cc) + 3 - isDoubleSpeed();
 }
 
-void LCD::doCgbBgColorChange(unsigned index, const unsigned data, const unsigned long cc)
+void LCD::doCgbBgColorChange(unsigned index, const unsigned data, const cycle_t cc)
 {
    if (cgbpAccessible(cc))
    {
       update(cc);
-      doCgbColorChange(bgpData_, ppu_.bgPalette(), index, data);
+      doCgbColorChange(bgpData_, 0, index, data);
    }
 }
 
-void LCD::doCgbSpColorChange(unsigned index, const unsigned data, const unsigned long cc)
+void LCD::doCgbSpColorChange(unsigned index, const unsigned data, const cycle_t cc)
 {
    if (cgbpAccessible(cc))
    {
       update(cc);
-      doCgbColorChange(objpData_, ppu_.spPalette(), index, data);
+      doCgbColorChange(objpData_, sp_palette_slot, index, data);
    }
 }
 
-bool LCD::oamReadable(const unsigned long cc)
+bool LCD::oamReadable(const cycle_t cc)
 {
    if (!(ppu_.lcdc() & 0x80) || ppu_.inactivePeriodAfterDisplayEnable(cc))
       return true;
@@ -307,7 +305,7 @@ bool LCD::oamReadable(const unsigned long cc)
    return ppu_.lyCounter().ly() >= 144 || cc + isDoubleSpeed() - ppu_.cgb() + 2 >= m0TimeOfCurrentLine(cc);
 }
 
-bool LCD::oamWritable(const unsigned long cc)
+bool LCD::oamWritable(const cycle_t cc)
 {
    if (!(ppu_.lcdc() & 0x80) || ppu_.inactivePeriodAfterDisplayEnable(cc))
       return true;
@@ -337,14 +335,14 @@ void LCD::mode3CyclesChange()
    }
 }
 
-void LCD::wxChange(const unsigned newValue, const unsigned long cycleCounter)
+void LCD::wxChange(const unsigned newValue, const cycle_t cycleCounter)
 {
    update(cycleCounter + isDoubleSpeed() + 1);
    ppu_.setWx(newValue);
    mode3CyclesChange();
 }
 
-void LCD::wyChange(const unsigned newValue, const unsigned long cc)
+void LCD::wyChange(const unsigned newValue, const cycle_t cc)
 {
    update(cc + 1);
    ppu_.setWy(newValue);
@@ -360,18 +358,18 @@ void LCD::wyChange(const unsigned newValue, const unsigned long cc)
    }
 }
 
-void LCD::scxChange(const unsigned newScx, const unsigned long cycleCounter) {
+void LCD::scxChange(const unsigned newScx, const cycle_t cycleCounter) {
    update(cycleCounter + ppu_.cgb() + isDoubleSpeed());
    ppu_.setScx(newScx);
    mode3CyclesChange();
 }
 
-void LCD::scyChange(const unsigned newValue, const unsigned long cycleCounter) {
+void LCD::scyChange(const unsigned newValue, const cycle_t cycleCounter) {
    update(cycleCounter + ppu_.cgb() + isDoubleSpeed());
    ppu_.setScy(newValue);
 }
 
-void LCD::oamChange(const unsigned long cc) {
+void LCD::oamChange(const cycle_t cc) {
    if (ppu_.lcdc() & 0x80) {
       update(cc);
       ppu_.oamChange(cc);
@@ -379,7 +377,7 @@ void LCD::oamChange(const unsigned long cc) {
    }
 }
 
-void LCD::oamChange(const unsigned char *const oamram, const unsigned long cc) {
+void LCD::oamChange(const unsigned char *const oamram, const cycle_t cc) {
    update(cc);
    ppu_.oamChange(oamram, cc);
 
@@ -387,7 +385,7 @@ void LCD::oamChange(const unsigned char *const oamram, const unsigned long cc) {
       eventTimes_.setm<SPRITE_MAP>(SpriteMapper::schedule(ppu_.lyCounter(), cc));
 }
 
-void LCD::lcdcChange(const unsigned data, const unsigned long cc) {
+void LCD::lcdcChange(const unsigned data, const cycle_t cc) {
    const unsigned oldLcdc = ppu_.lcdc();
    update(cc);
 
@@ -422,6 +420,9 @@ void LCD::lcdcChange(const unsigned data, const unsigned long cc) {
       {
          for (int i = 0; i < NUM_MEM_EVENTS; ++i)
             eventTimes_.set(static_cast<MemEvent>(i), disabled_time);
+
+         // as in loadState, so LCD_FLAT_EVENTS builds sleep while the LCD is off
+         eventTimes_.set<LY_COUNT>(disabled_time);
       }
    }
    else if (data & 0x80)
@@ -454,7 +455,7 @@ void LCD::lcdcChange(const unsigned data, const unsigned long cc) {
       ppu_.setLcdc(data, cc);
 }
 
-void LCD::lcdstatChange(const unsigned data, const unsigned long cc)
+void LCD::lcdstatChange(const unsigned data, const cycle_t cc)
 {
    if (cc >= eventTimes_.nextEventTime())
       update(cc);
@@ -526,7 +527,7 @@ void LCD::lcdstatChange(const unsigned data, const unsigned long cc)
    m0Irq_.statRegChange(data, eventTimes_(MODE0_IRQ), cc, ppu_.cgb());
 }
 
-void LCD::lycRegChange(const unsigned data, const unsigned long cc)
+void LCD::lycRegChange(const unsigned data, const cycle_t cc)
 {
    if (data == lycIrq_.lycReg())
       return;
@@ -576,7 +577,7 @@ void LCD::lycRegChange(const unsigned data, const unsigned long cc)
    }
 }
 
-unsigned LCD::getStat(const unsigned lycReg, const unsigned long cc)
+unsigned LCD::getStat(const unsigned lycReg, const cycle_t cc)
 {
    unsigned stat = 0;
 
@@ -627,7 +628,7 @@ inline void LCD::doMode2IrqEvent()
 
    if (!(statReg_ & 0x08))
    {
-      unsigned long nextTime = eventTimes_(MODE2_IRQ) + ppu_.lyCounter().lineTime();
+      cycle_t nextTime = eventTimes_(MODE2_IRQ) + ppu_.lyCounter().lineTime();
 
       if (ly == 0)
          nextTime -= 4;
@@ -682,7 +683,7 @@ inline void LCD::event()
 
                eventTimes_.setm<MODE0_IRQ>((statReg_ & 0x08)
                      ? m0IrqTimeFromXpos166Time(ppu_.predictedNextXposTime(166), ppu_.cgb(), isDoubleSpeed())
-                     : static_cast<unsigned long>(disabled_time));
+                     : disabled_time);
                break;
             case ONESHOT_LCDSTATIRQ:
                eventTimes_.flagIrq(2);
@@ -702,7 +703,7 @@ inline void LCD::event()
    }
 }
 
-void LCD::update(const unsigned long cycleCounter)
+void LCD::update(const cycle_t cycleCounter)
 {
    if (!(ppu_.lcdc() & 0x80))
       return;
@@ -716,4 +717,26 @@ void LCD::update(const unsigned long cycleCounter)
    ppu_.update(cycleCounter);
 }
 
+void LCD::doEvent(const cycle_t cycleCounter)
+{
+#ifdef LCD_FLAT_EVENTS
+   // Line boundaries wake the LCD too. Catching up on memory events due by
+   // cycleCounter there would flag their interrupts ahead of interrupt
+   // requester events due before or with them, so they wait for their own turn
+   // as in the two-level layout.
+   if (eventTimes_.nextEvent() == LY_COUNT)
+   {
+      while (eventTimes_.nextEvent() == LY_COUNT && cycleCounter >= eventTimes_.nextEventTime())
+      {
+         ppu_.update(eventTimes_.nextEventTime());
+         event();
+      }
+
+      return;
+   }
+#endif
+
+   update(cycleCounter);
+}
+
 }
@@ -20,10 +20,12 @@
 #define VIDEO_H
 
 #include "interruptrequester.h"
+#include "video/color_lut.h"
 #include "video/lyc_irq.h"
 #include "video/m0_irq.h"
 #include "video/next_m0_time.h"
 #include "video/ppu.h"
+#include "video/vram_viewer.h"
 #include <memory>
 
 namespace gambatte {
@@ -34,7 +36,7 @@ class VideoInterruptRequester
       explicit VideoInterruptRequester(InterruptRequester &intreq) : intreq_(intreq) {}
       void flagHdmaReq() const { gambatte::flagHdmaReq(intreq_); }
       void flagIrq(const unsigned bit) const { intreq_.flagIrq(bit); }
-      void setNextEventTime(const unsigned long time) const { intreq_.setEventTime<intevent_video>(time); }
+      void setNextEventTime(const cycle_t time) const { intreq_.setEventTime<intevent_video>(time); }
 
    private:
       InterruptRequester &intreq_;
@@ -48,63 +50,79 @@ class LCD
       void setStatePtrs(SaveState &state);
       void saveState(SaveState &state) const;
       void loadState(const SaveState &state, const unsigned char *oamram);
-      void setDmgPaletteColor(unsigned palNum, unsigned colorNum, video_pixel_t rgb32);
-      void setVideoBuffer(video_pixel_t *videoBuf, int pitch);
-
-      void dmgBgPaletteChange(const unsigned data, const unsigned long cycleCounter) {
+      void setDmgPaletteColor(unsigned palNum, unsigned colorNum, uint_least32_t rgb32);
+      void setVideoBuffer(void *videoBuf, int pitch);
+      void setPixelFormat(PixelFormat format);
+      const uint_least32_t * framePalette() const { return ppu_.framePalette(); }
+      const std::vector<PaletteChange> & paletteChanges() const { return ppu_.paletteChanges(); }
+      const unsigned char * dirtyLines() const { return ppu_.dirtyLines(); }
+      const uint64_t * lineHashes() const { return ppu_.lineHashes(); }
+      uint64_t frameHash() const { return ppu_.frameHash(); }
+
+      void dmgBgPaletteChange(const unsigned data, const cycle_t cycleCounter) {
          update(cycleCounter);
          bgpData_[0] = data;
-         setDmgPalette(ppu_.bgPalette(), dmgColorsRgb32_, data);
+         setDmgPalette(0, dmgColorsRgb32_, data);
       }
 
-      void dmgSpPalette1Change(const unsigned data, const unsigned long cycleCounter) {
+      void dmgSpPalette1Change(const unsigned data, const cycle_t cycleCounter) {
          update(cycleCounter);
          objpData_[0] = data;
-         setDmgPalette(ppu_.spPalette(), dmgColorsRgb32_ + 4, data);
+         setDmgPalette(sp_palette_slot, dmgColorsRgb32_ + 4, data);
       }
 
-      void dmgSpPalette2Change(const unsigned data, const unsigned long cycleCounter) {
+      void dmgSpPalette2Change(const unsigned data, const cycle_t cycleCounter) {
          update(cycleCounter);
          objpData_[1] = data;
-         setDmgPalette(ppu_.spPalette() + 4, dmgColorsRgb32_ + 8, data);
+         setDmgPalette(sp_palette_slot + 4, dmgColorsRgb32_ + 8, data);
       }
 
-      void cgbBgColorChange(unsigned index, const unsigned data, const unsigned long cycleCounter) {
+      void cgbBgColorChange(unsigned index, const unsigned data, const cycle_t cycleCounter) {
          if (bgpData_[index] != data)
             doCgbBgColorChange(index, data, cycleCounter);
       }
 
-      void cgbSpColorChange(unsigned index, const unsigned data, const unsigned long cycleCounter) {
+      void cgbSpColorChange(unsigned index, const unsigned data, const cycle_t cycleCounter) {
          if (objpData_[index] != data)
             doCgbSpColorChange(index, data, cycleCounter);
       }
 
-      unsigned cgbBgColorRead(const unsigned index, const unsigned long cycleCounter) {
+      unsigned cgbBgColorRead(const unsigned index, const cycle_t cycleCounter) {
          return (ppu_.cgb() & cgbpAccessible(cycleCounter)) ? bgpData_[index] : 0xFF;
       }
 
-      unsigned cgbSpColorRead(const unsigned index, const unsigned long cycleCounter) {
+      unsigned cgbSpColorRead(const unsigned index, const cycle_t cycleCounter) {
          return (ppu_.cgb() & cgbpAccessible(cycleCounter)) ? objpData_[index] : 0xFF;
       }
 
-      void updateScreen(bool blanklcd, unsigned long cc);
-      void resetCc(unsigned long oldCC, unsigned long newCc);
-      void speedChange(unsigned long cycleCounter);
-      bool vramAccessible(unsigned long cycleCounter);
-      bool oamReadable(unsigned long cycleCounter);
-      bool oamWritable(unsigned long cycleCounter);
-      void wxChange(unsigned newValue, unsigned long cycleCounter);
-      void wyChange(unsigned newValue, unsigned long cycleCounter);
-      void oamChange(unsigned long cycleCounter);
-      void oamChange(const unsigned char *oamram, unsigned long cycleCounter);
-      void scxChange(unsigned newScx, unsigned long cycleCounter);
-      void scyChange(unsigned newValue, unsigned long cycleCounter);
-
-      void vramChange(const unsigned long cycleCounter) { update(cycleCounter); }
-
-      unsigned getStat(unsigned lycReg, unsigned long cycleCounter);
-
-      unsigned getLyReg(const unsigned long cycleCounter) {
+      void updateScreen(bool blanklcd, cycle_t cc);
+      void speedChange(cycle_t cycleCounter);
+      bool vramAccessible(cycle_t cycleCounter);
+      // True if vram stays accessible and unread by the ppu from cc through end.
+      bool vramIdleThrough(cycle_t cc, cycle_t end);
+      bool oamReadable(cycle_t cycleCounter);
+      bool oamWritable(cycle_t cycleCounter);
+      void wxChange(unsigned newValue, cycle_t cycleCounter);
+      void wyChange(unsigned newValue, cycle_t cycleCounter);
+      void oamChange(cycle_t cycleCounter);
+      void oamChange(const unsigned char *oamram, cycle_t cycleCounter);
+      void scxChange(unsigned newScx, cycle_t cycleCounter);
+      void scyChange(unsigned newValue, cycle_t cycleCounter);
+
+      void vramChange(const cycle_t cycleCounter) { update(cycleCounter); }
+      // p is the VRAM byte written, bank 1 starting at 0x2000
+      void tileDataChange(const unsigned p) { ppu_.tileDataChange(p); }
+      void tileDataChange(const unsigned p, const unsigned n) { ppu_.tileDataChange(p, n); }
+      void refreshTileCache() { ppu_.refreshTileCache(); }
+      const TileCache & tileCache() const { return ppu_.tileCache(); }
+
+      void drawTileSheet(uint_least32_t *buf, std::ptrdiff_t pitch, unsigned palette);
+      void drawTileMap(uint_least32_t *buf, std::ptrdiff_t pitch, unsigned map);
+      void drawSprites(uint_least32_t *buf, std::ptrdiff_t pitch, const unsigned char *oam);
+
+      unsigned getStat(unsigned lycReg, cycle_t cycleCounter);
+
+      unsigned getLyReg(const cycle_t cycleCounter) {
          unsigned lyReg = 0;
 
          if (ppu_.lcdc() & 0x80) {
@@ -122,63 +140,100 @@ class LCD
          return lyReg;
       }
 
-      unsigned long nextMode1IrqTime() const { return eventTimes_(MODE1_IRQ); }
+      cycle_t nextMode1IrqTime() const { return eventTimes_(MODE1_IRQ); }
 
-      void lcdcChange(unsigned data, unsigned long cycleCounter);
-      void lcdstatChange(unsigned data, unsigned long cycleCounter);
-      void lycRegChange(unsigned data, unsigned long cycleCounter);
+      void lcdcChange(unsigned data, cycle_t cycleCounter);
+      void lcdstatChange(unsigned data, cycle_t cycleCounter);
+      void lycRegChange(unsigned data, cycle_t cycleCounter);
 
-      void enableHdma(unsigned long cycleCounter);
-      void disableHdma(unsigned long cycleCounter);
+      void enableHdma(cycle_t cycleCounter);
+      void disableHdma(cycle_t cycleCounter);
       bool hdmaIsEnabled() const { return eventTimes_(HDMA_REQ) != disabled_time; }
 
-      void update(unsigned long cycleCounter);
+      void update(cycle_t cycleCounter);
+      // Called when the event time the LCD gave the interrupt requester is reached.
+      void doEvent(cycle_t cycleCounter);
 
       bool isCgb() const { return ppu_.cgb(); }
       bool isDoubleSpeed() const { return ppu_.lyCounter().isDoubleSpeed(); }
 
       void setColorCorrection(bool colorCorrection);
-      video_pixel_t gbcToRgb32(const unsigned bgr15);
+      void setColorCurve(ColorCurve curve);
+      uint_least32_t gbcToRgb32(const unsigned bgr15);
    private:
       enum Event { MEM_EVENT, LY_COUNT }; enum { NUM_EVENTS = LY_COUNT + 1 };
       enum MemEvent { ONESHOT_LCDSTATIRQ, ONESHOT_UPDATEWY2, MODE1_IRQ, LYC_IRQ, SPRITE_MAP,
          HDMA_REQ, MODE2_IRQ, MODE0_IRQ }; enum { NUM_MEM_EVENTS = MODE0_IRQ + 1 };
 
+#ifdef LCD_FLAT_EVENTS
+      // One queue over the memory events and LY_COUNT instead of a queue of
+      // memory events feeding a two-entry queue. The interrupt requester sees
+      // the overall minimum, so it also wakes the LCD at line boundaries.
+      class EventTimes
+      {
+         public:
+            explicit EventTimes(const VideoInterruptRequester memEventRequester) : memEventRequester_(memEventRequester) {}
+
+            Event nextEvent() const { return eventMin_.min() == ly_count_id ? LY_COUNT : MEM_EVENT; }
+            cycle_t nextEventTime() const { return eventMin_.minValue(); }
+            // LY_COUNT is the only Event that is read or set from outside.
+            cycle_t operator()(Event) const { return eventMin_.value(ly_count_id); }
+            template<Event> void set(const cycle_t time) { eventMin_.setValue<ly_count_id>(time); setEvent(); }
+
+            MemEvent nextMemEvent() const { return static_cast<MemEvent>(eventMin_.min()); }
+            cycle_t operator()(const MemEvent e) const { return eventMin_.value(e); }
+            template<MemEvent e> void setm(const cycle_t time) { eventMin_.setValue<e>(time); setEvent(); }
+            void set(const MemEvent e, const cycle_t time) { eventMin_.setValue(e, time); setEvent(); }
+
+            void flagIrq(const unsigned bit) { memEventRequester_.flagIrq(bit); }
+            void flagHdmaReq() { memEventRequester_.flagHdmaReq(); }
+
+         private:
+            enum { ly_count_id = NUM_MEM_EVENTS };
+
+            EventMinKeeper<NUM_MEM_EVENTS + 1>::Type eventMin_;
+            VideoInterruptRequester memEventRequester_;
+
+            void setEvent() { memEventRequester_.setNextEventTime(eventMin_.minValue()); }
+      };
+#else
       class EventTimes
       {
          public:
             explicit EventTimes(const VideoInterruptRequester memEventRequester) : memEventRequester_(memEventRequester) {}
 
             Event nextEvent() const { return static_cast<Event>(eventMin_.min()); }
-            unsigned long nextEventTime() const { return eventMin_.minValue(); }
-            unsigned long operator()(const Event e) const { return eventMin_.value(e); }
-            template<Event e> void set(const unsigned long time) { eventMin_.setValue<e>(time); }
-            void set(const Event e, const unsigned long time) { eventMin_.setValue(e, time); }
+            cycle_t nextEventTime() const { return eventMin_.minValue(); }
+            cycle_t operator()(const Event e) const { return eventMin_.value(e); }
+            template<Event e> void set(const cycle_t time) { eventMin_.setValue<e>(time); }
+            void set(const Event e, const cycle_t time) { eventMin_.setValue(e, time); }
 
             MemEvent nextMemEvent() const { return static_cast<MemEvent>(memEventMin_.min()); }
-            unsigned long nextMemEventTime() const { return memEventMin_.minValue(); }
-            unsigned long operator()(const MemEvent e) const { return memEventMin_.value(e); }
-            template<MemEvent e> void setm(const unsigned long time) { memEventMin_.setValue<e>(time); setMemEvent(); }
-            void set(const MemEvent e, const unsigned long time) { memEventMin_.setValue(e, time); setMemEvent(); }
+            cycle_t nextMemEventTime() const { return memEventMin_.minValue(); }
+            cycle_t operator()(const MemEvent e) const { return memEventMin_.value(e); }
+            template<MemEvent e> void setm(const cycle_t time) { memEventMin_.setValue<e>(time); setMemEvent(); }
+            void set(const MemEvent e, const cycle_t time) { memEventMin_.setValue(e, time); setMemEvent(); }
 
             void flagIrq(const unsigned bit) { memEventRequester_.flagIrq(bit); }
             void flagHdmaReq() { memEventRequester_.flagHdmaReq(); }
 
          private:
-            MinKeeper<NUM_EVENTS> eventMin_;
-            MinKeeper<NUM_MEM_EVENTS> memEventMin_;
+            EventMinKeeper<NUM_EVENTS>::Type eventMin_;
+            EventMinKeeper<NUM_MEM_EVENTS>::Type memEventMin_;
             VideoInterruptRequester memEventRequester_;
 
             void setMemEvent() {
-               const unsigned long nmet = nextMemEventTime();
+               const cycle_t nmet = nextMemEventTime();
                eventMin_.setValue<MEM_EVENT>(nmet);
                memEventRequester_.setNextEventTime(nmet);
             }
 
       };
+#endif
 
       PPU ppu_;
-      video_pixel_t dmgColorsRgb32_[3 * 4];
+      VramViewer viewer_;
+      uint_least32_t dmgColorsRgb32_[3 * 4];
       unsigned char  bgpData_[8 * 8];
       unsigned char objpData_[8 * 8];
 
@@ -191,25 +246,33 @@ class LCD
       unsigned char m2IrqStatReg_;
       unsigned char m1IrqStatReg_;
 
-      static void setDmgPalette(video_pixel_t *palette, const video_pixel_t *dmgColors, unsigned data);
-      void setDmgPaletteColor(unsigned index, video_pixel_t rgb32);
+      void setDmgPalette(unsigned slot, const uint_least32_t *dmgColors, unsigned data);
+      void setDmgPaletteColor(unsigned index, uint_least32_t rgb32);
+      uint_least32_t gbcToColor(unsigned bgr15) const { return colorLut_[bgr15 & 0x7FFF]; }
+      uint_least32_t rgb32ToColor(uint_least32_t rgb32) const;
 
       void refreshPalettes();
+      void viewerPalette(uint_least32_t *palette);
       void setDBuffer();
 
       void doMode2IrqEvent();
       void event();
 
-      unsigned long m0TimeOfCurrentLine(unsigned long cc);
-      bool cgbpAccessible(unsigned long cycleCounter);
+      cycle_t m0TimeOfCurrentLine(cycle_t cc);
+      bool cgbpAccessible(cycle_t cycleCounter);
 
       void mode3CyclesChange();
-      void doCgbBgColorChange(unsigned index, unsigned data, unsigned long cycleCounter);
-      void doCgbSpColorChange(unsigned index, unsigned data, unsigned long cycleCounter);
+      void doCgbBgColorChange(unsigned index, unsigned data, cycle_t cycleCounter);
+      void doCgbSpColorChange(unsigned index, unsigned data, cycle_t cycleCounter);
 
       bool colorCorrection;
+      ColorCurve colorCurve_;
+      ColorLut curveLut_;
+      const uint_least32_t *colorLut_;
+      ColorCurve activeColorCurve() const;
+      void refreshColorLut();
       void doCgbColorChange(unsigned char *const pdata,
-            video_pixel_t *const palette, unsigned index, const unsigned data);
+            unsigned slot, unsigned index, const unsigned data);
 
 };
 
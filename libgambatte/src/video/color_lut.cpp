@@ -0,0 +1,36 @@
+//
+//   Copyright (C) 2026 by the gambatte contributors
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License version 2 for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   version 2 along with this program; if not, write to the
+//   Free Software Foundation, Inc.,
+//   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+//
+
+#include "color_lut.h"
+
+namespace gambatte {
+
+void ColorLut::set(ColorCurve const curve, PixelFormat const format) {
+	if (curve == curve_ && format == format_)
+		return;
+
+	lut_.resize(0x8000);
+
+	for (unsigned bgr15 = 0; bgr15 < 0x8000; ++bgr15)
+		lut_[bgr15] = curve(bgr15, format);
+
+	curve_ = curve;
+	format_ = format;
+}
+
+}
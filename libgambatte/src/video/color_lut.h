@@ -0,0 +1,50 @@
+//
+//   Copyright (C) 2026 by the gambatte contributors
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License version 2 for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   version 2 along with this program; if not, write to the
+//   Free Software Foundation, Inc.,
+//   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+//
+
+#ifndef COLOR_LUT_H
+#define COLOR_LUT_H
+
+#include "gambatte.h"
+#include <vector>
+
+namespace gambatte {
+
+// The colours a frontend's curve gives each of the 32768 BGR15 values in a
+// format, indexed by BGR15. The LCD using the curve keeps the table, so it goes
+// with the LCD. The built-in curves look colours up in static tables instead.
+class ColorLut {
+public:
+	ColorLut() : curve_(0), format_(PIXEL_NATIVE) {}
+
+	// Builds the table for curve and format unless it already holds them.
+	void set(ColorCurve curve, PixelFormat format);
+
+	// Makes the next set rebuild the table, for a curve whose colours changed.
+	void invalidate() { curve_ = 0; }
+
+	uint_least32_t const * data() const { return &lut_[0]; }
+
+private:
+	std::vector<uint_least32_t> lut_;
+	ColorCurve curve_;
+	PixelFormat format_;
+};
+
+}
+
+#endif
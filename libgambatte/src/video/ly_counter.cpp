@@ -39,23 +39,23 @@ void LyCounter::doEvent() {
 	time_ = time_ + lineTime_;
 }
 
-unsigned long LyCounter::nextLineCycle(unsigned const lineCycle, unsigned long const cc) const {
-	unsigned long tmp = time_ + (lineCycle << ds_);
+cycle_t LyCounter::nextLineCycle(unsigned const lineCycle, cycle_t const cc) const {
+	cycle_t tmp = time_ + (lineCycle << ds_);
 	if (tmp - cc > lineTime_)
 		tmp -= lineTime_;
 
 	return tmp;
 }
 
-unsigned long LyCounter::nextFrameCycle(unsigned long const frameCycle, unsigned long const cc) const {
-	unsigned long tmp = time_ + (((153U - ly()) * 456U + frameCycle) << ds_);
+cycle_t LyCounter::nextFrameCycle(cycle_t const frameCycle, cycle_t const cc) const {
+	cycle_t tmp = time_ + (((153U - ly()) * 456U + frameCycle) << ds_);
 	if (tmp - cc > 70224U << ds_)
 		tmp -= 70224U << ds_;
 
 	return tmp;
 }
 
-void LyCounter::reset(unsigned long videoCycles, unsigned long lastUpdate) {
+void LyCounter::reset(cycle_t videoCycles, cycle_t lastUpdate) {
 	ly_ = videoCycles / 456;
 	time_ = lastUpdate + ((456 - (videoCycles - ly_ * 456ul)) << isDoubleSpeed());
 }
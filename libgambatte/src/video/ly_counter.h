@@ -19,6 +19,8 @@
 #ifndef LY_COUNTER_H
 #define LY_COUNTER_H
 
+#include "counterdef.h"
+
 namespace gambatte {
 
 struct SaveState;
@@ -29,24 +31,24 @@ public:
 	void doEvent();
 	bool isDoubleSpeed() const { return ds_; }
 
-	unsigned long frameCycles(unsigned long cc) const {
+	cycle_t frameCycles(cycle_t cc) const {
 		return ly_ * 456ul + lineCycles(cc);
 	}
 
-	unsigned lineCycles(unsigned long cc) const {
+	unsigned lineCycles(cycle_t cc) const {
 		return 456u - ((time_ - cc) >> isDoubleSpeed());
 	}
 
 	unsigned lineTime() const { return lineTime_; }
 	unsigned ly() const { return ly_; }
-	unsigned long nextLineCycle(unsigned lineCycle, unsigned long cycleCounter) const;
-	unsigned long nextFrameCycle(unsigned long frameCycle, unsigned long cycleCounter) const;
-	void reset(unsigned long videoCycles, unsigned long lastUpdate);
+	cycle_t nextLineCycle(unsigned lineCycle, cycle_t cycleCounter) const;
+	cycle_t nextFrameCycle(cycle_t frameCycle, cycle_t cycleCounter) const;
+	void reset(cycle_t videoCycles, cycle_t lastUpdate);
 	void setDoubleSpeed(bool ds);
-	unsigned long time() const { return time_; }
+	cycle_t time() const { return time_; }
 
 private:
-	unsigned long time_;
+	cycle_t time_;
 	unsigned short lineTime_;
 	unsigned char ly_;
 	bool ds_;
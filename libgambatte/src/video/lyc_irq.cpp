@@ -35,16 +35,16 @@ LycIrq::LycIrq()
 {
 }
 
-static unsigned long schedule(unsigned statReg,
-		unsigned lycReg, LyCounter const &lyCounter, unsigned long cc) {
+static cycle_t schedule(unsigned statReg,
+		unsigned lycReg, LyCounter const &lyCounter, cycle_t cc) {
 	return (statReg & lcdstat_lycirqen) && lycReg < 154
 	     ? lyCounter.nextFrameCycle(lycReg ? lycReg * 456 : 153 * 456 + 8, cc)
-	     : static_cast<unsigned long>(disabled_time);
+	     : disabled_time;
 }
 
 void LycIrq::regChange(unsigned const statReg,
-		unsigned const lycReg, LyCounter const &lyCounter, unsigned long const cc) {
-	unsigned long const timeSrc = schedule(statReg, lycReg, lyCounter, cc);
+		unsigned const lycReg, LyCounter const &lyCounter, cycle_t const cc) {
+	cycle_t const timeSrc = schedule(statReg, lycReg, lyCounter, cc);
 	statRegSrc_ = statReg;
 	lycRegSrc_ = lycReg;
 	time_ = std::min(time_, timeSrc);
@@ -95,7 +95,7 @@ void LycIrq::saveState(SaveState &state) const {
 	state.ppu.lyc = lycReg_;
 }
 
-void LycIrq::reschedule(LyCounter const &lyCounter, unsigned long cc) {
+void LycIrq::reschedule(LyCounter const &lyCounter, cycle_t cc) {
 	time_ = std::min(schedule(statReg_   , lycReg_   , lyCounter, cc),
 	                 schedule(statRegSrc_, lycRegSrc_, lyCounter, cc));
 }
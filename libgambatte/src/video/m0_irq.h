@@ -20,13 +20,13 @@ public:
 	}
 
 	void statRegChange(unsigned statReg,
-	                   unsigned long nextM0IrqTime, unsigned long cc, bool cgb) {
+	                   cycle_t nextM0IrqTime, cycle_t cc, bool cgb) {
 		if (nextM0IrqTime - cc > cgb * 2U)
 			statReg_ = statReg;
 	}
 
 	void lycRegChange(unsigned lycReg,
-	                  unsigned long nextM0IrqTime, unsigned long cc,
+	                  cycle_t nextM0IrqTime, cycle_t cc,
 	                  bool ds, bool cgb) {
 		if (nextM0IrqTime - cc > cgb * 5 + 1U - ds)
 			lycReg_ = lycReg;
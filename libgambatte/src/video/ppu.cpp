@@ -17,7 +17,9 @@
 //
 
 #include "ppu.h"
+#include "hash64.h"
 #include "savestate.h"
+#include "tile_row.h"
 #include <algorithm>
 #include <cstring>
 #include <cstddef>
@@ -166,6 +168,10 @@ static int loadTileDataByte1(PPUPriv const &p) {
 	                     + ((-(p.nattrib >> 6 & 1) ^ yoffset) & 7) * 2 + 1];
 }
 
+namespace M3Loop {
+	static bool doFullLine(PPUPriv &p);
+}
+
 namespace M3Start {
 	static void f0(PPUPriv &p) {
 		p.xpos = 0;
@@ -242,6 +248,10 @@ namespace M3Start {
 
 		p.xpos = 0;
 		p.endx = 8 - (p.scx & 7);
+		p.lineFlushed = 0;
+
+		if (M3Loop::doFullLine(p))
+			return;
 
 		static PPUState const *const flut[8] = {
 			&M3Loop::Tile::f0_,
@@ -260,10 +270,13 @@ namespace M3Start {
 
 namespace M3Loop {
 
-static void doFullTilesUnrolledDmg(PPUPriv &p, int const xend, video_pixel_t *const dbufline,
+static void writeBgRun(PPUPriv &p, unsigned char *dbufline, int x,
+		unsigned short const *tilewords, unsigned char const *palnums, unsigned ntiles);
+
+static void doFullTilesUnrolledDmg(PPUPriv &p, int const xend, unsigned char *const dbufline,
 		unsigned char const *const tileMapLine, unsigned const tileline, unsigned tileMapXpos) {
 	unsigned const tileIndexSign = ~p.lcdc << 3 & 0x80;
-	unsigned char const *const tileDataLine = p.vram + tileIndexSign * 32 + tileline * 2;
+	unsigned const tileDataLine = tileIndexSign * 32 + tileline * 2;
 	int xpos = p.xpos;
 
 	do {
@@ -321,33 +334,30 @@ static void doFullTilesUnrolledDmg(PPUPriv &p, int const xend, video_pixel_t *co
 			p.cycles -= n;
 
 			unsigned ntileword = p.ntileword;
-			video_pixel_t *      dst    = dbufline + xpos - 8;
-			video_pixel_t *const dstend = dst + n;
+			unsigned char *      dst    = dbufline + xpos - 8;
+			unsigned char *const dstend = dst + n;
 			xpos += n;
 
 			if (!lcdcBgEn(p)) {
-				do { *dst++ = p.bgPalette[0]; } while (dst != dstend);
+				do { *dst++ = 0; } while (dst != dstend);
 				tileMapXpos += n >> 3;
 
 				unsigned const tno = tileMapLine[(tileMapXpos - 1) & 0x1F];
-				ntileword = expand_lut[(tileDataLine + tno * 16 - (tno & tileIndexSign) * 32)[0]]
-				          + expand_lut[(tileDataLine + tno * 16 - (tno & tileIndexSign) * 32)[1]] * 2;
-			} else do {
-				dst[0] = p.bgPalette[ ntileword & 0x0003       ];
-				dst[1] = p.bgPalette[(ntileword & 0x000C) >>  2];
-				dst[2] = p.bgPalette[(ntileword & 0x0030) >>  4];
-				dst[3] = p.bgPalette[(ntileword & 0x00C0) >>  6];
-				dst[4] = p.bgPalette[(ntileword & 0x0300) >>  8];
-				dst[5] = p.bgPalette[(ntileword & 0x0C00) >> 10];
-				dst[6] = p.bgPalette[(ntileword & 0x3000) >> 12];
-				dst[7] = p.bgPalette[ ntileword           >> 14];
-				dst += 8;
-
-				unsigned const tno = tileMapLine[tileMapXpos & 0x1F];
-				tileMapXpos = (tileMapXpos & 0x1F) + 1;
-				ntileword = expand_lut[(tileDataLine + tno * 16 - (tno & tileIndexSign) * 32)[0]]
-				          + expand_lut[(tileDataLine + tno * 16 - (tno & tileIndexSign) * 32)[1]] * 2;
-			} while (dst != dstend);
+				ntileword = p.tileCache.tileword(tileDataLine + tno * 16 - (tno & tileIndexSign) * 32, 0);
+			} else {
+				unsigned short tilewords[max_tile_run];
+				unsigned const ntiles = n >> 3;
+
+				for (unsigned t = 0; t < ntiles; ++t) {
+					tilewords[t] = ntileword;
+
+					unsigned const tno = tileMapLine[tileMapXpos & 0x1F];
+					tileMapXpos = (tileMapXpos & 0x1F) + 1;
+					ntileword = p.tileCache.tileword(tileDataLine + tno * 16 - (tno & tileIndexSign) * 32, 0);
+				}
+
+				writeBgRun(p, dbufline, dst - dbufline, tilewords, 0, ntiles);
+			}
 
 			p.ntileword = ntileword;
 			continue;
@@ -360,17 +370,17 @@ static void doFullTilesUnrolledDmg(PPUPriv &p, int const xend, video_pixel_t *co
 		}
 
 		{
-			video_pixel_t *const dst = dbufline + (xpos - 8);
+			unsigned char *const dst = dbufline + (xpos - 8);
 			unsigned const tileword = -(p.lcdc & 1U) & p.ntileword;
 
-			dst[0] = p.bgPalette[ tileword & 0x0003       ];
-			dst[1] = p.bgPalette[(tileword & 0x000C) >>  2];
-			dst[2] = p.bgPalette[(tileword & 0x0030) >>  4];
-			dst[3] = p.bgPalette[(tileword & 0x00C0) >>  6];
-			dst[4] = p.bgPalette[(tileword & 0x0300) >>  8];
-			dst[5] = p.bgPalette[(tileword & 0x0C00) >> 10];
-			dst[6] = p.bgPalette[(tileword & 0x3000) >> 12];
-			dst[7] = p.bgPalette[ tileword           >> 14];
+			dst[0] =  tileword & 0x0003       ;
+			dst[1] = (tileword & 0x000C) >>  2;
+			dst[2] = (tileword & 0x0030) >>  4;
+			dst[3] = (tileword & 0x00C0) >>  6;
+			dst[4] = (tileword & 0x0300) >>  8;
+			dst[5] = (tileword & 0x0C00) >> 10;
+			dst[6] = (tileword & 0x3000) >> 12;
+			dst[7] =  tileword           >> 14;
 
 			int i = nextSprite - 1;
 
@@ -392,26 +402,26 @@ static void doFullTilesUnrolledDmg(PPUPriv &p, int const xend, video_pixel_t *co
 
 					unsigned const attrib = p.spriteList[i].attrib;
 					unsigned spword       = p.spwordList[i];
-					video_pixel_t const *const spPalette = p.spPalette + (attrib >> 2 & 4);
-					video_pixel_t *d = dst + pos;
+					unsigned const spPalette = sp_palette_slot + (attrib >> 2 & 4);
+					unsigned char *d = dst + pos;
 
 					if (!(attrib & attr_bgpriority)) {
 						switch (n) {
-						case 8: if (spword >> 14    ) { d[7] = spPalette[spword >> 14    ]; }
-						case 7: if (spword >> 12 & 3) { d[6] = spPalette[spword >> 12 & 3]; }
-						case 6: if (spword >> 10 & 3) { d[5] = spPalette[spword >> 10 & 3]; }
-						case 5: if (spword >>  8 & 3) { d[4] = spPalette[spword >>  8 & 3]; }
-						case 4: if (spword >>  6 & 3) { d[3] = spPalette[spword >>  6 & 3]; }
-						case 3: if (spword >>  4 & 3) { d[2] = spPalette[spword >>  4 & 3]; }
-						case 2: if (spword >>  2 & 3) { d[1] = spPalette[spword >>  2 & 3]; }
-						case 1: if (spword       & 3) { d[0] = spPalette[spword       & 3]; }
+						case 8: if (spword >> 14    ) { d[7] = spPalette + (spword >> 14    ); }
+						case 7: if (spword >> 12 & 3) { d[6] = spPalette + (spword >> 12 & 3); }
+						case 6: if (spword >> 10 & 3) { d[5] = spPalette + (spword >> 10 & 3); }
+						case 5: if (spword >>  8 & 3) { d[4] = spPalette + (spword >>  8 & 3); }
+						case 4: if (spword >>  6 & 3) { d[3] = spPalette + (spword >>  6 & 3); }
+						case 3: if (spword >>  4 & 3) { d[2] = spPalette + (spword >>  4 & 3); }
+						case 2: if (spword >>  2 & 3) { d[1] = spPalette + (spword >>  2 & 3); }
+						case 1: if (spword       & 3) { d[0] = spPalette + (spword       & 3); }
 						}
 
 						spword >>= n * 2;
 
 						/*do {
 							if (spword & 3)
-								dst[pos] = spPalette[spword & 3];
+								dst[pos] = spPalette + (spword & 3);
 
 							spword >>= 2;
 							++pos;
@@ -426,8 +436,8 @@ static void doFullTilesUnrolledDmg(PPUPriv &p, int const xend, video_pixel_t *co
 							if (spword & 3)
                      {
 								d[n] = (tw & 3)
-								     ? p.bgPalette[    tw & 3]
-								     :   spPalette[spword & 3];
+								     ? tw & 3
+								     : spPalette + (spword & 3);
 							}
 
 							spword >>= 2;
@@ -443,8 +453,7 @@ static void doFullTilesUnrolledDmg(PPUPriv &p, int const xend, video_pixel_t *co
 
 		unsigned const tno = tileMapLine[tileMapXpos & 0x1F];
 		tileMapXpos = (tileMapXpos & 0x1F) + 1;
-		p.ntileword = expand_lut[(tileDataLine + tno * 16 - (tno & tileIndexSign) * 32)[0]]
-		            + expand_lut[(tileDataLine + tno * 16 - (tno & tileIndexSign) * 32)[1]] * 2;
+		p.ntileword = p.tileCache.tileword(tileDataLine + tno * 16 - (tno & tileIndexSign) * 32, 0);
 
 		xpos = xpos + 8;
 	} while (xpos < xend);
@@ -452,7 +461,7 @@ static void doFullTilesUnrolledDmg(PPUPriv &p, int const xend, video_pixel_t *co
 	p.xpos = xpos;
 }
 
-static void doFullTilesUnrolledCgb(PPUPriv &p, int const xend, video_pixel_t *const dbufline,
+static void doFullTilesUnrolledCgb(PPUPriv &p, int const xend, unsigned char *const dbufline,
 		unsigned char const *const tileMapLine, unsigned const tileline, unsigned tileMapXpos) {
 	int xpos = p.xpos;
 	unsigned char const *const vram = p.vram;
@@ -504,33 +513,29 @@ static void doFullTilesUnrolledCgb(PPUPriv &p, int const xend, video_pixel_t *co
 
 			unsigned ntileword = p.ntileword;
 			unsigned nattrib   = p.nattrib;
-			video_pixel_t *      dst    = dbufline + xpos - 8;
-			video_pixel_t *const dstend = dst + n;
+			unsigned char *const dst = dbufline + xpos - 8;
 			xpos += n;
 
-			do {
-				video_pixel_t const *const bgPalette = p.bgPalette + (nattrib & 7) * 4;
-				dst[0] = bgPalette[ ntileword & 0x0003       ];
-				dst[1] = bgPalette[(ntileword & 0x000C) >>  2];
-				dst[2] = bgPalette[(ntileword & 0x0030) >>  4];
-				dst[3] = bgPalette[(ntileword & 0x00C0) >>  6];
-				dst[4] = bgPalette[(ntileword & 0x0300) >>  8];
-				dst[5] = bgPalette[(ntileword & 0x0C00) >> 10];
-				dst[6] = bgPalette[(ntileword & 0x3000) >> 12];
-				dst[7] = bgPalette[ ntileword           >> 14];
-				dst += 8;
+			unsigned short tilewords[max_tile_run];
+			unsigned char palnums[max_tile_run];
+			unsigned const ntiles = n >> 3;
+
+			for (unsigned t = 0; t < ntiles; ++t) {
+				tilewords[t] = ntileword;
+				palnums[t]   = nattrib & 7;
 
 				unsigned const tno = tileMapLine[ tileMapXpos & 0x1F          ];
 				nattrib            = tileMapLine[(tileMapXpos & 0x1F) + 0x2000];
 				tileMapXpos = (tileMapXpos & 0x1F) + 1;
 
 				unsigned const tdo = (tdoffset & ~(tno << 5));
-				unsigned char const *const td = vram + tno * 16
-				                                     + ((nattrib & attr_yflip) ? tdo ^ 14 : tdo)
-				                                     + (nattrib << 10 & 0x2000);
-				unsigned short const *const explut = expand_lut + (nattrib << 3 & 0x100);
-				ntileword = explut[td[0]] + explut[td[1]] * 2;
-			} while (dst != dstend);
+				ntileword = p.tileCache.tileword(tno * 16
+				                                 + ((nattrib & attr_yflip) ? tdo ^ 14 : tdo)
+				                                 + (nattrib << 10 & 0x2000),
+				                                 nattrib >> 5 & 1);
+			}
+
+			writeBgRun(p, dbufline, dst - dbufline, tilewords, palnums, ntiles);
 
 			p.ntileword = ntileword;
 			p.nattrib   = nattrib;
@@ -545,19 +550,19 @@ static void doFullTilesUnrolledCgb(PPUPriv &p, int const xend, video_pixel_t *co
 		}
 
 		{
-			video_pixel_t *const dst = dbufline + (xpos - 8);
+			unsigned char *const dst = dbufline + (xpos - 8);
 			unsigned const tileword = p.ntileword;
 			unsigned const attrib   = p.nattrib;
-			video_pixel_t const *const bgPalette = p.bgPalette + (attrib & 7) * 4;
+			unsigned const bgPalette = (attrib & 7) * 4;
 
-			dst[0] = bgPalette[ tileword & 0x0003       ];
-			dst[1] = bgPalette[(tileword & 0x000C) >>  2];
-			dst[2] = bgPalette[(tileword & 0x0030) >>  4];
-			dst[3] = bgPalette[(tileword & 0x00C0) >>  6];
-			dst[4] = bgPalette[(tileword & 0x0300) >>  8];
-			dst[5] = bgPalette[(tileword & 0x0C00) >> 10];
-			dst[6] = bgPalette[(tileword & 0x3000) >> 12];
-			dst[7] = bgPalette[ tileword           >> 14];
+			dst[0] = bgPalette + ( tileword & 0x0003       );
+			dst[1] = bgPalette + ((tileword & 0x000C) >>  2);
+			dst[2] = bgPalette + ((tileword & 0x0030) >>  4);
+			dst[3] = bgPalette + ((tileword & 0x00C0) >>  6);
+			dst[4] = bgPalette + ((tileword & 0x0300) >>  8);
+			dst[5] = bgPalette + ((tileword & 0x0C00) >> 10);
+			dst[6] = bgPalette + ((tileword & 0x3000) >> 12);
+			dst[7] = bgPalette + ( tileword           >> 14);
 
 			int i = nextSprite - 1;
 
@@ -584,44 +589,44 @@ static void doFullTilesUnrolledCgb(PPUPriv &p, int const xend, video_pixel_t *co
 					unsigned char const id = p.spriteList[i].oampos;
 					unsigned const sattrib = p.spriteList[i].attrib;
 					unsigned spword        = p.spwordList[i];
-					video_pixel_t const *const spPalette = p.spPalette + (sattrib & 7) * 4;
+					unsigned const spPalette = sp_palette_slot + (sattrib & 7) * 4;
 
 					if (!((attrib | sattrib) & bgprioritymask)) {
 						unsigned char  *const idt = idtab + pos;
-						video_pixel_t *const   d =   dst + pos;
+						unsigned char *const   d =   dst + pos;
 
 						switch (n) {
 						case 8: if ((spword >> 14    ) && id < idt[7]) {
 						        	idt[7] = id;
-						        	  d[7] = spPalette[spword >> 14    ];
+						        	  d[7] = spPalette + (spword >> 14    );
 						        }
 						case 7: if ((spword >> 12 & 3) && id < idt[6]) {
 						        	idt[6] = id;
-						        	  d[6] = spPalette[spword >> 12 & 3];
+						        	  d[6] = spPalette + (spword >> 12 & 3);
 						        }
 						case 6: if ((spword >> 10 & 3) && id < idt[5]) {
 						        	idt[5] = id;
-						        	  d[5] = spPalette[spword >> 10 & 3];
+						        	  d[5] = spPalette + (spword >> 10 & 3);
 						        }
 						case 5: if ((spword >>  8 & 3) && id < idt[4]) {
 						        	idt[4] = id;
-						        	  d[4] = spPalette[spword >>  8 & 3];
+						        	  d[4] = spPalette + (spword >>  8 & 3);
 						        }
 						case 4: if ((spword >>  6 & 3) && id < idt[3]) {
 						        	idt[3] = id;
-						        	  d[3] = spPalette[spword >>  6 & 3];
+						        	  d[3] = spPalette + (spword >>  6 & 3);
 						        }
 						case 3: if ((spword >>  4 & 3) && id < idt[2]) {
 						        	idt[2] = id;
-						        	  d[2] = spPalette[spword >>  4 & 3];
+						        	  d[2] = spPalette + (spword >>  4 & 3);
 						        }
 						case 2: if ((spword >>  2 & 3) && id < idt[1]) {
 						        	idt[1] = id;
-						        	  d[1] = spPalette[spword >>  2 & 3];
+						        	  d[1] = spPalette + (spword >>  2 & 3);
 						        }
 						case 1: if ((spword       & 3) && id < idt[0]) {
 						        	idt[0] = id;
-						        	  d[0] = spPalette[spword       & 3];
+						        	  d[0] = spPalette + (spword       & 3);
 						        }
 						}
 
@@ -630,7 +635,7 @@ static void doFullTilesUnrolledCgb(PPUPriv &p, int const xend, video_pixel_t *co
 						/*do {
 							if ((spword & 3) && id < idtab[pos]) {
 								idtab[pos] = id;
-									dst[pos] = spPalette[spword & 3];
+									dst[pos] = spPalette + (spword & 3);
 							}
 
 							spword >>= 2;
@@ -643,8 +648,8 @@ static void doFullTilesUnrolledCgb(PPUPriv &p, int const xend, video_pixel_t *co
 							if ((spword & 3) && id < idtab[pos]) {
 								idtab[pos] = id;
 								  dst[pos] = (tw & 3)
-								           ? bgPalette[    tw & 3]
-								           : spPalette[spword & 3];
+								           ? bgPalette + (    tw & 3)
+								           : spPalette + (spword & 3);
 							}
 
 							spword >>= 2;
@@ -665,11 +670,10 @@ static void doFullTilesUnrolledCgb(PPUPriv &p, int const xend, video_pixel_t *co
 			tileMapXpos = (tileMapXpos & 0x1F) + 1;
 
 			unsigned const tdo = tdoffset & ~(tno << 5);
-			unsigned char const *const td = vram + tno * 16
-			                                     + ((nattrib & attr_yflip) ? tdo ^ 14 : tdo)
-			                                     + (nattrib << 10 & 0x2000);
-			unsigned short const *const explut = expand_lut + (nattrib << 3 & 0x100);
-			p.ntileword = explut[td[0]] + explut[td[1]] * 2;
+			p.ntileword = p.tileCache.tileword(tno * 16
+			                                   + ((nattrib & attr_yflip) ? tdo ^ 14 : tdo)
+			                                   + (nattrib << 10 & 0x2000),
+			                                   nattrib >> 5 & 1);
 			p.nattrib   = nattrib;
 		}
 
@@ -687,7 +691,7 @@ static void doFullTilesUnrolled(PPUPriv &p) {
 	if (xpos >= xend)
 		return;
 
-	video_pixel_t *const dbufline = p.framebuf.fbline();
+	unsigned char *const dbufline = p.lineBuf;
 	unsigned char const *tileMapLine;
 	unsigned tileline;
 	unsigned tileMapXpos;
@@ -705,7 +709,7 @@ static void doFullTilesUnrolled(PPUPriv &p) {
 	}
 
 	if (xpos < 8) {
-		video_pixel_t prebuf[16];
+		unsigned char prebuf[16];
 
 		if (p.cgb) {
 			doFullTilesUnrolledCgb(p, xend < 8 ? xend : 8, prebuf + (8 - xpos),
@@ -718,7 +722,7 @@ static void doFullTilesUnrolled(PPUPriv &p) {
 		int const newxpos = p.xpos;
 
 		if (newxpos > 8) {
-			std::memcpy(dbufline, prebuf + (8 - xpos), (newxpos - 8) * sizeof *dbufline);
+			std::memcpy(dbufline, prebuf + (8 - xpos), newxpos - 8);
 		} else if (newxpos < 8)
 			return;
 
@@ -737,7 +741,6 @@ static void doFullTilesUnrolled(PPUPriv &p) {
 static void plotPixel(PPUPriv &p) {
 	int const xpos = p.xpos;
 	unsigned const tileword = p.tileword;
-	video_pixel_t *const fbline = p.framebuf.fbline();
 
 	if (static_cast<int>(p.wx) == xpos
 			&& (p.weMaster || (p.wy2 == p.lyCounter.ly() && lcdcWinEn(p)))
@@ -750,7 +753,7 @@ static void plotPixel(PPUPriv &p) {
 	}
 
 	unsigned const twdata = tileword & ((p.lcdc & 1) | p.cgb) * 3;
-	video_pixel_t pixel = p.bgPalette[twdata + (p.attrib & 7) * 4];
+	unsigned pixel = twdata + (p.attrib & 7) * 4;
 	int i = static_cast<int>(p.nextSprite) - 1;
 
 	if (i >= 0 && int(p.spriteList[i].spx) > xpos - 8) {
@@ -773,7 +776,7 @@ static void plotPixel(PPUPriv &p) {
 
 			if (spdata && lcdcObjEn(p)
 					&& (!((attrib | p.attrib) & attr_bgpriority) || !twdata || !lcdcBgEn(p))) {
-				pixel = p.spPalette[(attrib & 7) * 4 + spdata];
+				pixel = sp_palette_slot + (attrib & 7) * 4 + spdata;
 			}
 		} else {
 			do {
@@ -787,12 +790,12 @@ static void plotPixel(PPUPriv &p) {
 			} while (i >= 0 && int(p.spriteList[i].spx) > xpos - 8);
 
 			if (spdata && lcdcObjEn(p) && (!(attrib & attr_bgpriority) || !twdata))
-				pixel = p.spPalette[(attrib >> 2 & 4) + spdata];
+				pixel = sp_palette_slot + (attrib >> 2 & 4) + spdata;
 		}
 	}
 
 	if (xpos - 8 >= 0)
-		fbline[xpos - 8] = pixel;
+		p.lineBuf[xpos - 8] = pixel;
 
 	p.xpos = xpos + 1;
 	p.tileword = tileword >> 2;
@@ -811,8 +814,8 @@ static void plotPixelIfNoSprite(PPUPriv &p) {
 		plotPixel(p);
 }
 
-static unsigned long nextM2Time(PPUPriv const &p) {
-	unsigned long nextm2 = p.lyCounter.isDoubleSpeed()
+static cycle_t nextM2Time(PPUPriv const &p) {
+	cycle_t nextm2 = p.lyCounter.isDoubleSpeed()
 		? p.lyCounter.time() + (weMasterCheckPriorToLyIncLineCycle(true ) + m2_ds_offset) * 2 - 456 * 2
 		: p.lyCounter.time() +  weMasterCheckPriorToLyIncLineCycle(p.cgb)                     - 456    ;
 	if (p.lyCounter.ly() == 143)
@@ -821,10 +824,120 @@ static unsigned long nextM2Time(PPUPriv const &p) {
 	return nextm2;
 }
 
+// Number of pixels of the current line in lineBuf.
+static int lineXpos(PPUPriv const &p) {
+	if (p.nextCallPtr == &M2_Ly0::f0_ || p.nextCallPtr == &M2_LyNon0::f0_)
+		return 160;
+
+	if (p.nextCallPtr == &M2_LyNon0::f1_
+			|| p.nextCallPtr == &M3Start::f0_ || p.nextCallPtr == &M3Start::f1_) {
+		return 0;
+	}
+
+	return std::min(std::max(p.xpos - 8, 0), 160);
+}
+
+// Frame position, ly * 160 + x, of the next pixel to be drawn. Once a line
+// has been drawn that is the start of the next line, also in the cycles
+// before LY increments, where the next line's M3Start is already pending.
+static unsigned nextPixelPos(PPUPriv const &p) {
+	unsigned const ly = p.lyCounter.ly();
+	int const x = lineXpos(p);
+
+	if (x == 160 || (x == 0 && p.lyCounter.lineCycles(p.now) >= 456 / 2))
+		return (ly + 1) * 160;
+
+	return ly * 160 + x;
+}
+
+template<typename T>
+static void writeLine(T *const dst, unsigned char const *const slots,
+		uint_least32_t const *const palette, int const x0, int const xend) {
+	writeSlotColors(dst + x0, slots + x0, palette, xend - x0);
+}
+
+// Converts lineBuf up to xend into the frame buffer with the current palette,
+// which holds colours in the frame buffer format.
+static void flushLine(PPUPriv &p, int const xend) {
+	int const x0 = p.lineFlushed;
+	if (x0 >= xend)
+		return;
+
+	if (p.framebuf.fb()) {
+		PPUFrameBuf const &fb = p.framebuf;
+		unsigned const ly = p.lyCounter.ly();
+
+		switch (fb.format()) {
+		case PIXEL_RGB32:
+			writeLine(fb.line<uint32_t>(ly), p.lineBuf, p.palette, x0, xend);
+			break;
+		case PIXEL_RGB565:
+		case PIXEL_XRGB1555:
+			writeLine(fb.line<uint16_t>(ly), p.lineBuf, p.palette, x0, xend);
+			break;
+		case PIXEL_GRAY8:
+			writeLine(fb.line<unsigned char>(ly), p.lineBuf, p.palette, x0, xend);
+			break;
+		case PIXEL_INDEXED8:
+			std::memcpy(fb.line<unsigned char>(ly) + x0, p.lineBuf + x0, xend - x0);
+			break;
+		}
+	}
+
+	p.lineFlushed = xend;
+}
+
+// Writes ntiles background tiles to dst as frame buffer pixels: colours from
+// the current palette, or palette slots in PIXEL_INDEXED8.
+static void writeBgPixels(PPUPriv const &p, void *const dst, unsigned short const *tilewords,
+		unsigned char const *palnums, unsigned ntiles) {
+	switch (p.framebuf.format()) {
+	case PIXEL_RGB32:
+		writeBgTileColors(static_cast<uint32_t *>(dst), tilewords, palnums, ntiles, p.palette);
+		break;
+	case PIXEL_RGB565:
+	case PIXEL_XRGB1555:
+		writeBgTileColors(static_cast<uint16_t *>(dst), tilewords, palnums, ntiles, p.palette);
+		break;
+	case PIXEL_GRAY8:
+		writeBgTileColors(static_cast<unsigned char *>(dst), tilewords, palnums, ntiles, p.palette);
+		break;
+	case PIXEL_INDEXED8:
+		writeBgTiles(static_cast<unsigned char *>(dst), tilewords, palnums, ntiles);
+		break;
+	}
+}
+
+// Writes a run of background tiles that starts x pixels into dbufline. A run
+// in lineBuf goes straight to the frame buffer once the pixels before it are
+// converted, so only pixels drawn with sprites or one at a time take the
+// detour through palette slots.
+static void writeBgRun(PPUPriv &p, unsigned char *const dbufline, int const x,
+		unsigned short const *tilewords, unsigned char const *palnums, unsigned ntiles) {
+	if (dbufline != p.lineBuf || !p.framebuf.fb()) {
+		writeBgTiles(dbufline + x, tilewords, palnums, ntiles);
+		return;
+	}
+
+	flushLine(p, x);
+	writeBgPixels(p, p.framebuf.lineBytes(p.lyCounter.ly()) + x * p.framebuf.pixelSize(),
+	              tilewords, palnums, ntiles);
+	p.lineFlushed = x + ntiles * 8;
+}
+
+static void hashLine(PPUPriv &p, unsigned const ly) {
+	p.lineHash[ly] = p.framebuf.fb() && p.hashLines
+	               ? hash64(p.framebuf.lineBytes(ly), 160 * p.framebuf.pixelSize())
+	               : 0;
+}
+
 static void xpos168(PPUPriv &p) {
+	flushLine(p, 160);
+	hashLine(p, p.lyCounter.ly());
+
 	p.lastM0Time = p.now - (p.cycles << p.lyCounter.isDoubleSpeed());
 
-	unsigned long const nextm2 = nextM2Time(p);
+	cycle_t const nextm2 = nextM2Time(p);
 
 	p.cycles = p.now >= nextm2
 		?  long((p.now - nextm2) >> p.lyCounter.isDoubleSpeed())
@@ -833,6 +946,163 @@ static void xpos168(PPUPriv &p) {
 	nextCall(0, p.lyCounter.ly() == 143 ? M2_Ly0::f0_ : M2_LyNon0::f0_, p);
 }
 
+struct BgTile {
+	unsigned short tileword;
+	unsigned char tno;
+	unsigned char attrib;
+	unsigned char byte0;
+};
+
+static void loadFetchedTile(PPUPriv &p, BgTile const &t) {
+	p.reg1      = t.tno;
+	p.nattrib   = t.attrib;
+	p.reg0      = t.byte0;
+	p.ntileword = t.tileword;
+}
+
+// Called at the start of M3Loop (xpos 0). If the line has no sprites, cannot
+// start the window, and the current update runs past its mode 3, draws it in
+// one pass and ends mode 3 directly. Register, palette, OAM and VRAM writes
+// all update the PPU up to the write cycle first, so an update spanning the
+// whole of mode 3 means none of them happened during the line. The fetcher
+// registers are left as Tile::f0 and its unrolled tile loop would leave them.
+static bool doFullLine(PPUPriv &p) {
+	int const m3cycles = 168 - p.cgb;
+	unsigned const ly = p.lyCounter.ly();
+
+	if (p.cycles < m3cycles
+			|| p.winDrawState
+			|| p.spriteList[0].spx != 0xFF
+			|| (p.wx < 167 && (p.weMaster || (p.wy2 == ly && lcdcWinEn(p))))) {
+		return false;
+	}
+
+	int const fineScroll = p.scx & 7;
+	unsigned char const *const tileMapLine = p.vram + (p.lcdc << 7 & 0x400)
+	                                       + ((p.scy + ly) & 0xF8) * 4 + 0x1800;
+	unsigned const tdoffset = ((p.scy + ly) & 7) * 2 + (~p.lcdc & 0x10) * 0x100;
+
+	// tiles[k] is drawn at xpos 8 - fineScroll + 8 * k. The last one is only fetched.
+	BgTile tiles[max_tile_run + 1];
+	unsigned short tilewords[max_tile_run];
+	unsigned char palnums[max_tile_run];
+
+	for (int k = 0; k <= max_tile_run; ++k) {
+		unsigned const tno    = tileMapLine[ ((p.scx >> 3) + k) & 0x1F          ];
+		unsigned const attrib = tileMapLine[(((p.scx >> 3) + k) & 0x1F) + 0x2000];
+		unsigned const tdo = tdoffset & ~(tno << 5);
+		unsigned const td = tno * 16
+		                  + ((attrib & attr_yflip) ? tdo ^ 14 : tdo)
+		                  + (attrib << 10 & 0x2000);
+
+		tiles[k].tileword = p.tileCache.tileword(td, attrib >> 5 & 1);
+		tiles[k].tno      = tno;
+		tiles[k].attrib   = attrib;
+		tiles[k].byte0    = p.vram[td];
+
+		if (k < max_tile_run) {
+			tilewords[k] = tiles[k].tileword;
+			palnums[k]   = attrib & 7;
+		}
+	}
+
+	// With fine scrolling, M3Start has begun fetching tile 0, possibly in an
+	// earlier update with other register or VRAM contents. Finish that fetch
+	// from the latched tile number and attributes, loading the data bytes it
+	// has not loaded yet.
+	if (fineScroll) {
+		unsigned const byte0 = fineScroll >= 3 ? p.reg0 : loadTileDataByte0(p);
+
+		tiles[0].tno    = p.reg1;
+		tiles[0].attrib = p.nattrib;
+		tiles[0].byte0  = byte0;
+		tiles[0].tileword = fineScroll >= 5
+		                  ? p.ntileword
+		                  : (expand_lut + (p.nattrib << 3 & 0x100))[byte0]
+		                  + (expand_lut + (p.nattrib << 3 & 0x100))[loadTileDataByte1(p)] * 2;
+		tilewords[0] = tiles[0].tileword;
+		palnums[0]   = p.nattrib & 7;
+	}
+
+	if (!lcdcBgEn(p) && !p.cgb) {
+		std::memset(p.lineBuf, 0, sizeof p.lineBuf);
+	} else if (p.framebuf.fb()) {
+		// nothing is drawn on the line yet, and no palette can change during it
+		std::size_t const pixelSize = p.framebuf.pixelSize();
+		unsigned char *const dst = p.framebuf.lineBytes(ly);
+
+		if (fineScroll) {
+			uint32_t linebuf[max_tile_run * 8];
+			writeBgPixels(p, linebuf, tilewords, p.cgb ? palnums : 0, max_tile_run);
+			std::memcpy(dst, reinterpret_cast<unsigned char *>(linebuf) + fineScroll * pixelSize,
+			            160 * pixelSize);
+		} else
+			writeBgPixels(p, dst, tilewords, p.cgb ? palnums : 0, 160 / 8);
+
+		p.lineFlushed = 160;
+	} else {
+		unsigned char linebuf[max_tile_run * 8];
+		writeBgTiles(linebuf, tilewords, p.cgb ? palnums : 0, max_tile_run);
+		std::memcpy(p.lineBuf, linebuf + fineScroll, sizeof p.lineBuf);
+	}
+
+	// Tile::f0 runs the unrolled loop from xpos up to the window x position
+	// and steps through one tile there, then again up to 168 - fineScroll.
+	// With fine scrolling the partial tiles at either end are stepped too.
+	int xpos = fineScroll ? 8 - fineScroll : 0;
+	int const xlast = 168 - fineScroll;
+
+	if (fineScroll)
+		loadFetchedTile(p, tiles[0]);
+
+	if (p.wx >= xpos && p.wx < 168) {
+		int const xw = xpos + ((std::max(p.wx - 7 - xpos, 0) + 7) & ~7);
+
+		if (xw < xlast) {
+			int const k = (xw + fineScroll) >> 3;
+
+			if (xw > xpos) {
+				p.ntileword = tiles[k - 1].tileword;
+
+				if (p.cgb)
+					p.nattrib = tiles[k - 1].attrib;
+			}
+
+			p.tileword = 0;
+			p.attrib = p.nattrib;
+			p.endx = xw < 160 ? xw + 8 : 168;
+			loadFetchedTile(p, tiles[k]);
+			xpos = xw + 8;
+		}
+	}
+
+	if (xpos < xlast) {
+		p.ntileword = tiles[max_tile_run - 1].tileword;
+
+		if (p.cgb)
+			p.nattrib = tiles[max_tile_run - 1].attrib;
+	}
+
+	if (fineScroll) {
+		p.tileword = p.ntileword >> fineScroll * 2;
+		p.attrib = p.nattrib;
+		p.endx = 168;
+		p.reg1    = tiles[max_tile_run].tno;
+		p.nattrib = tiles[max_tile_run].attrib;
+
+		if (fineScroll >= 3)
+			p.reg0 = tiles[max_tile_run].byte0;
+		if (fineScroll >= 5)
+			p.ntileword = tiles[max_tile_run].tileword;
+	}
+
+	p.xpos = 168;
+	p.cycles -= m3cycles;
+	xpos168(p);
+
+	return true;
+}
+
 static bool handleWinDrawStartReq(PPUPriv const &p, int const xpos, unsigned char &winDrawState) {
 	bool const startWinDraw = (xpos < 167 || p.cgb)
 	                       && (winDrawState &= win_draw_started);
@@ -1431,7 +1701,9 @@ namespace M2_LyNon0 {
 namespace gambatte {
 
 PPUPriv::PPUPriv(NextM0Time &nextM0Time, unsigned char const *const oamram, unsigned char const *const vram)
-: nextSprite(0)
+: lineFlushed(0)
+, hashLines(false)
+, nextSprite(0)
 , currentSprite(0xFF)
 , vram(vram)
 , nextCallPtr(&M2_Ly0::f0_)
@@ -1459,6 +1731,9 @@ PPUPriv::PPUPriv(NextM0Time &nextM0Time, unsigned char const *const oamram, unsi
 , cgb(false)
 , weMaster(false)
 {
+	std::memset(palette, 0, sizeof palette);
+	std::memset(lineBuf, 0, sizeof lineBuf);
+	std::memset(lineHash, 0, sizeof lineHash);
 	std::memset(spriteList, 0, sizeof spriteList);
 	std::memset(spwordList, 0, sizeof spwordList);
 }
@@ -1652,6 +1927,19 @@ void PPU::loadState(SaveState const &ss, unsigned char const *const oamram) {
 		p_.cycles = vcycs - 70224;
 		p_.nextCallPtr = &M2_Ly0::f0_;
 	}
+
+	// what was drawn of the current line before the state was saved is gone
+	p_.lineFlushed = M3Loop::lineXpos(p_);
+}
+
+PPU::PPU(NextM0Time &nextM0Time, unsigned char const *oamram, unsigned char const *vram)
+: p_(nextM0Time, oamram, vram)
+, doneFrameHash_(0)
+{
+	std::memset(framePalette_, 0, sizeof framePalette_);
+	std::memset(donePalette_, 0, sizeof donePalette_);
+	std::memset(doneLineHash_, 0, sizeof doneLineHash_);
+	std::memset(doneDirtyLines_, 0, sizeof doneDirtyLines_);
 }
 
 void PPU::reset(unsigned char const *oamram, unsigned char const *vram, bool cgb) {
@@ -1660,18 +1948,8 @@ void PPU::reset(unsigned char const *oamram, unsigned char const *vram, bool cgb
 	p_.spriteMapper.reset(oamram, cgb);
 }
 
-void PPU::resetCc(unsigned long const oldCc, unsigned long const newCc) {
-	unsigned long const dec = oldCc - newCc;
-	unsigned long const videoCycles = lcdcEn(p_) ? p_.lyCounter.frameCycles(p_.now) : 0;
-
-	p_.now -= dec;
-	p_.lastM0Time = p_.lastM0Time ? p_.lastM0Time - dec : p_.lastM0Time;
-	p_.lyCounter.reset(videoCycles, p_.now);
-	p_.spriteMapper.resetCycleCounter(oldCc, newCc);
-}
-
-void PPU::speedChange(unsigned long const cycleCounter) {
-	unsigned long const videoCycles = lcdcEn(p_) ? p_.lyCounter.frameCycles(p_.now) : 0;
+void PPU::speedChange(cycle_t const cycleCounter) {
+	cycle_t const videoCycles = lcdcEn(p_) ? p_.lyCounter.frameCycles(p_.now) : 0;
 
 	p_.spriteMapper.preSpeedChange(cycleCounter);
 	p_.lyCounter.setDoubleSpeed(!p_.lyCounter.isDoubleSpeed());
@@ -1686,12 +1964,12 @@ void PPU::speedChange(unsigned long const cycleCounter) {
 	}
 }
 
-unsigned long PPU::predictedNextXposTime(unsigned xpos) const {
+cycle_t PPU::predictedNextXposTime(unsigned xpos) const {
 	return p_.now
 	    + (p_.nextCallPtr->predictCyclesUntilXpos_f(p_, xpos, -p_.cycles) << p_.lyCounter.isDoubleSpeed());
 }
 
-void PPU::setLcdc(unsigned const lcdc, unsigned long const cc) {
+void PPU::setLcdc(unsigned const lcdc, cycle_t const cc) {
 	if ((p_.lcdc ^ lcdc) & lcdc & lcdc_en) {
 		p_.now = cc;
 		p_.lastM0Time = 0;
@@ -1721,16 +1999,57 @@ void PPU::setLcdc(unsigned const lcdc, unsigned long const cc) {
 	p_.lcdc = lcdc;
 }
 
-void PPU::update(unsigned long const cc) {
+void PPU::setPaletteColor(unsigned const slot, uint_least32_t const color) {
+	if (p_.palette[slot] == color)
+		return;
+
+	unsigned const pos = lcdcEn(p_) && p_.lyCounter.ly() < 144 ? M3Loop::nextPixelPos(p_) : 0;
+
+	if (pos) {
+		// pixels already drawn keep the old colour
+		M3Loop::flushLine(p_, M3Loop::lineXpos(p_));
+
+		if (p_.framebuf.format() == PIXEL_INDEXED8) {
+			PaletteChange const change = { pos, static_cast<unsigned char>(slot), color };
+			changes_.push_back(change);
+		}
+	} else
+		framePalette_[slot] = color;
+
+	p_.palette[slot] = color;
+}
+
+void PPU::endFrame() {
+	std::memcpy(donePalette_, framePalette_, sizeof donePalette_);
+	doneChanges_.swap(changes_);
+	changes_.clear();
+	std::memcpy(framePalette_, p_.palette, sizeof framePalette_);
+
+	// lines that were not drawn keep their contents and hash
+	std::memset(doneDirtyLines_, 0, sizeof doneDirtyLines_);
+
+	for (unsigned ly = 0; ly < 144; ++ly) {
+		if (p_.lineHash[ly] != doneLineHash_[ly] || !p_.lineHash[ly])
+			doneDirtyLines_[ly >> 3] |= 1 << (ly & 7);
+	}
+
+	std::memcpy(doneLineHash_, p_.lineHash, sizeof doneLineHash_);
+	doneFrameHash_ = hash64(doneLineHash_, sizeof doneLineHash_);
+}
+
+void PPU::rehashLines() {
+	for (unsigned ly = 0; ly < 144; ++ly)
+		M3Loop::hashLine(p_, ly);
+}
+
+void PPU::update(cycle_t const cc) {
 	int const cycles = (cc - p_.now) >> p_.lyCounter.isDoubleSpeed();
 
 	p_.now += cycles << p_.lyCounter.isDoubleSpeed();
 	p_.cycles += cycles;
 
-	if (p_.cycles >= 0) {
-		p_.framebuf.setFbline(p_.lyCounter.ly());
+	if (p_.cycles >= 0)
 		p_.nextCallPtr->f(p_);
-	}
 }
 
 }
@@ -22,27 +22,40 @@
 #include "lcddef.h"
 #include "ly_counter.h"
 #include "sprite_mapper.h"
+#include "tile_cache.h"
 #include "gbint.h"
 #include "gambatte.h"
 #include <cstddef>
+#include <vector>
 
 namespace gambatte {
 
+enum { num_palette_slots = 64, sp_palette_slot = 32 };
+
 class PPUFrameBuf {
 public:
-	PPUFrameBuf() : buf_(0), fbline_(nullfbline()), pitch_(0) {}
-	video_pixel_t * fb() const { return buf_; }
-	video_pixel_t * fbline() const { return fbline_; }
+	PPUFrameBuf() : buf_(0), pitch_(0), format_(PIXEL_NATIVE) {}
+	void * fb() const { return buf_; }
 	std::ptrdiff_t pitch() const { return pitch_; }
-	void setBuf(video_pixel_t *buf, std::ptrdiff_t pitch) { buf_ = buf; pitch_ = pitch; fbline_ = nullfbline(); }
-	void setFbline(unsigned ly) { fbline_ = buf_ ? buf_ + std::ptrdiff_t(ly) * pitch_ : nullfbline(); }
+	PixelFormat format() const { return format_; }
+	void setBuf(void *buf, std::ptrdiff_t pitch) { buf_ = buf; pitch_ = pitch; }
+	void setFormat(PixelFormat format) { format_ = format; }
+
+	template<typename T>
+	T * line(unsigned ly) const { return static_cast<T *>(buf_) + std::ptrdiff_t(ly) * pitch_; }
+
+	std::size_t pixelSize() const {
+		return format_ == PIXEL_RGB32 ? 4 : format_ == PIXEL_RGB565 || format_ == PIXEL_XRGB1555 ? 2 : 1;
+	}
+
+	unsigned char * lineBytes(unsigned ly) const {
+		return static_cast<unsigned char *>(buf_) + std::ptrdiff_t(ly) * pitch_ * pixelSize();
+	}
 
 private:
-	video_pixel_t *buf_;
-	video_pixel_t *fbline_;
+	void *buf_;
 	std::ptrdiff_t pitch_;
-
-	static video_pixel_t * nullfbline() { static video_pixel_t nullfbline_[160]; return nullfbline_; }
+	PixelFormat format_;
 };
 
 struct PPUPriv;
@@ -54,8 +67,18 @@ struct PPUState {
 };
 
 struct PPUPriv {
-	video_pixel_t bgPalette[8 * 4];
-	video_pixel_t spPalette[8 * 4];
+	// background palettes in slots 0-31, sprite palettes from sp_palette_slot
+	uint_least32_t palette[num_palette_slots];
+	// palette slots drawn on the current line, converted to framebuf
+	// pixels up to the line position when mode 3 ends, a palette changes or
+	// a background run is written to framebuf directly
+	unsigned char lineBuf[160];
+	// pixels of the current line in framebuf
+	unsigned char lineFlushed;
+	// hash of each frame buffer line as last drawn, 0 without a frame buffer
+	// or before anything asked for the hashes
+	uint64_t lineHash[144];
+	mutable bool hashLines;
 	struct Sprite { unsigned char spx, oampos, line, attrib; } spriteList[11];
 	unsigned short spwordList[11];
 	unsigned char nextSprite;
@@ -64,8 +87,8 @@ struct PPUPriv {
 	unsigned char const *vram;
 	PPUState const *nextCallPtr;
 
-	unsigned long now;
-	unsigned long lastM0Time;
+	cycle_t now;
+	cycle_t lastM0Time;
 	long cycles;
 
 	unsigned tileword;
@@ -74,6 +97,7 @@ struct PPUPriv {
 	SpriteMapper spriteMapper;
 	LyCounter lyCounter;
 	PPUFrameBuf framebuf;
+	TileCache tileCache;
 
 	unsigned char lcdc;
 	unsigned char scy;
@@ -99,46 +123,66 @@ struct PPUPriv {
 
 class PPU {
 public:
-	PPU(NextM0Time &nextM0Time, unsigned char const *oamram, unsigned char const *vram)
-	: p_(nextM0Time, oamram, vram)
-	{
-	}
+	PPU(NextM0Time &nextM0Time, unsigned char const *oamram, unsigned char const *vram);
 
-	video_pixel_t * bgPalette() { return p_.bgPalette; }
+	uint_least32_t const * bgPalette() const { return p_.palette; }
 	bool cgb() const { return p_.cgb; }
 	void doLyCountEvent() { p_.lyCounter.doEvent(); }
-	unsigned long doSpriteMapEvent(unsigned long time) { return p_.spriteMapper.doEvent(time); }
+	cycle_t doSpriteMapEvent(cycle_t time) { return p_.spriteMapper.doEvent(time); }
 	PPUFrameBuf const & frameBuf() const { return p_.framebuf; }
 
-	bool inactivePeriodAfterDisplayEnable(unsigned long cc) const {
+	bool inactivePeriodAfterDisplayEnable(cycle_t cc) const {
 		return p_.spriteMapper.inactivePeriodAfterDisplayEnable(cc);
 	}
 
-	unsigned long lastM0Time() const { return p_.lastM0Time; }
+	cycle_t lastM0Time() const { return p_.lastM0Time; }
 	unsigned lcdc() const { return p_.lcdc; }
 	void loadState(SaveState const &state, unsigned char const *oamram);
 	LyCounter const & lyCounter() const { return p_.lyCounter; }
-	unsigned long now() const { return p_.now; }
-	void oamChange(unsigned long cc) { p_.spriteMapper.oamChange(cc); }
-	void oamChange(unsigned char const *oamram, unsigned long cc) { p_.spriteMapper.oamChange(oamram, cc); }
-	unsigned long predictedNextXposTime(unsigned xpos) const;
+	cycle_t now() const { return p_.now; }
+	void oamChange(cycle_t cc) { p_.spriteMapper.oamChange(cc); }
+	void oamChange(unsigned char const *oamram, cycle_t cc) { p_.spriteMapper.oamChange(oamram, cc); }
+	cycle_t predictedNextXposTime(unsigned xpos) const;
 	void reset(unsigned char const *oamram, unsigned char const *vram, bool cgb);
-	void resetCc(unsigned long oldCc, unsigned long newCc);
 	void saveState(SaveState &ss) const;
-	void setFrameBuf(video_pixel_t *buf, std::ptrdiff_t pitch) { p_.framebuf.setBuf(buf, pitch); }
-	void setLcdc(unsigned lcdc, unsigned long cc);
+	void setFrameBuf(void *buf, std::ptrdiff_t pitch) { p_.framebuf.setBuf(buf, pitch); }
+	void setPixelFormat(PixelFormat format) { p_.framebuf.setFormat(format); }
+	void setPaletteColor(unsigned slot, uint_least32_t color);
+	void endFrame();
+	uint_least32_t const * framePalette() const { return donePalette_; }
+	std::vector<PaletteChange> const & paletteChanges() const { return doneChanges_; }
+	// lines are hashed from the first request for anything built on the hashes
+	unsigned char const * dirtyLines() const { p_.hashLines = true; return doneDirtyLines_; }
+	uint64_t const * lineHashes() const { p_.hashLines = true; return doneLineHash_; }
+	uint64_t frameHash() const { p_.hashLines = true; return doneFrameHash_; }
+	void rehashLines();
+	void tileDataChange(unsigned p) { p_.tileCache.vramChange(p_.vram, p); }
+	void tileDataChange(unsigned p, unsigned n) { p_.tileCache.vramChange(p_.vram, p, n); }
+	void refreshTileCache() { p_.tileCache.reset(p_.vram); }
+	TileCache const & tileCache() const { return p_.tileCache; }
+	unsigned char const * vram() const { return p_.vram; }
+	void setLcdc(unsigned lcdc, cycle_t cc);
 	void setScx(unsigned scx) { p_.scx = scx; }
 	void setScy(unsigned scy) { p_.scy = scy; }
 	void setStatePtrs(SaveState &ss) { p_.spriteMapper.setStatePtrs(ss); }
 	void setWx(unsigned wx) { p_.wx = wx; }
 	void setWy(unsigned wy) { p_.wy = wy; }
 	void updateWy2() { p_.wy2 = p_.wy; }
-	void speedChange(unsigned long cycleCounter);
-	video_pixel_t * spPalette() { return p_.spPalette; }
-	void update(unsigned long cc);
+	void speedChange(cycle_t cycleCounter);
+	uint_least32_t const * spPalette() const { return p_.palette + sp_palette_slot; }
+	void update(cycle_t cc);
 
 private:
 	PPUPriv p_;
+	// palette at the start of the frame being drawn, and the changes made
+	// after its first pixel; the done ones belong to the last finished frame
+	uint_least32_t framePalette_[num_palette_slots];
+	uint_least32_t donePalette_[num_palette_slots];
+	std::vector<PaletteChange> changes_;
+	std::vector<PaletteChange> doneChanges_;
+	uint64_t doneLineHash_[144];
+	uint64_t doneFrameHash_;
+	unsigned char doneDirtyLines_[144 / 8];
 };
 
 }
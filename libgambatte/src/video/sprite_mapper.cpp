@@ -65,7 +65,7 @@ void SpriteMapper::OamReader::reset(unsigned char const *const oamram, bool cons
 	}
 }
 
-static unsigned toPosCycles(unsigned long const cc, LyCounter const &lyCounter) {
+static unsigned toPosCycles(cycle_t const cc, LyCounter const &lyCounter) {
 	unsigned lc = lyCounter.lineCycles(cc) + 3 - lyCounter.isDoubleSpeed() * 3u;
 	if (lc >= 456)
 		lc -= 456;
@@ -73,7 +73,7 @@ static unsigned toPosCycles(unsigned long const cc, LyCounter const &lyCounter)
 	return lc;
 }
 
-void SpriteMapper::OamReader::update(unsigned long const cc) {
+void SpriteMapper::OamReader::update(cycle_t const cc) {
 	if (cc > lu_) {
 		if (changed()) {
 			unsigned const lulc = toPosCycles(lu_, lyCounter_);
@@ -115,7 +115,7 @@ void SpriteMapper::OamReader::update(unsigned long const cc) {
 	}
 }
 
-void SpriteMapper::OamReader::change(unsigned long cc) {
+void SpriteMapper::OamReader::change(cycle_t cc) {
 	update(cc);
 	lastChange_ = std::min(toPosCycles(lu_, lyCounter_), 80u);
 }
@@ -132,7 +132,7 @@ void SpriteMapper::OamReader::loadState(SaveState const &ss, unsigned char const
 	change(lu_);
 }
 
-void SpriteMapper::OamReader::enableDisplay(unsigned long cc) {
+void SpriteMapper::OamReader::enableDisplay(cycle_t cc) {
 	std::memset(buf_, 0x00, sizeof buf_);
 	std::fill(szbuf_, szbuf_ + 40, false);
 	lu_ = cc + (80 << lyCounter_.isDoubleSpeed());
@@ -155,30 +155,101 @@ void SpriteMapper::reset(unsigned char const *oamram, bool cgb) {
 
 void SpriteMapper::clearMap() {
 	std::memset(num_, need_sorting_mask, sizeof num_);
+	mapped_ = false;
 }
 
-void SpriteMapper::mapSprites() {
-	clearMap();
+// Lines [first, end) shown by a sprite at ypos, if any.
+static bool spriteLines(unsigned const ypos, bool const large, unsigned &first, unsigned &end) {
+	int const spriteHeight = 8 << large;
+	unsigned const bottomPos = ypos - (17u - spriteHeight);
+
+	if (bottomPos >= 143u + spriteHeight)
+		return false;
+
+	first = std::max(int(bottomPos) + 1 - spriteHeight, 0);
+	end = std::min(bottomPos, 143u) + 1;
+	return true;
+}
+
+static void markLines(bool *const dirty, unsigned const ypos, bool const large) {
+	unsigned first, end;
+	if (spriteLines(ypos, large, first, end))
+		std::fill(dirty + first, dirty + end, true);
+}
+
+// Marks the lines covered by a changed sprite, before or after, and returns how
+// many there are.
+unsigned SpriteMapper::markChangedLines(bool *const dirty) const {
+	if (!mapped_) {
+		std::fill(dirty, dirty + 144, true);
+		return 144;
+	}
+
+	std::fill(dirty, dirty + 144, false);
 
 	for (unsigned i = 0x00; i < 0x50; i += 2) {
-		int const spriteHeight = 8 << largeSprites(i >> 1);
-		unsigned const bottomPos = posbuf()[i] - (17u - spriteHeight);
+		if (posbuf()[i] != mappedPos_[i] || posbuf()[i + 1] != mappedPos_[i + 1]
+				|| largeSprites(i >> 1) != mappedLarge_[i >> 1]) {
+			markLines(dirty, mappedPos_[i], mappedLarge_[i >> 1]);
+			markLines(dirty, posbuf()[i], largeSprites(i >> 1));
+		}
+	}
+
+	return std::count(dirty, dirty + 144, true);
+}
 
-		if (bottomPos < 143u + spriteHeight) {
-			unsigned const startly = std::max(int(bottomPos) + 1 - spriteHeight, 0);
-			unsigned char *map = spritemap_ + startly * 10;
-			unsigned char *n   = num_       + startly;
-			unsigned char *const nend = num_ + std::min(bottomPos, 143u) + 1;
+// OAM DMA rewrites every sprite each frame, but usually only a few of them move,
+// so only the lines covered by a changed sprite, before or after, are rebuilt.
+// With nearly every line changed there is little left to skip, and the plain
+// rebuild of every line saves checking each one.
+void SpriteMapper::mapSprites() {
+	bool dirty[144];
+	unsigned const numDirty = markChangedLines(dirty);
+	if (!numDirty)
+		return;
+
+	if (numDirty < full_remap_lines) {
+		for (unsigned ly = 0; ly < 144; ++ly) {
+			if (dirty[ly])
+				num_[ly] = need_sorting_mask;
+		}
 
-			do {
-				if (*n < need_sorting_mask + 10)
-					map[(*n)++ - need_sorting_mask] = i;
+		for (unsigned i = 0x00; i < 0x50; i += 2) {
+			unsigned first, end;
+			if (spriteLines(posbuf()[i], largeSprites(i >> 1), first, end)) {
+				unsigned char *map = spritemap_ + first * 10;
 
-				map += 10;
-			} while (++n != nend);
+				for (unsigned ly = first; ly != end; ++ly, map += 10) {
+					if (dirty[ly] && num_[ly] < need_sorting_mask + 10)
+						map[num_[ly]++ - need_sorting_mask] = i;
+				}
+			}
+		}
+	} else {
+		std::memset(num_, need_sorting_mask, sizeof num_);
+
+		for (unsigned i = 0x00; i < 0x50; i += 2) {
+			unsigned first, end;
+			if (spriteLines(posbuf()[i], largeSprites(i >> 1), first, end)) {
+				unsigned char *map = spritemap_ + first * 10;
+				unsigned char *n   = num_       + first;
+				unsigned char *const nend = num_ + end;
+
+				do {
+					if (*n < need_sorting_mask + 10)
+						map[(*n)++ - need_sorting_mask] = i;
+
+					map += 10;
+				} while (++n != nend);
+			}
 		}
 	}
 
+	for (unsigned i = 0; i < 40; ++i)
+		mappedLarge_[i] = largeSprites(i);
+
+	std::memcpy(mappedPos_, posbuf(), sizeof mappedPos_);
+	mapped_ = true;
 	nextM0Time_.invalidatePredictedNextM0Time();
 }
 
@@ -188,12 +259,12 @@ void SpriteMapper::sortLine(unsigned const ly) const {
 	              SpxLess(posbuf() + 1));
 }
 
-unsigned long SpriteMapper::doEvent(unsigned long const time) {
+cycle_t SpriteMapper::doEvent(cycle_t const time) {
 	oamReader_.update(time);
 	mapSprites();
 	return oamReader_.changed()
 	     ? time + oamReader_.lineTime()
-	     : static_cast<unsigned long>(disabled_time);
+	     : disabled_time;
 }
 
 }
@@ -32,20 +32,15 @@ public:
 	             LyCounter const &lyCounter,
 	             unsigned char const *oamram);
 	void reset(unsigned char const *oamram, bool cgb);
-	unsigned long doEvent(unsigned long time);
+	cycle_t doEvent(cycle_t time);
 	bool largeSprites(unsigned spNo) const { return oamReader_.largeSprites(spNo); }
 	unsigned numSprites(unsigned ly) const { return num_[ly] & ~need_sorting_mask; }
-	void oamChange(unsigned long cc) { oamReader_.change(cc); }
-	void oamChange(unsigned char const *oamram, unsigned long cc) { oamReader_.change(oamram, cc); }
+	void oamChange(cycle_t cc) { oamReader_.change(cc); }
+	void oamChange(unsigned char const *oamram, cycle_t cc) { oamReader_.change(oamram, cc); }
 	unsigned char const * oamram() const { return oamReader_.oam(); }
 	unsigned char const * posbuf() const { return oamReader_.spritePosBuf(); }
-	void  preSpeedChange(unsigned long cc) { oamReader_.update(cc); }
-	void postSpeedChange(unsigned long cc) { oamReader_.change(cc); }
-
-	void resetCycleCounter(unsigned long oldCc, unsigned long newCc) {
-		oamReader_.update(oldCc);
-		oamReader_.resetCycleCounter(oldCc, newCc);
-	}
+	void  preSpeedChange(cycle_t cc) { oamReader_.update(cc); }
+	void postSpeedChange(cycle_t cc) { oamReader_.change(cc); }
 
 	void setLargeSpritesSource(bool src) { oamReader_.setLargeSpritesSrc(src); }
 
@@ -57,19 +52,20 @@ public:
 	}
 
 	void setStatePtrs(SaveState &state) { oamReader_.setStatePtrs(state); }
-	void enableDisplay(unsigned long cc) { oamReader_.enableDisplay(cc); }
+	void enableDisplay(cycle_t cc) { oamReader_.enableDisplay(cc); }
 	void saveState(SaveState &state) const { oamReader_.saveState(state); }
 
 	void loadState(SaveState const &state, unsigned char const *oamram) {
 		oamReader_.loadState(state, oamram);
+		clearMap();
 		mapSprites();
 	}
 
-	bool inactivePeriodAfterDisplayEnable(unsigned long cc) const {
+	bool inactivePeriodAfterDisplayEnable(cycle_t cc) const {
 		return oamReader_.inactivePeriodAfterDisplayEnable(cc);
 	}
 
-	static unsigned long schedule(LyCounter const &lyCounter, unsigned long cc) {
+	static cycle_t schedule(LyCounter const &lyCounter, cycle_t cc) {
 		return lyCounter.nextLineCycle(80, cc);
 	}
 
@@ -78,20 +74,19 @@ private:
 	public:
 		OamReader(LyCounter const &lyCounter, unsigned char const *oamram);
 		void reset(unsigned char const *oamram, bool cgb);
-		void change(unsigned long cc);
-		void change(unsigned char const *oamram, unsigned long cc) { change(cc); oamram_ = oamram; }
+		void change(cycle_t cc);
+		void change(unsigned char const *oamram, cycle_t cc) { change(cc); oamram_ = oamram; }
 		bool changed() const { return lastChange_ != 0xFF; }
 		bool largeSprites(unsigned spNo) const { return szbuf_[spNo]; }
 		unsigned char const * oam() const { return oamram_; }
-		void resetCycleCounter(unsigned long oldCc, unsigned long newCc) { lu_ -= oldCc - newCc; }
 		void setLargeSpritesSrc(bool src) { largeSpritesSrc_ = src; }
-		void update(unsigned long cc);
+		void update(cycle_t cc);
 		unsigned char const * spritePosBuf() const { return buf_; }
 		void setStatePtrs(SaveState &state);
-		void enableDisplay(unsigned long cc);
+		void enableDisplay(cycle_t cc);
 		void saveState(SaveState &state) const { state.ppu.enableDisplayM0Time = lu_; }
 		void loadState(SaveState const &ss, unsigned char const *oamram);
-		bool inactivePeriodAfterDisplayEnable(unsigned long cc) const { return cc < lu_; }
+		bool inactivePeriodAfterDisplayEnable(cycle_t cc) const { return cc < lu_; }
 		unsigned lineTime() const { return lyCounter_.lineTime(); }
 
 	private:
@@ -99,20 +94,27 @@ private:
 		bool szbuf_[40];
 		LyCounter const &lyCounter_;
 		unsigned char const *oamram_;
-		unsigned long lu_;
+		cycle_t lu_;
 		unsigned char lastChange_;
 		bool largeSpritesSrc_;
 		bool cgb_;
 	};
 
 	enum { need_sorting_mask = 0x80 };
+	// changed lines from which a remap rebuilds every line
+	enum { full_remap_lines = 128 };
 
 	mutable unsigned char spritemap_[144 * 10];
 	mutable unsigned char num_[144];
+	// sprite positions and sizes spritemap_ was built from
+	unsigned char mappedPos_[80];
+	bool mappedLarge_[40];
+	bool mapped_;
 	NextM0Time &nextM0Time_;
 	OamReader oamReader_;
 
 	void clearMap();
+	unsigned markChangedLines(bool *dirty) const;
 	void mapSprites();
 	void sortLine(unsigned ly) const;
 };
@@ -0,0 +1,53 @@
+//
+//   Copyright (C) 2026 by the gambatte contributors
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License version 2 for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   version 2 along with this program; if not, write to the
+//   Free Software Foundation, Inc.,
+//   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+//
+
+#include "tile_cache.h"
+#include <algorithm>
+
+namespace gambatte {
+
+void TileCache::reset(unsigned char const *const vram) {
+	for (unsigned bank = 0; bank < 2; ++bank) {
+		for (unsigned p = bank * 0x2000; p < bank * 0x2000 + 0x1800; p += 2)
+			decode(vram, p);
+	}
+}
+
+void TileCache::vramChange(unsigned char const *const vram, unsigned p, unsigned const n) {
+	unsigned const end = std::min(p + n, (p & ~0x1FFFu) + 0x1800);
+
+	for (p &= ~1u; p < end; p += 2)
+		decode(vram, p);
+}
+
+void TileCache::decode(unsigned char const *const vram, unsigned const p) {
+	unsigned const b0 = vram[p], b1 = vram[p + 1];
+	unsigned word = 0, flipped = 0;
+
+	for (unsigned x = 0; x < 8; ++x) {
+		unsigned const left  = (b0 >> (7 - x) & 1) | (b1 >> (7 - x) & 1) << 1;
+		unsigned const right = (b0 >>      x  & 1) | (b1 >>      x  & 1) << 1;
+		word    |= left  << x * 2;
+		flipped |= right << x * 2;
+	}
+
+	words_[row(p)][0] = word;
+	words_[row(p)][1] = flipped;
+}
+
+}
@@ -0,0 +1,60 @@
+//
+//   Copyright (C) 2026 by the gambatte contributors
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License version 2 for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   version 2 along with this program; if not, write to the
+//   Free Software Foundation, Inc.,
+//   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+//
+
+#ifndef TILE_CACHE_H
+#define TILE_CACHE_H
+
+namespace gambatte {
+
+// Tile data rows of both VRAM banks, 384 tiles x 8 rows each, expanded to
+// expand_lut words (2 bits per pixel, leftmost pixel in the low bits) as they
+// are and mirrored. Kept current on every VRAM write rather than invalidated,
+// so readers never decode.
+class TileCache {
+public:
+	enum { num_rows = 2 * 384 * 8 };
+
+	void reset(unsigned char const *vram);
+
+	// Call after writing vram[p], p being an offset into both banks.
+	void vramChange(unsigned char const *vram, unsigned p) {
+		if ((p & 0x1FFF) < 0x1800)
+			decode(vram, p & ~1u);
+	}
+
+	// Call after writing vram[p, p + n), which must lie within one bank.
+	void vramChange(unsigned char const *vram, unsigned p, unsigned n);
+
+	// The row whose low byte is at vram offset p, mirrored if xflip is 1.
+	unsigned tileword(unsigned p, unsigned xflip) const { return words_[row(p)][xflip]; }
+
+	// The 8 rows of tile tno (0-383) of bank, top to bottom.
+	unsigned short const (* tile(unsigned bank, unsigned tno) const)[2] {
+		return words_ + bank * 0xC00 + tno * 8;
+	}
+
+private:
+	unsigned short words_[num_rows][2];
+
+	static unsigned row(unsigned p) { return (p >> 13) * 0xC00 + (p >> 1 & 0xFFF); }
+	void decode(unsigned char const *vram, unsigned p);
+};
+
+}
+
+#endif
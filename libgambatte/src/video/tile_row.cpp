@@ -0,0 +1,425 @@
+//
+//   Copyright (C) 2026 by the gambatte contributors
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License version 2 for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   version 2 along with this program; if not, write to the
+//   Free Software Foundation, Inc.,
+//   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+//
+
+#include "tile_row.h"
+#include <cstddef>
+#include <stdint.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TILE_ROW_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+typedef void (*BgTileWriter)(unsigned char *dst, unsigned short const *tilewords,
+                             unsigned char const *palnums, unsigned ntiles);
+
+static void writeBgTilesScalar(unsigned char *dst, unsigned short const *tilewords,
+		unsigned char const *palnums, unsigned ntiles) {
+	for (unsigned t = 0; t < ntiles; ++t) {
+		unsigned const base = palnums ? palnums[t] * 4 : 0;
+		unsigned const tw = tilewords[t];
+
+		dst[0] = base + ( tw        & 3);
+		dst[1] = base + ((tw >>  2) & 3);
+		dst[2] = base + ((tw >>  4) & 3);
+		dst[3] = base + ((tw >>  6) & 3);
+		dst[4] = base + ((tw >>  8) & 3);
+		dst[5] = base + ((tw >> 10) & 3);
+		dst[6] = base + ((tw >> 12) & 3);
+		dst[7] = base + ( tw >> 14     );
+		dst += 8;
+	}
+}
+
+template<typename T>
+static void writeBgTileColorsScalar(T *dst, unsigned short const *tilewords,
+		unsigned char const *palnums, unsigned ntiles, gambatte::uint_least32_t const *palette) {
+	for (unsigned t = 0; t < ntiles; ++t) {
+		gambatte::uint_least32_t const *const pal = palette + (palnums ? palnums[t] * 4 : 0);
+		unsigned const tw = tilewords[t];
+
+		dst[0] = pal[ tw        & 3];
+		dst[1] = pal[(tw >>  2) & 3];
+		dst[2] = pal[(tw >>  4) & 3];
+		dst[3] = pal[(tw >>  6) & 3];
+		dst[4] = pal[(tw >>  8) & 3];
+		dst[5] = pal[(tw >> 10) & 3];
+		dst[6] = pal[(tw >> 12) & 3];
+		dst[7] = pal[ tw >> 14     ];
+		dst += 8;
+	}
+}
+
+template<typename T>
+static void writeSlotColorsScalar(T *dst, unsigned char const *slots,
+		gambatte::uint_least32_t const *palette, unsigned n) {
+	for (unsigned x = 0; x < n; ++x)
+		dst[x] = palette[slots[x]];
+}
+
+#ifdef TILE_ROW_X86
+
+// Lane k of (tileword * (1 << (14 - 2k))) has pixel k in its top two bits.
+__attribute__((target("sse2")))
+static inline __m128i decodeTile(unsigned tw, unsigned base) {
+	__m128i const mul = _mm_setr_epi16(1 << 14, 1 << 12, 1 << 10, 1 << 8, 1 << 6, 1 << 4, 1 << 2, 1);
+	__m128i const idx = _mm_srli_epi16(_mm_mullo_epi16(_mm_set1_epi16(static_cast<short>(tw)), mul), 14);
+	return _mm_add_epi16(idx, _mm_set1_epi16(static_cast<short>(base)));
+}
+
+__attribute__((target("sse2")))
+static void writeBgTilesSse2(unsigned char *dst, unsigned short const *tilewords,
+		unsigned char const *palnums, unsigned ntiles) {
+	unsigned t = 0;
+
+	for (; t + 2 <= ntiles; t += 2, dst += 16) {
+		__m128i const lo = decodeTile(tilewords[t    ], palnums ? palnums[t    ] * 4 : 0);
+		__m128i const hi = decodeTile(tilewords[t + 1], palnums ? palnums[t + 1] * 4 : 0);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_packus_epi16(lo, hi));
+	}
+
+	if (t < ntiles) {
+		__m128i const lo = decodeTile(tilewords[t], palnums ? palnums[t] * 4 : 0);
+		_mm_storel_epi64(reinterpret_cast<__m128i *>(dst), _mm_packus_epi16(lo, lo));
+	}
+}
+
+// Lanes of pal[idx], idx holding colour indices 0-3 in 16-bit lanes, picked
+// by comparing against each index. Colours are truncated to 16 bits.
+__attribute__((target("sse2")))
+static inline __m128i selectColors16(__m128i idx, gambatte::uint_least32_t const *pal) {
+	__m128i r = _mm_set1_epi16(static_cast<short>(pal[0]));
+
+	for (int n = 1; n < 4; ++n) {
+		__m128i const m = _mm_cmpeq_epi16(idx, _mm_set1_epi16(n));
+		r = _mm_or_si128(_mm_andnot_si128(m, r),
+		                 _mm_and_si128(m, _mm_set1_epi16(static_cast<short>(pal[n]))));
+	}
+
+	return r;
+}
+
+__attribute__((target("sse2")))
+static void writeBgTileColorsSse2(uint32_t *dst, unsigned short const *tilewords,
+		unsigned char const *palnums, unsigned ntiles, gambatte::uint_least32_t const *palette) {
+	__m128i const zero = _mm_setzero_si128();
+
+	for (unsigned t = 0; t < ntiles; ++t, dst += 8) {
+		gambatte::uint_least32_t const *const pal = palette + (palnums ? palnums[t] * 4 : 0);
+		__m128i const idx = decodeTile(tilewords[t], 0);
+		__m128i const idxlo = _mm_unpacklo_epi16(idx, zero);
+		__m128i const idxhi = _mm_unpackhi_epi16(idx, zero);
+		__m128i lo = _mm_set1_epi32(static_cast<int>(pal[0]));
+		__m128i hi = lo;
+
+		for (int n = 1; n < 4; ++n) {
+			__m128i const v = _mm_set1_epi32(static_cast<int>(pal[n]));
+			__m128i const mlo = _mm_cmpeq_epi32(idxlo, _mm_set1_epi32(n));
+			__m128i const mhi = _mm_cmpeq_epi32(idxhi, _mm_set1_epi32(n));
+			lo = _mm_or_si128(_mm_andnot_si128(mlo, lo), _mm_and_si128(mlo, v));
+			hi = _mm_or_si128(_mm_andnot_si128(mhi, hi), _mm_and_si128(mhi, v));
+		}
+
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst), lo);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst) + 1, hi);
+	}
+}
+
+__attribute__((target("sse2")))
+static void writeBgTileColorsSse2(uint16_t *dst, unsigned short const *tilewords,
+		unsigned char const *palnums, unsigned ntiles, gambatte::uint_least32_t const *palette) {
+	for (unsigned t = 0; t < ntiles; ++t, dst += 8) {
+		gambatte::uint_least32_t const *const pal = palette + (palnums ? palnums[t] * 4 : 0);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst),
+		                 selectColors16(decodeTile(tilewords[t], 0), pal));
+	}
+}
+
+__attribute__((target("sse2")))
+static void writeBgTileColorsSse2(unsigned char *dst, unsigned short const *tilewords,
+		unsigned char const *palnums, unsigned ntiles, gambatte::uint_least32_t const *palette) {
+	__m128i const lowByte = _mm_set1_epi16(0xFF);
+
+	for (unsigned t = 0; t < ntiles; ++t, dst += 8) {
+		gambatte::uint_least32_t const *const pal = palette + (palnums ? palnums[t] * 4 : 0);
+		__m128i const c = _mm_and_si128(selectColors16(decodeTile(tilewords[t], 0), pal), lowByte);
+		_mm_storel_epi64(reinterpret_cast<__m128i *>(dst), _mm_packus_epi16(c, c));
+	}
+}
+
+// The SSSE3 and AVX2 kernels look colours up with byte shuffles of the four
+// colours of a palette, colour k in bytes 4k to 4k + 3, so they read the
+// palette as 32-bit ints.
+__attribute__((target("ssse3")))
+static inline __m128i loadPalette(gambatte::uint_least32_t const *pal) {
+	return _mm_loadu_si128(reinterpret_cast<__m128i const *>(pal));
+}
+
+__attribute__((target("ssse3")))
+static void writeBgTileColorsSsse3(uint32_t *dst, unsigned short const *tilewords,
+		unsigned char const *palnums, unsigned ntiles, gambatte::uint_least32_t const *palette) {
+	__m128i const bytesel = _mm_set1_epi32(0x03020100);
+
+	for (unsigned t = 0; t < ntiles; ++t, dst += 8) {
+		__m128i const tab = loadPalette(palette + (palnums ? palnums[t] * 4 : 0));
+		__m128i const ctrl = _mm_mullo_epi16(decodeTile(tilewords[t], 0), _mm_set1_epi16(0x0404));
+		__m128i const lo = _mm_add_epi8(_mm_unpacklo_epi16(ctrl, ctrl), bytesel);
+		__m128i const hi = _mm_add_epi8(_mm_unpackhi_epi16(ctrl, ctrl), bytesel);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_shuffle_epi8(tab, lo));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst) + 1, _mm_shuffle_epi8(tab, hi));
+	}
+}
+
+__attribute__((target("ssse3")))
+static void writeBgTileColorsSsse3(uint16_t *dst, unsigned short const *tilewords,
+		unsigned char const *palnums, unsigned ntiles, gambatte::uint_least32_t const *palette) {
+	for (unsigned t = 0; t < ntiles; ++t, dst += 8) {
+		__m128i const tab = loadPalette(palette + (palnums ? palnums[t] * 4 : 0));
+		__m128i const ctrl = _mm_add_epi16(_mm_mullo_epi16(decodeTile(tilewords[t], 0),
+		                                                   _mm_set1_epi16(0x0404)),
+		                                   _mm_set1_epi16(0x0100));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_shuffle_epi8(tab, ctrl));
+	}
+}
+
+__attribute__((target("ssse3")))
+static void writeBgTileColorsSsse3(unsigned char *dst, unsigned short const *tilewords,
+		unsigned char const *palnums, unsigned ntiles, gambatte::uint_least32_t const *palette) {
+	for (unsigned t = 0; t < ntiles; ++t, dst += 8) {
+		__m128i const tab = loadPalette(palette + (palnums ? palnums[t] * 4 : 0));
+		__m128i const ctrl = _mm_slli_epi16(decodeTile(tilewords[t], 0), 2);
+		_mm_storel_epi64(reinterpret_cast<__m128i *>(dst),
+		                 _mm_shuffle_epi8(tab, _mm_packus_epi16(ctrl, ctrl)));
+	}
+}
+
+// The colours of tiles t and t + 1 in the two 128-bit lanes.
+__attribute__((target("avx2")))
+static inline __m256i loadPalettes(gambatte::uint_least32_t const *palette,
+		unsigned char const *palnums, unsigned t) {
+	return _mm256_inserti128_si256(
+		_mm256_castsi128_si256(loadPalette(palette + (palnums ? palnums[t] * 4 : 0))),
+		loadPalette(palette + (palnums ? palnums[t + 1] * 4 : 0)), 1);
+}
+
+// The colour indices of tiles t and t + 1 in the 16-bit lanes of the two
+// 128-bit lanes.
+__attribute__((target("avx2")))
+static inline __m256i decodeTiles(unsigned short const *tilewords, unsigned t) {
+	return _mm256_inserti128_si256(_mm256_castsi128_si256(decodeTile(tilewords[t], 0)),
+	                               decodeTile(tilewords[t + 1], 0), 1);
+}
+
+__attribute__((target("avx2")))
+static void writeBgTileColorsAvx2(uint32_t *dst, unsigned short const *tilewords,
+		unsigned char const *palnums, unsigned ntiles, gambatte::uint_least32_t const *palette) {
+	__m256i const shifts = _mm256_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14);
+
+	for (unsigned t = 0; t < ntiles; ++t, dst += 8) {
+		__m256i const idx = _mm256_and_si256(
+			_mm256_srlv_epi32(_mm256_set1_epi32(tilewords[t]), shifts), _mm256_set1_epi32(3));
+		__m256i const tab = _mm256_castsi128_si256(loadPalette(palette + (palnums ? palnums[t] * 4 : 0)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), _mm256_permutevar8x32_epi32(tab, idx));
+	}
+}
+
+__attribute__((target("avx2")))
+static void writeBgTileColorsAvx2(uint16_t *dst, unsigned short const *tilewords,
+		unsigned char const *palnums, unsigned ntiles, gambatte::uint_least32_t const *palette) {
+	unsigned t = 0;
+
+	for (; t + 2 <= ntiles; t += 2, dst += 16) {
+		__m256i const ctrl = _mm256_add_epi16(_mm256_mullo_epi16(decodeTiles(tilewords, t),
+		                                                         _mm256_set1_epi16(0x0404)),
+		                                      _mm256_set1_epi16(0x0100));
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst),
+		                    _mm256_shuffle_epi8(loadPalettes(palette, palnums, t), ctrl));
+	}
+
+	if (t < ntiles)
+		writeBgTileColorsSsse3(dst, tilewords + t, palnums ? palnums + t : 0, 1, palette);
+}
+
+__attribute__((target("avx2")))
+static void writeBgTileColorsAvx2(unsigned char *dst, unsigned short const *tilewords,
+		unsigned char const *palnums, unsigned ntiles, gambatte::uint_least32_t const *palette) {
+	unsigned t = 0;
+
+	for (; t + 2 <= ntiles; t += 2, dst += 16) {
+		__m256i const ctrl = _mm256_slli_epi16(decodeTiles(tilewords, t), 2);
+		// the pixels of each tile end up in the low quarter of its lane
+		__m256i const px = _mm256_shuffle_epi8(loadPalettes(palette, palnums, t),
+		                                       _mm256_packus_epi16(ctrl, ctrl));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm256_castsi256_si128(
+			_mm256_permute4x64_epi64(px, _MM_SHUFFLE(3, 1, 2, 0))));
+	}
+
+	if (t < ntiles)
+		writeBgTileColorsSsse3(dst, tilewords + t, palnums ? palnums + t : 0, 1, palette);
+}
+
+// The colours of the 8 slots at s. Colours are masked to T as the scalar
+// loop truncates them, so packing them does not saturate.
+__attribute__((target("avx2")))
+static inline __m256i gatherColors(unsigned char const *s,
+		gambatte::uint_least32_t const *palette, int mask) {
+	__m256i const idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const *>(s)));
+	__m256i const colors = _mm256_i32gather_epi32(reinterpret_cast<int const *>(palette), idx, 4);
+	return _mm256_and_si256(colors, _mm256_set1_epi32(mask));
+}
+
+__attribute__((target("avx2")))
+static void writeSlotColorsAvx2(uint32_t *dst, unsigned char const *slots,
+		gambatte::uint_least32_t const *palette, unsigned n) {
+	unsigned x = 0;
+
+	for (; x + 8 <= n; x += 8)
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x), gatherColors(slots + x, palette, -1));
+
+	writeSlotColorsScalar(dst + x, slots + x, palette, n - x);
+}
+
+__attribute__((target("avx2")))
+static void writeSlotColorsAvx2(uint16_t *dst, unsigned char const *slots,
+		gambatte::uint_least32_t const *palette, unsigned n) {
+	unsigned x = 0;
+
+	for (; x + 16 <= n; x += 16) {
+		__m256i const a = gatherColors(slots + x,     palette, 0xFFFF);
+		__m256i const b = gatherColors(slots + x + 8, palette, 0xFFFF);
+		// packing works within 128-bit lanes, leaving the quarters in a, b, a, b order
+		__m256i const ab = _mm256_packus_epi32(a, b);
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x),
+		                    _mm256_permute4x64_epi64(ab, _MM_SHUFFLE(3, 1, 2, 0)));
+	}
+
+	writeSlotColorsScalar(dst + x, slots + x, palette, n - x);
+}
+
+__attribute__((target("avx2")))
+static void writeSlotColorsAvx2(unsigned char *dst, unsigned char const *slots,
+		gambatte::uint_least32_t const *palette, unsigned n) {
+	__m256i const order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+	unsigned x = 0;
+
+	for (; x + 32 <= n; x += 32) {
+		__m256i const ab = _mm256_packus_epi32(gatherColors(slots + x,      palette, 0xFF),
+		                                       gatherColors(slots + x +  8, palette, 0xFF));
+		__m256i const cd = _mm256_packus_epi32(gatherColors(slots + x + 16, palette, 0xFF),
+		                                       gatherColors(slots + x + 24, palette, 0xFF));
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x),
+		                    _mm256_permutevar8x32_epi32(_mm256_packus_epi16(ab, cd), order));
+	}
+
+	writeSlotColorsScalar(dst + x, slots + x, palette, n - x);
+}
+
+#endif
+
+template<typename T>
+struct BgTileColorWriter {
+	typedef void (*Func)(T *dst, unsigned short const *tilewords, unsigned char const *palnums,
+	                     unsigned ntiles, gambatte::uint_least32_t const *palette);
+
+	static Func select() {
+#ifdef TILE_ROW_X86
+		__builtin_cpu_init();
+
+		if (sizeof(gambatte::uint_least32_t) == 4) {
+			if (__builtin_cpu_supports("avx2"))
+				return writeBgTileColorsAvx2;
+			if (__builtin_cpu_supports("ssse3"))
+				return writeBgTileColorsSsse3;
+		}
+
+		if (__builtin_cpu_supports("sse2"))
+			return writeBgTileColorsSse2;
+#endif
+		return writeBgTileColorsScalar<T>;
+	}
+};
+
+template<typename T>
+struct SlotColorWriter {
+	typedef void (*Func)(T *dst, unsigned char const *slots,
+	                     gambatte::uint_least32_t const *palette, unsigned n);
+
+	static Func select() {
+#ifdef TILE_ROW_X86
+		__builtin_cpu_init();
+
+		// the gather reads palette entries as 32-bit ints
+		if (sizeof(gambatte::uint_least32_t) == 4 && __builtin_cpu_supports("avx2"))
+			return writeSlotColorsAvx2;
+#endif
+		return writeSlotColorsScalar<T>;
+	}
+};
+
+static BgTileWriter selectBgTileWriter() {
+#ifdef TILE_ROW_X86
+	__builtin_cpu_init();
+
+	if (__builtin_cpu_supports("sse2"))
+		return writeBgTilesSse2;
+#endif
+	return writeBgTilesScalar;
+}
+
+}
+
+namespace gambatte {
+
+void writeBgTiles(unsigned char *dst, unsigned short const *tilewords,
+                  unsigned char const *palnums, unsigned ntiles) {
+	static BgTileWriter const write = selectBgTileWriter();
+
+	write(dst, tilewords, palnums, ntiles);
+}
+
+template<typename T>
+void writeBgTileColors(T *dst, unsigned short const *tilewords,
+                       unsigned char const *palnums, unsigned ntiles,
+                       uint_least32_t const *palette) {
+	static typename BgTileColorWriter<T>::Func const write = BgTileColorWriter<T>::select();
+
+	write(dst, tilewords, palnums, ntiles, palette);
+}
+
+template<typename T>
+void writeSlotColors(T *dst, unsigned char const *slots,
+                     uint_least32_t const *palette, unsigned n) {
+	static typename SlotColorWriter<T>::Func const write = SlotColorWriter<T>::select();
+
+	write(dst, slots, palette, n);
+}
+
+template void writeBgTileColors<uint32_t>(uint32_t *, unsigned short const *,
+                                          unsigned char const *, unsigned, uint_least32_t const *);
+template void writeBgTileColors<uint16_t>(uint16_t *, unsigned short const *,
+                                          unsigned char const *, unsigned, uint_least32_t const *);
+template void writeBgTileColors<unsigned char>(unsigned char *, unsigned short const *,
+                                               unsigned char const *, unsigned, uint_least32_t const *);
+
+template void writeSlotColors<uint32_t>(uint32_t *, unsigned char const *, uint_least32_t const *, unsigned);
+template void writeSlotColors<uint16_t>(uint16_t *, unsigned char const *, uint_least32_t const *, unsigned);
+template void writeSlotColors<unsigned char>(unsigned char *, unsigned char const *, uint_least32_t const *, unsigned);
+
+}
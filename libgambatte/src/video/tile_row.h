@@ -0,0 +1,56 @@
+//
+//   Copyright (C) 2026 by the gambatte contributors
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License version 2 for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   version 2 along with this program; if not, write to the
+//   Free Software Foundation, Inc.,
+//   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+//
+
+#ifndef TILE_ROW_H
+#define TILE_ROW_H
+
+#include "gbint.h"
+
+namespace gambatte {
+
+enum { max_tile_run = 21 };
+
+// Writes ntiles * 8 background palette slots to dst. tilewords holds one
+// expand_lut word per tile (2 bits per pixel, leftmost pixel in the low bits)
+// and palnums the 4-colour palette number of each tile, or 0 to use palette 0
+// throughout. Pixel i of tile t becomes palnums[t] * 4 + colour index.
+// Uses an SSE2 kernel where the host supports it; the output is identical to
+// the scalar loop.
+void writeBgTiles(unsigned char *dst, unsigned short const *tilewords,
+                  unsigned char const *palnums, unsigned ntiles);
+
+// Writes the pixels of writeBgTiles to dst as colours, looking each slot up
+// in palette, which holds colours in the format of T as for writeSlotColors.
+// Uses the widest of the AVX2, SSSE3 and SSE2 kernels the host supports; the
+// output is identical to the scalar loop.
+template<typename T>
+void writeBgTileColors(T *dst, unsigned short const *tilewords,
+                       unsigned char const *palnums, unsigned ntiles,
+                       uint_least32_t const *palette);
+
+// Writes dst[x] = palette[slots[x]] for x in [0, n), palette holding colours
+// in the format of T, which is 1, 2 or 4 bytes wide. Uses an AVX2 gather
+// kernel where the host supports it; the output is identical to the scalar
+// loop.
+template<typename T>
+void writeSlotColors(T *dst, unsigned char const *slots,
+                     uint_least32_t const *palette, unsigned n);
+
+}
+
+#endif
@@ -0,0 +1,153 @@
+//
+//   Copyright (C) 2026 by the gambatte contributors
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License version 2 for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   version 2 along with this program; if not, write to the
+//   Free Software Foundation, Inc.,
+//   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+//
+
+#include "vram_viewer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace gambatte {
+
+enum { vram_size = 0x4000, num_tiles = 2 * 384 };
+
+// Draws a tile at dst, flipped as attrib says. Colour 0 is drawn as 0 when
+// transparent, as for sprites.
+static void drawTile(uint_least32_t *dst, std::ptrdiff_t const pitch,
+		unsigned short const (*rows)[2], unsigned const attrib,
+		uint_least32_t const *const colors, bool const transparent) {
+	unsigned const xflip = attrib >> 5 & 1;
+
+	for (unsigned r = 0; r < 8; ++r, dst += pitch) {
+		unsigned word = rows[attrib & 0x40 ? 7 - r : r][xflip];
+
+		for (unsigned x = 0; x < 8; ++x, word >>= 2) {
+			unsigned const c = word & 3;
+			dst[x] = c || !transparent ? colors[c] : 0;
+		}
+	}
+}
+
+bool VramViewer::View::begin(uint_least32_t *const nbuf, std::ptrdiff_t const npitch,
+		unsigned const nkey, Source const &src) {
+	bool const full = vram.empty() || buf != nbuf || pitch != npitch || key != nkey
+	               || std::memcmp(palette, src.palette, sizeof palette);
+	buf = nbuf;
+	pitch = npitch;
+	key = nkey;
+	return full;
+}
+
+void VramViewer::View::end(Source const &src) {
+	vram.assign(src.vram, src.vram + vram_size);
+	std::memcpy(palette, src.palette, sizeof palette);
+}
+
+void VramViewer::View::changedTiles(bool *const changed, Source const &src) const {
+	for (unsigned t = 0; t < num_tiles; ++t) {
+		unsigned const p = (t / 384) * 0x2000 + (t % 384) * 16;
+		changed[t] = std::memcmp(&vram[p], src.vram + p, 16) != 0;
+	}
+}
+
+// 16 tiles per row, bank 0 in the left half and bank 1 in the right.
+void VramViewer::drawTileSheet(uint_least32_t *const buf, std::ptrdiff_t const pitch,
+		unsigned const palette, Source const &src) {
+	bool changed[num_tiles];
+	if (sheet_.begin(buf, pitch, palette, src))
+		std::fill(changed, changed + num_tiles, true);
+	else
+		sheet_.changedTiles(changed, src);
+
+	for (unsigned t = 0; t < num_tiles; ++t) {
+		if (changed[t]) {
+			unsigned const bank = t / 384, tno = t % 384;
+			drawTile(buf + (tno / 16 * 8) * pitch + bank * 128 + tno % 16 * 8, pitch,
+			         src.tiles.tile(bank, tno), 0, src.palette + (palette & 15) * 4, false);
+		}
+	}
+
+	sheet_.end(src);
+}
+
+// The map as the background would show it, with the current tile data area
+// and, in CGB mode, each entry's bank, palette and flips.
+void VramViewer::drawTileMap(uint_least32_t *const buf, std::ptrdiff_t const pitch,
+		unsigned const map, Source const &src) {
+	View &view = maps_[map & 1];
+	unsigned const mapOffset = 0x1800 + (map & 1) * 0x400;
+	bool const full = view.begin(buf, pitch, src.lcdc & 0x10, src);
+	bool changed[num_tiles];
+	if (!full)
+		view.changedTiles(changed, src);
+
+	for (unsigned i = 0; i < 32 * 32; ++i) {
+		unsigned const tno    = src.vram[mapOffset + i];
+		unsigned const attrib = src.cgb ? src.vram[mapOffset + i + 0x2000] : 0;
+		unsigned const index  = src.lcdc & 0x10 || tno >= 0x80 ? tno : tno + 0x100;
+		unsigned const bank   = attrib >> 3 & 1;
+
+		if (full || changed[bank * 384 + index]
+				|| view.vram[mapOffset + i] != tno
+				|| view.vram[mapOffset + i + 0x2000] != src.vram[mapOffset + i + 0x2000]) {
+			drawTile(buf + (i / 32 * 8) * pitch + i % 32 * 8, pitch,
+			         src.tiles.tile(bank, index), attrib, src.palette + (attrib & 7) * 4, false);
+		}
+	}
+
+	view.end(src);
+}
+
+// The 40 OAM entries as 8x16 cells, 8 per row. 8x8 sprites leave the lower
+// half of their cell, and every sprite its transparent pixels, 0.
+void VramViewer::drawSprites(uint_least32_t *const buf, std::ptrdiff_t const pitch,
+		unsigned char const *const oam, Source const &src) {
+	bool const large = src.lcdc & 0x04;
+	bool const full = sprites_.begin(buf, pitch, large, src) || sprites_.oam.empty();
+	bool changed[num_tiles];
+	if (!full)
+		sprites_.changedTiles(changed, src);
+
+	for (unsigned i = 0; i < 40; ++i) {
+		unsigned const tno    = large ? oam[i * 4 + 2] & 0xFE : oam[i * 4 + 2];
+		unsigned const attrib = oam[i * 4 + 3];
+		unsigned const bank   = src.cgb ? attrib >> 3 & 1 : 0;
+		unsigned const pal    = src.cgb ? attrib & 7 : attrib >> 4 & 1;
+
+		if (full || changed[bank * 384 + tno] || (large && changed[bank * 384 + tno + 1])
+				|| std::memcmp(&sprites_.oam[i * 4 + 2], oam + i * 4 + 2, 2)) {
+			uint_least32_t *const dst = buf + (i / 8 * 16) * pitch + i % 8 * 8;
+			uint_least32_t const *const colors = src.palette + 32 + pal * 4;
+
+			if (large) {
+				// a y-flipped 8x16 sprite swaps its two tiles as well as their rows
+				unsigned const top = attrib & 0x40 ? tno + 1 : tno;
+				drawTile(dst, pitch, src.tiles.tile(bank, top), attrib, colors, true);
+				drawTile(dst + 8 * pitch, pitch, src.tiles.tile(bank, top ^ 1), attrib, colors, true);
+			} else {
+				drawTile(dst, pitch, src.tiles.tile(bank, tno), attrib, colors, true);
+
+				for (unsigned r = 8; r < 16; ++r)
+					std::fill_n(dst + r * pitch, 8, 0);
+			}
+		}
+	}
+
+	sprites_.oam.assign(oam, oam + 0xA0);
+	sprites_.end(src);
+}
+
+}
@@ -0,0 +1,73 @@
+//
+//   Copyright (C) 2026 by the gambatte contributors
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License version 2 for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   version 2 along with this program; if not, write to the
+//   Free Software Foundation, Inc.,
+//   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+//
+
+#ifndef VRAM_VIEWER_H
+#define VRAM_VIEWER_H
+
+#include "gbint.h"
+#include "tile_cache.h"
+#include <cstddef>
+#include <vector>
+
+namespace gambatte {
+
+// Debug views of VRAM and OAM drawn into RGB32 buffers from the decoded rows
+// of a TileCache. Each view remembers the VRAM, OAM and colours it last drew,
+// and redraws only the tiles, map entries or sprites whose inputs changed,
+// as long as it is called with the same buffer each time.
+class VramViewer {
+public:
+	struct Source {
+		unsigned char const *vram;
+		TileCache const &tiles;
+		uint_least32_t const *palette; // 64 RGB32 slots, laid out as PPUPriv::palette
+		unsigned lcdc;
+		bool cgb;
+	};
+
+	enum { sheet_width = 256, sheet_height = 192,
+	       map_width = 256, map_height = 256,
+	       sprites_width = 64, sprites_height = 80 };
+
+	void drawTileSheet(uint_least32_t *buf, std::ptrdiff_t pitch, unsigned palette, Source const &src);
+	void drawTileMap(uint_least32_t *buf, std::ptrdiff_t pitch, unsigned map, Source const &src);
+	void drawSprites(uint_least32_t *buf, std::ptrdiff_t pitch, unsigned char const *oam, Source const &src);
+
+private:
+	struct View {
+		uint_least32_t *buf;
+		std::ptrdiff_t pitch;
+		unsigned key;
+		std::vector<unsigned char> vram;
+		std::vector<unsigned char> oam;
+		uint_least32_t palette[64];
+
+		View() : buf(0), pitch(0), key(0) {}
+		bool begin(uint_least32_t *buf, std::ptrdiff_t pitch, unsigned key, Source const &src);
+		void end(Source const &src);
+		void changedTiles(bool *changed, Source const &src) const;
+	};
+
+	View sheet_;
+	View maps_[2];
+	View sprites_;
+};
+
+}
+
+#endif
@@ -18,27 +18,37 @@
  ***************************************************************************/
 #include "video.h"
 #include "savestate.h"
+#include "video/color_lut.h"
 #include <cstring>
 #include <algorithm>
 
 namespace gambatte
 {
-   void LCD::setDmgPaletteColor(const unsigned index, const video_pixel_t rgb32)
+   void LCD::setDmgPaletteColor(const unsigned index, const uint_least32_t rgb32)
    {
       dmgColorsRgb32_[index] = rgb32;
    }
 
-   void LCD::setDmgPalette(video_pixel_t *const palette, const video_pixel_t *const dmgColors, const unsigned data)
+   void LCD::setDmgPalette(const unsigned slot, const uint_least32_t *const dmgColors, const unsigned data)
    {
-      palette[0] = dmgColors[data      & 3];
-      palette[1] = dmgColors[data >> 2 & 3];
-      palette[2] = dmgColors[data >> 4 & 3];
-      palette[3] = dmgColors[data >> 6 & 3];
+      ppu_.setPaletteColor(slot    , rgb32ToColor(dmgColors[data      & 3]));
+      ppu_.setPaletteColor(slot + 1, rgb32ToColor(dmgColors[data >> 2 & 3]));
+      ppu_.setPaletteColor(slot + 2, rgb32ToColor(dmgColors[data >> 4 & 3]));
+      ppu_.setPaletteColor(slot + 3, rgb32ToColor(dmgColors[data >> 6 & 3]));
    }
 
    void LCD::setColorCorrection(bool colorCorrection_)
    {
       colorCorrection=colorCorrection_;
+      refreshColorLut();
+      refreshPalettes();
+   }
+
+   void LCD::setColorCurve(const ColorCurve curve)
+   {
+      colorCurve_ = curve;
+      curveLut_.invalidate();
+      refreshColorLut();
       refreshPalettes();
    }
 
@@ -47,23 +57,18 @@ namespace gambatte
       eventTimes_(memEventRequester),
       statReg_(0),
       m2IrqStatReg_(0),
-      m1IrqStatReg_(0)
+      m1IrqStatReg_(0),
+      colorCorrection(true),
+      colorCurve_(0),
+      colorLut_(0)
    {
+      refreshColorLut();
+
       std::memset( bgpData_, 0, sizeof  bgpData_);
       std::memset(objpData_, 0, sizeof objpData_);
 
       for (std::size_t i = 0; i < sizeof(dmgColorsRgb32_) / sizeof(dmgColorsRgb32_[0]); ++i)
-      {
-#ifdef VIDEO_RGB565
-         uint16_t dmgColors[4]={0xFFFF, //11111 111111 11111
-            0xAD55, //10101 101010 10101
-            0x52AA, //01010 010101 01010
-            0x0000};//00000 000000 00000
-         setDmgPaletteColor(i, dmgColors[i&3]);
-#else
          setDmgPaletteColor(i, (3 - (i & 3)) * 85 * 0x010101);
-#endif
-      }
 
       reset(oamram, vram, false);
       setVideoBuffer(0, 160);
@@ -72,19 +77,20 @@ namespace gambatte
    }
 
    void LCD::doCgbColorChange(unsigned char *const pdata,
-         video_pixel_t *const palette, unsigned index, const unsigned data)
+         const unsigned slot, unsigned index, const unsigned data)
    {
       pdata[index] = data;
       index >>= 1;
-      palette[index] = gbcToRgb32(pdata[index << 1] | pdata[(index << 1) + 1] << 8);
+      ppu_.setPaletteColor(slot + index, gbcToColor(pdata[index << 1] | pdata[(index << 1) + 1] << 8));
    }
 
-   void LCD::setVideoBuffer(video_pixel_t *const videoBuf, const int pitch)
+   void LCD::setVideoBuffer(void *const videoBuf, const int pitch)
    {
       ppu_.setFrameBuf(videoBuf, pitch);
    }
 
-   static void clear(video_pixel_t *buf, const unsigned long color, const int dpitch)
+   template<typename T>
+   static void clear(T *buf, const T color, const int dpitch)
    {
       unsigned lines = 144;
 
@@ -95,7 +101,14 @@ namespace gambatte
       }
    }
 
-   void LCD::setDmgPaletteColor(const unsigned palNum, const unsigned colorNum, const video_pixel_t rgb32)
+   void LCD::setPixelFormat(const PixelFormat format)
+   {
+      ppu_.setPixelFormat(format);
+      refreshColorLut();
+      refreshPalettes();
+   }
+
+   void LCD::setDmgPaletteColor(const unsigned palNum, const unsigned colorNum, const uint_least32_t rgb32)
    {
       if (palNum > 2 || colorNum > 3)
          return;
@@ -104,50 +117,203 @@ namespace gambatte
       refreshPalettes();
    }
 
-   void LCD::updateScreen(const bool blanklcd, const unsigned long cycleCounter)
+   void LCD::updateScreen(const bool blanklcd, const cycle_t cycleCounter)
    {
       update(cycleCounter);
 
       if (blanklcd && ppu_.frameBuf().fb())
       {
-         const video_pixel_t color = ppu_.cgb() ? gbcToRgb32(0xFFFF) : dmgColorsRgb32_[0];
-         clear(ppu_.frameBuf().fb(), color, ppu_.frameBuf().pitch());
+         const PPUFrameBuf &fb = ppu_.frameBuf();
+         const uint_least32_t color = ppu_.cgb() ? gbcToColor(0xFFFF) : rgb32ToColor(dmgColorsRgb32_[0]);
+
+         switch (fb.format())
+         {
+            case PIXEL_RGB32:
+               clear(fb.line<uint32_t>(0), static_cast<uint32_t>(color), fb.pitch());
+               break;
+            case PIXEL_RGB565:
+            case PIXEL_XRGB1555:
+               clear(fb.line<uint16_t>(0), static_cast<uint16_t>(color), fb.pitch());
+               break;
+            case PIXEL_GRAY8:
+               clear(fb.line<unsigned char>(0), static_cast<unsigned char>(color), fb.pitch());
+               break;
+            case PIXEL_INDEXED8:
+               clear(fb.line<unsigned char>(0), static_cast<unsigned char>(INDEXED8_BLANK), fb.pitch());
+               break;
+         }
+
+         ppu_.rehashLines();
+      }
+
+      ppu_.endFrame();
+   }
+
+   static unsigned luma(const unsigned r, const unsigned g, const unsigned b)
+   {
+      return (r * 77 + g * 150 + b * 29) >> 8;
+   }
+
+   static uint_least32_t uncorrectedColor(const unsigned bgr15, const PixelFormat format)
+   {
+      const unsigned r = bgr15       & 0x1F;
+      const unsigned g = bgr15 >>  5 & 0x1F;
+      const unsigned b = bgr15 >> 10 & 0x1F;
+
+      switch (format)
+      {
+         case PIXEL_RGB565:
+            return r << 11 | g << 6 | b;
+         case PIXEL_XRGB1555:
+            return r << 10 | g << 5 | b;
+         case PIXEL_GRAY8:
+            return luma(r << 3 | r >> 2, g << 3 | g >> 2, b << 3 | b >> 2);
+         default:
+            return r << 16 | g << 8 | b;
+      }
+   }
+
+   // The built-in colour correction. The 16-bit formats round it to their own
+   // precision rather than truncating the RGB32 result.
+   static uint_least32_t correctedColor(const unsigned bgr15, const PixelFormat format)
+   {
+      const unsigned r = bgr15       & 0x1F;
+      const unsigned g = bgr15 >>  5 & 0x1F;
+      const unsigned b = bgr15 >> 10 & 0x1F;
+
+      switch (format)
+      {
+         case PIXEL_RGB565:
+            return (((r * 13 + g * 2 + b + 8) << 7) & 0xF800) | ((g * 3 + b + 1) >> 1) << 5 | ((r * 3 + g * 2 + b * 11 + 8) >> 4);
+         case PIXEL_XRGB1555:
+            return ((r * 13 + g * 2 + b + 8) >> 4) << 10 | ((g * 3 + b + 2) >> 2) << 5 | ((r * 3 + g * 2 + b * 11 + 8) >> 4);
+         case PIXEL_GRAY8:
+            {
+               const uint_least32_t rgb32 = correctedColor(bgr15, PIXEL_RGB32);
+               return luma(rgb32 >> 16, rgb32 >> 8 & 0xFF, rgb32 & 0xFF);
+            }
+         default:
+            return ((r * 13 + g * 2 + b) >> 1) << 16 | (g * 3 + b) << 9 | (r * 3 + g * 2 + b * 11) >> 1;
       }
    }
 
-   video_pixel_t LCD::gbcToRgb32(const unsigned bgr15)
+   // The colours of a built-in curve in format, built the first time any LCD
+   // uses them and kept for the rest of the process. LCDs on different threads
+   // building one at once write the same colours to it.
+   static const uint_least32_t * builtinColorLut(const bool corrected, const PixelFormat format)
    {
-      if (colorCorrection)
+      static uint_least32_t luts[2][PIXEL_GRAY8 + 1][0x8000];
+      static bool built[2][PIXEL_GRAY8 + 1];
+
+      uint_least32_t *const lut = luts[corrected][format];
+
+      if (!built[corrected][format])
       {
-#ifdef VIDEO_RGB565
-         const unsigned r = bgr15 & 0x1F;
-         const unsigned g = bgr15 >> 5 & 0x1F;
-         const unsigned b = bgr15 >> 10 & 0x1F;
-
-         return (((r * 13 + g * 2 + b + 8) << 7) & 0xF800) | ((g * 3 + b + 1) >> 1) << 5 | ((r * 3 + g * 2 + b * 11 + 8) >> 4);
-#else
-         const unsigned r = bgr15       & 0x1F;
-         const unsigned g = bgr15 >>  5 & 0x1F;
-         const unsigned b = bgr15 >> 10 & 0x1F;
-
-         return ((r * 13 + g * 2 + b) >> 1) << 16 | (g * 3 + b) << 9 | (r * 3 + g * 2 + b * 11) >> 1;
-#endif
+         const ColorCurve curve = corrected ? correctedColor : uncorrectedColor;
+
+         for (unsigned bgr15 = 0; bgr15 < 0x8000; ++bgr15)
+            lut[bgr15] = curve(bgr15, format);
+
+         built[corrected][format] = true;
+      }
+
+      return lut;
+   }
+
+   ColorCurve LCD::activeColorCurve() const
+   {
+      if (!colorCorrection)
+         return uncorrectedColor;
+
+      return colorCurve_ ? colorCurve_ : correctedColor;
+   }
+
+   // Palette writes only look colours up, so a game rewriting its palettes every
+   // line costs no more than one writing them once. Switching between built-in
+   // curves or formats only picks another table.
+   void LCD::refreshColorLut()
+   {
+      const PixelFormat fbFormat = ppu_.frameBuf().format();
+      const PixelFormat format = fbFormat == PIXEL_INDEXED8 ? PIXEL_RGB32 : fbFormat;
+
+      if (colorCorrection && colorCurve_)
+      {
+         curveLut_.set(colorCurve_, format);
+         colorLut_ = curveLut_.data();
       }
       else
+         colorLut_ = builtinColorLut(colorCorrection, format);
+   }
+
+   uint_least32_t LCD::gbcToRgb32(const unsigned bgr15)
+   {
+      return activeColorCurve()(bgr15 & 0x7FFF, PIXEL_RGB32);
+   }
+
+   // The palettes in RGB32, laid out like the PPU's palette slots.
+   void LCD::viewerPalette(uint_least32_t *const palette)
+   {
+      if (ppu_.cgb())
+      {
+         for (unsigned i = 0; i < 32; ++i)
+         {
+            palette[i]                   = gbcToRgb32( bgpData_[i * 2] |  bgpData_[i * 2 + 1] << 8);
+            palette[sp_palette_slot + i] = gbcToRgb32(objpData_[i * 2] | objpData_[i * 2 + 1] << 8);
+         }
+
+         return;
+      }
+
+      std::fill_n(palette, num_palette_slots, 0);
+
+      for (unsigned i = 0; i < 4; ++i)
+      {
+         palette[i]                       = dmgColorsRgb32_[    ( bgpData_[0] >> i * 2 & 3)];
+         palette[sp_palette_slot + i]     = dmgColorsRgb32_[4 + (objpData_[0] >> i * 2 & 3)];
+         palette[sp_palette_slot + 4 + i] = dmgColorsRgb32_[8 + (objpData_[1] >> i * 2 & 3)];
+      }
+   }
+
+   void LCD::drawTileSheet(uint_least32_t *const buf, const std::ptrdiff_t pitch, const unsigned palette)
+   {
+      uint_least32_t colors[num_palette_slots];
+      viewerPalette(colors);
+      const VramViewer::Source src = { ppu_.vram(), ppu_.tileCache(), colors, ppu_.lcdc(), ppu_.cgb() };
+      viewer_.drawTileSheet(buf, pitch, palette, src);
+   }
+
+   void LCD::drawTileMap(uint_least32_t *const buf, const std::ptrdiff_t pitch, const unsigned map)
+   {
+      uint_least32_t colors[num_palette_slots];
+      viewerPalette(colors);
+      const VramViewer::Source src = { ppu_.vram(), ppu_.tileCache(), colors, ppu_.lcdc(), ppu_.cgb() };
+      viewer_.drawTileMap(buf, pitch, map, src);
+   }
+
+   void LCD::drawSprites(uint_least32_t *const buf, const std::ptrdiff_t pitch, const unsigned char *const oam)
+   {
+      uint_least32_t colors[num_palette_slots];
+      viewerPalette(colors);
+      const VramViewer::Source src = { ppu_.vram(), ppu_.tileCache(), colors, ppu_.lcdc(), ppu_.cgb() };
+      viewer_.drawSprites(buf, pitch, oam, src);
+   }
+
+   uint_least32_t LCD::rgb32ToColor(const uint_least32_t rgb32) const
+   {
+      const unsigned r = rgb32 >> 16 & 0xFF;
+      const unsigned g = rgb32 >>  8 & 0xFF;
+      const unsigned b = rgb32       & 0xFF;
+
+      switch (ppu_.frameBuf().format())
       {
-#ifdef VIDEO_RGB565
-         const unsigned r = bgr15       & 0x1F;
-         const unsigned g = bgr15 >>  5 & 0x1F;
-         const unsigned b = bgr15 >> 10 & 0x1F;
-
-         return r<<11 | g<<6 | b;
-#else
-         const unsigned r = bgr15       & 0x1F;
-         const unsigned g = bgr15 >>  5 & 0x1F;
-         const unsigned b = bgr15 >> 10 & 0x1F;
-
-         return r<<16 | g<<8 | b;
-#endif
+         case PIXEL_RGB565:
+            return (r >> 3) << 11 | (g >> 2) << 5 | b >> 3;
+         case PIXEL_XRGB1555:
+            return (r >> 3) << 10 | (g >> 3) << 5 | b >> 3;
+         case PIXEL_GRAY8:
+            return luma(r, g, b);
+         default:
+            return rgb32;
       }
    }
 
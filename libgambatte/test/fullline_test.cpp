@@ -0,0 +1,291 @@
+// Checks that the PPU draws the same frame whichever way its updates are
+// split. One PPU is updated only where registers or VRAM are written, which
+// lets it draw undisturbed lines in a single pass, and the other is updated
+// every cycle, which keeps it on the cycle-stepped path. Frames start with
+// random scroll, window position, LCDC and sprites, and each line gets a
+// random SCX, SCY, WX, WY, LCDC or VRAM write around the start of mode 3,
+// before and while the first, partial tile is fetched. Besides the pixels,
+// the PPU state both screens would save is compared at each write and after
+// mode 3 of every line.
+//
+//   g++ -O2 -DHAVE_STDINT_H -Isrc -Iinclude -I../common test/fullline_test.cpp
+//       src/video/ppu.cpp src/video/sprite_mapper.cpp src/video/ly_counter.cpp
+//       src/video/next_m0_time.cpp src/video/tile_cache.cpp src/video/tile_row.cpp
+//       src/hash64.cpp -o fullline_test
+//   ./fullline_test [frames]
+#include "savestate.h"
+#include "video/next_m0_time.h"
+#include "video/ppu.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+using namespace gambatte;
+
+enum { vram_size = 0x4000, line_cycles = 456 };
+
+struct Screen {
+	NextM0Time nextM0Time;
+	unsigned char oam[0xA0];
+	unsigned char vram[vram_size];
+	unsigned char fb[160 * 144];
+	PPU ppu;
+	cycle_t spriteMapTime;
+	bool stepped;
+
+	Screen(unsigned char const *initVram, unsigned char const *initOam,
+	       bool cgb, bool ds, bool stepped)
+	: ppu(nextM0Time, oam, vram)
+	, spriteMapTime(0)
+	, stepped(stepped)
+	{
+		std::memcpy(oam, initOam, sizeof oam);
+		std::memcpy(vram, initVram, sizeof vram);
+		std::memset(fb, 0, sizeof fb);
+		ppu.reset(oam, vram, cgb);
+		ppu.refreshTileCache();
+		ppu.setPixelFormat(PIXEL_INDEXED8);
+		ppu.setFrameBuf(fb, 160);
+
+		if (ds)
+			ppu.speedChange(0);
+	}
+
+	void enable(unsigned lcdc) {
+		ppu.setLcdc(lcdc, 0);
+		spriteMapTime = SpriteMapper::schedule(ppu.lyCounter(), 0);
+	}
+
+	// Runs the PPU to cc with the LY and sprite mapping events the LCD
+	// would handle.
+	void runTo(cycle_t const cc) {
+		for (;;) {
+			cycle_t const t = std::min(ppu.lyCounter().time(), spriteMapTime);
+			if (t > cc)
+				break;
+
+			ppu.update(t);
+
+			if (t == spriteMapTime)
+				spriteMapTime = ppu.doSpriteMapEvent(t);
+			else
+				ppu.doLyCountEvent();
+		}
+
+		ppu.update(cc);
+	}
+
+	void update(cycle_t const cc) {
+		if (stepped) {
+			for (cycle_t t = ppu.now() + 1; t < cc; ++t)
+				runTo(t);
+		}
+
+		runTo(cc);
+	}
+
+	void writeVram(unsigned p, unsigned data, cycle_t cc) {
+		update(cc);
+		vram[p] = data;
+		ppu.tileDataChange(p);
+	}
+};
+
+struct Write {
+	enum { scx, scy, wx, wy, lcdc, vram } reg;
+	unsigned p, data;
+};
+
+void write(Screen &s, Write const &w, cycle_t cc) {
+	switch (w.reg) {
+	case Write::scx:  s.update(cc); s.ppu.setScx(w.data); break;
+	case Write::scy:  s.update(cc); s.ppu.setScy(w.data); break;
+	case Write::wx:   s.update(cc); s.ppu.setWx(w.data); break;
+	case Write::wy:   s.update(cc); s.ppu.setWy(w.data); s.ppu.updateWy2(); break;
+	case Write::lcdc: s.update(cc); s.ppu.setLcdc(w.data, cc); break;
+	case Write::vram: s.writeVram(w.p, w.data, cc); break;
+	}
+}
+
+// mostly on screen, sometimes just off either edge or well off it
+unsigned randomWx() {
+	switch (std::rand() % 4) {
+	case 0: return std::rand() & 0xFF;
+	case 1: return 160 + std::rand() % 12;
+	default: return std::rand() % 167;
+	}
+}
+
+// Compares what PPU::saveState saves, other than the sprite mapper's part and
+// the fetcher latches the batched tile loop leaves where a cycle-stepped
+// fetch would have moved on (reg0, reg1, tileword, attrib, endx and
+// currentSprite). Those are reloaded before use, and the single-pass line
+// leaves them as the batched loop does.
+bool samePpuState(PPU const &a, PPU const &b) {
+	SaveState sa, sb;
+	a.saveState(sa);
+	b.saveState(sb);
+
+#define SAME(x) (sa.ppu.x == sb.ppu.x)
+	return SAME(videoCycles) && SAME(lastM0Time) && SAME(state) && SAME(xpos)
+		&& SAME(ntileword) && SAME(nattrib)
+		&& SAME(winDrawState) && SAME(winYPos) && SAME(oldWy) && SAME(wscx)
+		&& SAME(weMaster) && SAME(nextSprite)
+		&& !std::memcmp(sa.ppu.spAttribList, sb.ppu.spAttribList, 10)
+		&& !std::memcmp(sa.ppu.spByte0List, sb.ppu.spByte0List, 10)
+		&& !std::memcmp(sa.ppu.spByte1List, sb.ppu.spByte1List, 10);
+#undef SAME
+}
+
+Write randomWrite(unsigned lcdc, unsigned vramSize) {
+	Write w;
+	w.p = 0;
+
+	switch (std::rand() % 6) {
+	case 0:
+		w.reg = Write::scx;
+		w.data = std::rand() & 0xFF;
+		break;
+	case 1:
+		w.reg = Write::scy;
+		w.data = std::rand() & 0xFF;
+		break;
+	case 2:
+		w.reg = Write::wx;
+		w.data = randomWx();
+		break;
+	case 3:
+		w.reg = Write::wy;
+		w.data = std::rand() % 160;
+		break;
+	case 4:
+		// everything but the display enable
+		w.reg = Write::lcdc;
+		w.data = lcdc ^ (std::rand() & 0x7F);
+		break;
+	default:
+		w.reg = Write::vram;
+		w.p = std::rand() % vramSize;
+		w.data = std::rand() & 0xFF;
+		break;
+	}
+
+	return w;
+}
+
+void reportState(bool cgb, bool ds, unsigned ly, char const *when) {
+	std::printf("%s%s: PPU state differs %s line %u\n",
+	            cgb ? "cgb" : "dmg", ds ? " double speed" : "", when, ly);
+}
+
+// Runs a frame in both screens and returns the number of lines that differ
+// in pixels or PPU state.
+unsigned runFrame(bool const cgb, bool const ds) {
+	// a DMG has one bank, and reads zeros for attributes from the other
+	unsigned const vramSize = cgb ? vram_size : vram_size / 2;
+	unsigned char vram[vram_size] = { 0 };
+	for (unsigned i = 0; i < vramSize; ++i)
+		vram[i] = std::rand() & 0xFF;
+
+	// no sprites in a third of the frames, so that lines can be drawn in a
+	// single pass, and up to 40 anywhere on or around the screen otherwise
+	unsigned char oam[0xA0] = { 0 };
+	unsigned const numSprites = std::rand() % 3 ? std::rand() % 41 : 0;
+	for (unsigned i = 0; i < numSprites * 4; ++i)
+		oam[i] = std::rand() & 0xFF;
+	for (unsigned i = 0; i < numSprites; ++i) {
+		oam[i * 4    ] = std::rand() % 176;
+		oam[i * 4 + 1] = std::rand() % 176;
+	}
+
+	Screen single(vram, oam, cgb, ds, false);
+	Screen stepped(vram, oam, cgb, ds, true);
+	Screen *const screens[] = { &single, &stepped };
+	unsigned lcdc = 0x80 | (std::rand() & 0x7F);
+	unsigned const scx = std::rand() & 0xFF;
+	unsigned const scy = std::rand() & 0xFF;
+	unsigned const wx = randomWx();
+	unsigned const wy = std::rand() % 160;
+
+	for (int i = 0; i < 2; ++i) {
+		screens[i]->ppu.setScx(scx);
+		screens[i]->ppu.setScy(scy);
+		screens[i]->ppu.setWx(wx);
+		screens[i]->ppu.setWy(wy);
+		screens[i]->ppu.updateWy2();
+		screens[i]->enable(lcdc);
+	}
+
+	unsigned badState = 0;
+	for (unsigned ly = 1; ly < 144; ++ly) {
+		// mode 3 starts 83 cycles into the line, and tile 0 is fetched in
+		// the up to 7 cycles after that
+		cycle_t const cc = cycle_t(ly * line_cycles + 70 + std::rand() % 24) << ds;
+		Write const w = randomWrite(lcdc, vramSize);
+
+		if (w.reg == Write::lcdc)
+			lcdc = w.data;
+
+		for (int i = 0; i < 2; ++i)
+			screens[i]->update(cc);
+
+		bool same = samePpuState(single.ppu, stepped.ppu);
+		if (!same && !badState)
+			reportState(cgb, ds, ly, "at the write on");
+
+		for (int i = 0; i < 2; ++i)
+			write(*screens[i], w, cc);
+
+		// mode 3 is over by the end of the line, however long it got
+		cycle_t const end = cycle_t(ly * line_cycles + line_cycles - 4) << ds;
+		for (int i = 0; i < 2; ++i)
+			screens[i]->update(end);
+
+		if (same && !samePpuState(single.ppu, stepped.ppu)) {
+			if (!badState)
+				reportState(cgb, ds, ly, "after mode 3 of");
+
+			same = false;
+		}
+
+		badState += !same;
+	}
+
+	for (int i = 0; i < 2; ++i)
+		screens[i]->update(cycle_t(144 * line_cycles) << ds);
+
+	unsigned bad = badState;
+	for (unsigned ly = 0; ly < 144; ++ly) {
+		if (std::memcmp(single.fb + ly * 160, stepped.fb + ly * 160, 160)) {
+			if (!bad) {
+				std::printf("%s%s: line %u differs\n",
+				            cgb ? "cgb" : "dmg", ds ? " double speed" : "", ly);
+			}
+
+			++bad;
+		}
+	}
+
+	return bad;
+}
+
+}
+
+int main(int argc, char **argv) {
+	int const frames = argc > 1 ? std::atoi(argv[1]) : 200;
+	unsigned bad = 0;
+
+	std::srand(1);
+
+	for (int i = 0; i < frames; ++i) {
+		bad += runFrame(false, false);
+		bad += runFrame(true, false);
+		bad += runFrame(true, true);
+	}
+
+	std::printf("%u of %d lines differ\n", bad, frames * 3 * (144 + 143));
+	return bad ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,183 @@
+// Checks that a PIXEL_INDEXED8 frame mapped back to colours through
+// framePalette and paletteChanges matches the same frame drawn in
+// PIXEL_RGB32. Two PPUs draw random VRAM contents while palette colours
+// change at random times, many of them around the end of a line and the
+// start of mode 3, where the line a change first applies to is easiest to
+// get wrong.
+//
+//   g++ -O2 -DHAVE_STDINT_H -Isrc -Iinclude -I../common test/palette_test.cpp
+//       src/video/ppu.cpp src/video/sprite_mapper.cpp src/video/ly_counter.cpp
+//       src/video/next_m0_time.cpp src/video/tile_cache.cpp src/video/tile_row.cpp
+//       src/hash64.cpp -o palette_test
+//   ./palette_test [frames]
+#include "video/next_m0_time.h"
+#include "video/ppu.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+using namespace gambatte;
+
+enum { vram_size = 0x4000, line_cycles = 456, frame_pixels = 160 * 144 };
+
+struct Screen {
+	NextM0Time nextM0Time;
+	unsigned char oam[0xA0];
+	unsigned char vram[vram_size];
+	uint_least32_t fb[frame_pixels];
+	PPU ppu;
+	cycle_t spriteMapTime;
+
+	Screen(unsigned char const *initVram, bool cgb, bool ds, PixelFormat format)
+	: ppu(nextM0Time, oam, vram)
+	, spriteMapTime(0)
+	{
+		std::memset(oam, 0, sizeof oam);
+		std::memcpy(vram, initVram, sizeof vram);
+		std::memset(fb, 0, sizeof fb);
+		ppu.reset(oam, vram, cgb);
+		ppu.refreshTileCache();
+		ppu.setPixelFormat(format);
+		ppu.setFrameBuf(fb, 160);
+
+		if (ds)
+			ppu.speedChange(0);
+	}
+
+	void enable(unsigned lcdc) {
+		ppu.setLcdc(lcdc, 0);
+		spriteMapTime = SpriteMapper::schedule(ppu.lyCounter(), 0);
+	}
+
+	// Runs the PPU to cc with the LY and sprite mapping events the LCD
+	// would handle.
+	void update(cycle_t const cc) {
+		for (;;) {
+			cycle_t const t = std::min(ppu.lyCounter().time(), spriteMapTime);
+			if (t > cc)
+				break;
+
+			ppu.update(t);
+
+			if (t == spriteMapTime)
+				spriteMapTime = ppu.doSpriteMapEvent(t);
+			else
+				ppu.doLyCountEvent();
+		}
+
+		ppu.update(cc);
+	}
+};
+
+struct PaletteWrite {
+	cycle_t cc;
+	unsigned slot;
+	uint_least32_t color;
+
+	bool operator<(PaletteWrite const &rhs) const { return cc < rhs.cc; }
+};
+
+uint_least32_t randomColor() {
+	return (uint_least32_t(std::rand()) << 8 ^ std::rand()) & 0xFFFFFF;
+}
+
+// Line cycle of a palette write, most of them close to where one line ends
+// and the next one's mode 3 starts.
+unsigned randomLineCycle() {
+	switch (std::rand() % 3) {
+	case 0:  return 440 + std::rand() % 16;
+	case 1:  return std::rand() % 100;
+	default: return std::rand() % line_cycles;
+	}
+}
+
+// Runs a frame in both screens and returns the number of pixels that differ.
+unsigned runFrame(bool const cgb, bool const ds) {
+	// a DMG has one bank, and reads zeros for attributes from the other
+	unsigned const vramSize = cgb ? vram_size : vram_size / 2;
+	unsigned char vram[vram_size] = { 0 };
+	for (unsigned i = 0; i < vramSize; ++i)
+		vram[i] = std::rand() & 0xFF;
+
+	Screen indexed(vram, cgb, ds, PIXEL_INDEXED8);
+	Screen rgb(vram, cgb, ds, PIXEL_RGB32);
+	Screen *const screens[] = { &indexed, &rgb };
+	unsigned const lcdc = 0x80 | (std::rand() & 0x19);
+	unsigned const scx = std::rand() & 0xFF;
+	unsigned const scy = std::rand() & 0xFF;
+	unsigned const slots = cgb ? 32 : 4;
+
+	std::vector<PaletteWrite> writes(64 + std::rand() % 256);
+	for (std::size_t i = 0; i < writes.size(); ++i) {
+		writes[i].cc = cycle_t(std::rand() % 144 * line_cycles + randomLineCycle()) << ds;
+		writes[i].slot = std::rand() % slots;
+		writes[i].color = randomColor();
+	}
+
+	std::sort(writes.begin(), writes.end());
+
+	for (int i = 0; i < 2; ++i) {
+		for (unsigned slot = 0; slot < num_palette_slots; ++slot)
+			screens[i]->ppu.setPaletteColor(slot, slot * 0x030303);
+
+		screens[i]->ppu.setScx(scx);
+		screens[i]->ppu.setScy(scy);
+		screens[i]->ppu.setWx(0xFF);
+		screens[i]->enable(lcdc);
+
+		for (std::size_t w = 0; w < writes.size(); ++w) {
+			screens[i]->update(writes[w].cc);
+			screens[i]->ppu.setPaletteColor(writes[w].slot, writes[w].color);
+		}
+
+		screens[i]->update(cycle_t(144 * line_cycles) << ds);
+		screens[i]->ppu.endFrame();
+	}
+
+	uint_least32_t palette[num_palette_slots];
+	std::memcpy(palette, indexed.ppu.framePalette(), sizeof palette);
+	std::vector<PaletteChange> const &changes = indexed.ppu.paletteChanges();
+	std::size_t next = 0;
+	unsigned char const *const slotbuf = reinterpret_cast<unsigned char const *>(indexed.fb);
+	unsigned bad = 0;
+
+	for (unsigned pos = 0; pos < frame_pixels; ++pos) {
+		for (; next < changes.size() && changes[next].pos <= pos; ++next)
+			palette[changes[next].slot] = changes[next].color;
+
+		unsigned const ly = pos / 160, x = pos % 160;
+
+		if (palette[slotbuf[ly * 160 + x]] != rgb.fb[pos]) {
+			if (!bad) {
+				std::printf("%s%s: ly %u x %u differs\n",
+				            cgb ? "cgb" : "dmg", ds ? " double speed" : "", ly, x);
+			}
+
+			++bad;
+		}
+	}
+
+	return bad;
+}
+
+}
+
+int main(int argc, char **argv) {
+	int const frames = argc > 1 ? std::atoi(argv[1]) : 200;
+	unsigned bad = 0;
+
+	std::srand(1);
+
+	for (int i = 0; i < frames; ++i) {
+		bad += runFrame(false, false);
+		bad += runFrame(true, false);
+		bad += runFrame(true, true);
+	}
+
+	std::printf("%u of %d pixels differ\n", bad, frames * 3 * frame_pixels);
+	return bad ? EXIT_FAILURE : EXIT_SUCCESS;
+}